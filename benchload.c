@@ -0,0 +1,128 @@
+/*--------------------------------------------------------------------*/
+/* benchload.c                                                        */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "symtableload.h"
+
+/*length of the longest line the benchmark writes, with its '\n' and '\0'*/
+enum {MAX_LINE_LENGTH = 32};
+
+/*Returns the seconds elapsed since an arbitrary moment*/
+static double wallSeconds(void){
+    struct timespec sNow;
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (double)sNow.tv_sec + (double)sNow.tv_nsec / 1e9;
+}
+
+/*Writes the time dSeconds that loading lLineCount lines of lBytes bytes took
+in the way pcName names, and frees oSymTable*/
+static void report(const char *pcName, SymTable_T oSymTable, double dSeconds,
+    long lLineCount, long lBytes){
+    printf("%-16s bindings: %lu  ns per line: %.1f  MB per second: %.1f\n",
+        pcName, (unsigned long)SymTable_getLength(oSymTable),
+        (lLineCount == 0) ? 0.0 : dSeconds * 1e9 / (double)lLineCount,
+        (dSeconds == 0.0) ? 0.0 : (double)lBytes / dSeconds / 1e6);
+    SymTable_free(oSymTable);
+}
+
+/* Write a file of argv[1] lines, each binding a key to a number with a
+   tab between them, to argv[2], or to benchload.tsv if argv[2] is
+   missing. Load it into a table with fgets and a put per line, then
+   with SymTable_loadFile copying the keys, then with SymTable_loadFile
+   borrowing them from the file. Write the time per line and the
+   throughput of each load to stdout, then remove the file. Exit with
+   EXIT_FAILURE if the arguments are wrong, if the file cannot be
+   written or read, or if memory is insufficient. Otherwise return 0. */
+
+int main(int argc, char *argv[]){
+    SymTable_T oSymTable;
+    SymTableFile_T oFile;
+    const char *pcPath = "benchload.tsv";
+    FILE *psFile;
+    char acLine[MAX_LINE_LENGTH];
+    char *pcTab;
+    long lLineCount;
+    long lBytes = 0;
+    long i;
+    double dStart;
+
+    if (argc < 2 || argc > 3){
+        fprintf(stderr, "Usage: %s linecount [path]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (sscanf(argv[1], "%ld", &lLineCount) != 1 || lLineCount < 0){
+        fprintf(stderr, "linecount must be a number\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 3)
+        pcPath = argv[2];
+
+    psFile = fopen(pcPath, "wb");
+    if (psFile == NULL){
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], pcPath);
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < lLineCount; i++)
+        lBytes += fprintf(psFile, "key%ld\t%ld\n", i * 7919 % lLineCount, i);
+    if (fclose(psFile) != 0){
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], pcPath);
+        exit(EXIT_FAILURE);
+    }
+    printf("lines: %ld  bytes: %ld\n", lLineCount, lBytes);
+
+    /*the values are not parsed, so that each load times the reading of the
+    lines and the puts only*/
+    dStart = wallSeconds();
+    psFile = fopen(pcPath, "rb");
+    oSymTable = SymTable_new();
+    if (psFile == NULL || oSymTable == NULL){
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], pcPath);
+        exit(EXIT_FAILURE);
+    }
+    while (fgets(acLine, MAX_LINE_LENGTH, psFile) != NULL){
+        pcTab = strchr(acLine, '\t');
+        if (pcTab != NULL)
+            *pcTab = '\0';
+        if (!SymTable_put(oSymTable, acLine, NULL)
+            && !SymTable_contains(oSymTable, acLine)){
+            fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    fclose(psFile);
+    report("fgets and put", oSymTable, wallSeconds() - dStart, lLineCount,
+        lBytes);
+
+    dStart = wallSeconds();
+    oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_TSV, NULL, NULL,
+        NULL, NULL);
+    if (oSymTable == NULL){
+        fprintf(stderr, "%s: cannot load %s\n", argv[0], pcPath);
+        exit(EXIT_FAILURE);
+    }
+    report("loadFile", oSymTable, wallSeconds() - dStart, lLineCount,
+        lBytes);
+
+    dStart = wallSeconds();
+    oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_TSV, NULL, NULL,
+        NULL, &oFile);
+    if (oSymTable == NULL){
+        fprintf(stderr, "%s: cannot load %s\n", argv[0], pcPath);
+        exit(EXIT_FAILURE);
+    }
+    report("loadFile borrow", oSymTable, wallSeconds() - dStart, lLineCount,
+        lBytes);
+    SymTableFile_close(oFile);
+
+    remove(pcPath);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*--------------------------------------------------------------------*/
+/* benchlru.c                                                         */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "symtablelru.h"
+
+/*length of the longest key the benchmark makes, with its '\0'*/
+enum {MAX_KEY_LENGTH = 12};
+
+/*capacities the benchmark runs, as fractions of the number of keys*/
+static const double CAPACITY_FRACTIONS[] = {0.001, 0.01, 0.1, 0.5};
+
+/*number of bindings evicted in the current run*/
+static long lEvictCount;
+
+/*Counts the evicted binding with pcKey and pvValue*/
+static void countEviction(const char *pcKey, void *pvValue){
+    (void)pcKey;
+    (void)pvValue;
+    lEvictCount++;
+}
+
+/* Look up argv[2] keys, a million if argv[2] is missing, drawn from
+   argv[1] keys with a skewed distribution in which the keys with low
+   numbers are used most, in LRU caches holding several fractions of the
+   keys. Put each key that misses into the cache, as a caller computing
+   the values would. Write the hit ratio and the throughput of each cache
+   to stdout. Exit with EXIT_FAILURE if the arguments are wrong or memory
+   is insufficient. Otherwise return 0. */
+
+int main(int argc, char *argv[]){
+    SymTableLRU_T oSymTableLRU;
+    char *pcKeys;
+    const char *pcKey;
+    long lKeyCount;
+    long lOperationCount = 1000000;
+    long lHits;
+    long lCapacity;
+    long i;
+    size_t f;
+    unsigned long ulSeed;
+    double dPick;
+    struct timespec sStart;
+    struct timespec sEnd;
+    double dSeconds;
+
+    if (argc < 2 || argc > 3){
+        fprintf(stderr, "Usage: %s keycount [operationcount]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (sscanf(argv[1], "%ld", &lKeyCount) != 1 || lKeyCount <= 0){
+        fprintf(stderr, "keycount must be a positive number\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 3 && (sscanf(argv[2], "%ld", &lOperationCount) != 1
+        || lOperationCount < 0)){
+        fprintf(stderr, "operationcount must be a number\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pcKeys = (char *)malloc((size_t)lKeyCount * MAX_KEY_LENGTH);
+    if (pcKeys == NULL){
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < lKeyCount; i++)
+        sprintf(pcKeys + i * MAX_KEY_LENGTH, "%ld", i);
+
+    printf("keys: %ld  operations: %ld\n", lKeyCount, lOperationCount);
+    for (f = 0; f < sizeof(CAPACITY_FRACTIONS) / sizeof(CAPACITY_FRACTIONS[0]); f++){
+        lCapacity = (long)(CAPACITY_FRACTIONS[f] * (double)lKeyCount);
+        if (lCapacity == 0) lCapacity = 1;
+        oSymTableLRU = SymTable_newLRU((size_t)lCapacity, countEviction);
+        if (oSymTableLRU == NULL){
+            fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+
+        lEvictCount = 0;
+        lHits = 0;
+        ulSeed = 12345UL;
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        for (i = 0; i < lOperationCount; i++){
+            ulSeed = ulSeed * 6364136223846793005UL + 1442695040888963407UL;
+            /*the cube of a uniform pick favours the keys with low numbers*/
+            dPick = (double)(ulSeed >> 11) / 9007199254740992.0;
+            pcKey = pcKeys
+                + (long)(dPick * dPick * dPick * (double)lKeyCount) * MAX_KEY_LENGTH;
+            if (SymTableLRU_get(oSymTableLRU, pcKey) != NULL)
+                lHits++;
+            else if (!SymTableLRU_put(oSymTableLRU, pcKey, pcKey)){
+                fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &sEnd);
+        dSeconds = (double)(sEnd.tv_sec - sStart.tv_sec)
+            + (double)(sEnd.tv_nsec - sStart.tv_nsec) / 1e9;
+
+        printf("capacity: %8ld  hit ratio: %.3f  evictions: %ld"
+            "  million operations per second: %.2f\n",
+            lCapacity, (lOperationCount == 0) ? 0.0
+            : (double)lHits / (double)lOperationCount, lEvictCount,
+            (dSeconds == 0.0) ? 0.0 : (double)lOperationCount / dSeconds / 1e6);
+        SymTableLRU_free(oSymTableLRU);
+    }
+
+    free(pcKeys);
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*--------------------------------------------------------------------*/
+/* benchsharded.c                                                     */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "symtablesharded.h"
+
+/*length of the longest key the benchmark makes, with its '\0'*/
+enum {MAX_KEY_LENGTH = 12};
+
+/*largest number of threads the benchmark runs*/
+enum {MAX_THREADS = 64};
+
+/*one operation in this many is a remove followed by a put, the others are
+lookups*/
+static const unsigned long WRITE_PERIOD = 10;
+
+/* Represents the work of one benchmark thread*/
+struct Worker{
+    /*table all threads share*/
+    SymTableSharded_T table;
+
+    /*keys of the table, MAX_KEY_LENGTH bytes apart*/
+    const char *keys;
+
+    /*number of keys*/
+    long keyCount;
+
+    /*number of operations the thread does*/
+    long operationCount;
+
+    /*seed of the keys the thread picks*/
+    unsigned long seed;
+
+    /*number of lookups that found their key*/
+    long found;
+};
+
+/*Does the operations of the struct Worker pvWorker on its table: lookups of
+random keys, and every WRITE_PERIOD operations a remove and put of one.
+Returns NULL*/
+static void *runWorker(void *pvWorker){
+    struct Worker *psWorker = (struct Worker *)pvWorker;
+    unsigned long ulSeed = psWorker->seed;
+    const char *pcKey;
+    void *pvValue;
+    long lFound = 0;
+    long i;
+
+    for (i = 0; i < psWorker->operationCount; i++){
+        ulSeed = ulSeed * 6364136223846793005UL + 1442695040888963407UL;
+        pcKey = psWorker->keys
+            + (long)((ulSeed >> 17) % (unsigned long)psWorker->keyCount) * MAX_KEY_LENGTH;
+        if ((ulSeed >> 7) % WRITE_PERIOD == 0){
+            pvValue = SymTableSharded_remove(psWorker->table, pcKey);
+            if (pvValue != NULL)
+                SymTableSharded_put(psWorker->table, pcKey, pvValue);
+        }
+        else if (SymTableSharded_get(psWorker->table, pcKey) != NULL)
+            lFound++;
+    }
+
+    /*counted locally, since the workers of all threads share cache lines*/
+    psWorker->found = lFound;
+    return NULL;
+}
+
+/* Put argv[1] bindings into a SymTableSharded of argv[2] shards, 64 if
+   argv[2] is missing, then run 1, 2, 4 and so on up to 64 threads on it at
+   once, each doing argv[3] operations, a million if argv[3] is missing.
+   One operation in WRITE_PERIOD removes and puts back a random key, the
+   others look one up. Write the throughput of each run to stdout. Exit with
+   EXIT_FAILURE if the arguments are wrong, memory is insufficient or a
+   thread cannot be started. Otherwise return 0. */
+
+int main(int argc, char *argv[]){
+    SymTableSharded_T oSymTableSharded;
+    struct Worker asWorkers[MAX_THREADS];
+    pthread_t asThreads[MAX_THREADS];
+    char *pcKeys;
+    long lBindingCount;
+    long lShardCount = 64;
+    long lOperationCount = 1000000;
+    long lFound;
+    long i;
+    int iThreadCount;
+    int t;
+    struct timespec sStart;
+    struct timespec sEnd;
+    double dSeconds;
+
+    if (argc < 2 || argc > 4){
+        fprintf(stderr, "Usage: %s bindingcount [shardcount [operationcount]]\n",
+            argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (sscanf(argv[1], "%ld", &lBindingCount) != 1 || lBindingCount <= 0){
+        fprintf(stderr, "bindingcount must be a positive number\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc >= 3 && (sscanf(argv[2], "%ld", &lShardCount) != 1
+        || lShardCount <= 0 || (lShardCount & (lShardCount - 1)) != 0)){
+        fprintf(stderr, "shardcount must be a power of 2\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 4 && (sscanf(argv[3], "%ld", &lOperationCount) != 1
+        || lOperationCount < 0)){
+        fprintf(stderr, "operationcount must be a number\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pcKeys = (char *)malloc((size_t)lBindingCount * MAX_KEY_LENGTH);
+    oSymTableSharded = SymTableSharded_new((size_t)lShardCount);
+    if (pcKeys == NULL || oSymTableSharded == NULL){
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < lBindingCount; i++){
+        sprintf(pcKeys + i * MAX_KEY_LENGTH, "%ld", i);
+        if (!SymTableSharded_put(oSymTableSharded, pcKeys + i * MAX_KEY_LENGTH,
+            pcKeys)){
+            fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("bindings: %ld  shards: %ld  operations per thread: %ld\n",
+        lBindingCount, lShardCount, lOperationCount);
+    for (iThreadCount = 1; iThreadCount <= MAX_THREADS; iThreadCount *= 2){
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        for (t = 0; t < iThreadCount; t++){
+            asWorkers[t].table = oSymTableSharded;
+            asWorkers[t].keys = pcKeys;
+            asWorkers[t].keyCount = lBindingCount;
+            asWorkers[t].operationCount = lOperationCount;
+            asWorkers[t].seed = 12345UL + (unsigned long)t;
+            asWorkers[t].found = 0;
+            if (pthread_create(&asThreads[t], NULL, runWorker, &asWorkers[t]) != 0){
+                fprintf(stderr, "%s: cannot start thread\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        lFound = 0;
+        for (t = 0; t < iThreadCount; t++){
+            pthread_join(asThreads[t], NULL);
+            lFound += asWorkers[t].found;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &sEnd);
+        dSeconds = (double)(sEnd.tv_sec - sStart.tv_sec)
+            + (double)(sEnd.tv_nsec - sStart.tv_nsec) / 1e9;
+
+        printf("threads: %2d  found: %ld  million operations per second: %.2f\n",
+            iThreadCount, lFound, (dSeconds == 0.0) ? 0.0
+            : (double)lOperationCount * iThreadCount / dSeconds / 1e6);
+    }
+
+    SymTableSharded_free(oSymTableSharded);
+    free(pcKeys);
+    return 0;
+}
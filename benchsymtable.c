@@ -0,0 +1,554 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtable.c                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "symtable.h"
+#ifdef SYMTABLE_BLOOM
+#include "symtablebloom.h"
+#endif
+#ifdef SYMTABLE_HOT_CACHE
+#include "symtablehot.h"
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/*length of the longest key the benchmark makes, with its '\0'*/
+enum {MAX_KEY_LENGTH = 12};
+
+/*largest number of lookups that are timed one at a time for the latency
+percentiles*/
+static const long MAX_TIMED_LOOKUPS = 1000000;
+
+/*number of times in a row each key is looked up with -h*/
+static const long HOT_REPEATS = 8;
+
+/*largest number of threads a bulk build is timed with*/
+static const size_t MAX_BUILD_THREADS = 16;
+
+/*number of hardware events counted in profiling mode*/
+enum {EVENT_COUNT = 6};
+
+/*names of the events counted in profiling mode*/
+static const char *const apcEventNames[EVENT_COUNT] = {"cycles", "instr",
+    "L1d miss", "LLC miss", "dTLB miss", "br miss"};
+
+/*index of the data TLB load misses in the events*/
+enum {DTLB_EVENT = 4};
+
+/*Opens a counter of the event iEvent of apcEventNames in this process,
+counting in user mode only, in the group led by the counter iLeader, or as the
+leader of a new group if iLeader is -1. The counters of a group count over
+the same time. Returns its file descriptor, or -1 if the system does not allow
+it*/
+static int openCounter(int iEvent, int iLeader){
+#ifdef __linux__
+    static const unsigned auTypes[EVENT_COUNT] = {PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    static const unsigned long long aullConfigs[EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES};
+    struct perf_event_attr sAttr;
+
+    /*only the leader starts disabled, the others start and stop with it*/
+    memset(&sAttr, 0, sizeof(sAttr));
+    sAttr.size = sizeof(sAttr);
+    sAttr.type = auTypes[iEvent];
+    sAttr.config = aullConfigs[iEvent];
+    sAttr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    sAttr.disabled = (iLeader < 0);
+    sAttr.exclude_kernel = 1;
+    sAttr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &sAttr, 0, -1, iLeader, 0);
+#else
+    (void)iEvent;
+    (void)iLeader;
+    return -1;
+#endif
+}
+
+/*Resets and starts the group led by the counter iLeader, if it is open*/
+static void startCounters(int iLeader){
+#ifdef __linux__
+    if (iLeader < 0) return;
+    ioctl(iLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(iLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    (void)iLeader;
+#endif
+}
+
+/*Stops the group led by the counter iLeader, if it is open*/
+static void stopCounters(int iLeader){
+#ifdef __linux__
+    if (iLeader < 0) return;
+    ioctl(iLeader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#else
+    (void)iLeader;
+#endif
+}
+
+/*Stores the count of the stopped counter iCounter in *pulCount, scaled up for
+the time the counter had to share the hardware with other events. Returns 1
+if successful, 0 if the counter is not open or never counted*/
+static int readCounter(int iCounter, unsigned long long *pulCount){
+#ifdef __linux__
+    /*the count, the time the counter was enabled and the time it counted*/
+    unsigned long long aullValues[3];
+
+    if (iCounter < 0) return 0;
+    if (read(iCounter, aullValues, sizeof(aullValues)) != (ssize_t)sizeof(aullValues)
+        || aullValues[2] == 0)
+        return 0;
+    *pulCount = aullValues[0];
+    if (aullValues[2] < aullValues[1])
+        *pulCount = (unsigned long long)((double)aullValues[0]
+            * (double)aullValues[1] / (double)aullValues[2]);
+    return 1;
+#else
+    (void)iCounter;
+    (void)pulCount;
+    return 0;
+#endif
+}
+
+/*Closes the counter iCounter, if it is open*/
+static void closeCounter(int iCounter){
+#ifdef __linux__
+    if (iCounter >= 0)
+        close(iCounter);
+#else
+    (void)iCounter;
+#endif
+}
+
+/*Compares the latencies *pvFirst and *pvSecond for qsort*/
+static int compareLatencies(const void *pvFirst, const void *pvSecond){
+    unsigned long ulFirst = *(const unsigned long *)pvFirst;
+    unsigned long ulSecond = *(const unsigned long *)pvSecond;
+    return (ulFirst > ulSecond) - (ulFirst < ulSecond);
+}
+
+/*Looks up in oSymTable the first lLookupCount keys of pcKeys in the order
+auOrder, timing each lookup, and writes the median, 99th, 99.9th percentile
+and largest latency to stdout*/
+static void writeLatencies(SymTable_T oSymTable, const char *pcKeys,
+    const size_t *auOrder, long lLookupCount){
+#ifdef CLOCK_MONOTONIC
+    unsigned long *aulLatencies;
+    struct timespec sStart;
+    struct timespec sEnd;
+    long i;
+
+    if (lLookupCount == 0) return;
+    aulLatencies = (unsigned long *)malloc(sizeof(unsigned long) * (size_t)lLookupCount);
+    if (aulLatencies == NULL){
+        printf("latency: insufficient memory\n");
+        return;
+    }
+    for (i = 0; i < lLookupCount; i++){
+        clock_gettime(CLOCK_MONOTONIC, &sStart);
+        SymTable_get(oSymTable, pcKeys + auOrder[i] * MAX_KEY_LENGTH);
+        clock_gettime(CLOCK_MONOTONIC, &sEnd);
+        aulLatencies[i] = (unsigned long)((sEnd.tv_sec - sStart.tv_sec) * 1000000000L
+            + (sEnd.tv_nsec - sStart.tv_nsec));
+    }
+    qsort(aulLatencies, (size_t)lLookupCount, sizeof(unsigned long), compareLatencies);
+    printf("latency ns (%ld timed lookups, timer overhead included): p50 %lu  "
+        "p99 %lu  p999 %lu  max %lu\n", lLookupCount,
+        aulLatencies[lLookupCount / 2], aulLatencies[lLookupCount * 99 / 100],
+        aulLatencies[lLookupCount * 999 / 1000], aulLatencies[lLookupCount - 1]);
+    free(aulLatencies);
+#else
+    (void)oSymTable;
+    (void)pcKeys;
+    (void)auOrder;
+    (void)lLookupCount;
+    printf("latency: not available\n");
+#endif
+}
+
+/*Increments the count of bindings at *pvExtra. pcKey and pvValue are unused*/
+static void countBinding(const char *pcKey, void *pvValue, void *pvExtra){
+    (void)pcKey;
+    (void)pvValue;
+    (*(size_t *)pvExtra)++;
+}
+
+/*Starts the group of counters led by iLeader and returns the time*/
+static clock_t startPhase(int iLeader){
+    startCounters(iLeader);
+    return clock();
+}
+
+/*Stops the counters aiCounters, a group led by iLeader, of the phase pcName
+that started at iStart and did lOperationCount operations, and writes the time
+and the count of each event per operation to stdout, or - for the counters that
+are not open*/
+static void endPhase(const int aiCounters[EVENT_COUNT], int iLeader,
+    const char *pcName, clock_t iStart, long lOperationCount){
+    unsigned long long aullCounts[EVENT_COUNT];
+    int aiCounted[EVENT_COUNT];
+    double dSeconds = (double)(clock() - iStart) / CLOCKS_PER_SEC;
+    double dOperations = (lOperationCount == 0) ? 1.0 : (double)lOperationCount;
+    int e;
+
+    stopCounters(iLeader);
+    for (e = 0; e < EVENT_COUNT; e++)
+        aiCounted[e] = readCounter(aiCounters[e], &aullCounts[e]);
+    printf("%-8s%10.1f", pcName, dSeconds * 1e9 / dOperations);
+    for (e = 0; e < EVENT_COUNT; e++){
+        if (aiCounted[e])
+            printf("%11.2f", (double)aullCounts[e] / dOperations);
+        else
+            printf("%11s", "-");
+    }
+    printf("\n");
+}
+
+/*Runs the phases of a table's life on the first lBindingCount keys of pcKeys:
+puts them all, looks up lLookupCount keys in the order auOrder, maps the
+table, frees it, then puts them again and removes them all. Writes the time
+and the hardware events per operation of each phase to stdout. The events are
+counted as one group, and scaled up if the hardware could not count them all
+at once. Events the system does not let perf_event_open count are written as
+-. Returns 0 if
+insufficient memory, 1 otherwise*/
+static int profilePhases(const char *pcKeys, long lBindingCount,
+    const size_t *auOrder, long lLookupCount){
+    int aiCounters[EVENT_COUNT];
+    int iLeader = -1;
+    SymTable_T oSymTable;
+    size_t uCount = 0;
+    clock_t iStart;
+    long i;
+    int e;
+    int iOpen = 0;
+
+    for (e = 0; e < EVENT_COUNT; e++){
+        aiCounters[e] = openCounter(e, iLeader);
+        if (aiCounters[e] < 0) continue;
+        if (iLeader < 0) iLeader = aiCounters[e];
+        iOpen++;
+    }
+    if (iOpen == 0)
+        printf("hardware counters: not available, only time is measured\n");
+    printf("%-8s%10s", "phase", "ns/op");
+    for (e = 0; e < EVENT_COUNT; e++)
+        printf("%11s", apcEventNames[e]);
+    printf("\n");
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return 0;
+    iStart = startPhase(iLeader);
+    for (i = 0; i < lBindingCount; i++)
+        if (!SymTable_put(oSymTable, pcKeys + i * MAX_KEY_LENGTH, pcKeys))
+            return 0;
+    endPhase(aiCounters, iLeader, "put", iStart, lBindingCount);
+
+    iStart = startPhase(iLeader);
+    for (i = 0; i < lLookupCount; i++)
+        if (SymTable_get(oSymTable, pcKeys + auOrder[i] * MAX_KEY_LENGTH) != NULL)
+            uCount++;
+    endPhase(aiCounters, iLeader, "get", iStart, lLookupCount);
+
+    iStart = startPhase(iLeader);
+    SymTable_map(oSymTable, countBinding, &uCount);
+    endPhase(aiCounters, iLeader, "map", iStart, lBindingCount);
+
+    iStart = startPhase(iLeader);
+    SymTable_free(oSymTable);
+    endPhase(aiCounters, iLeader, "free", iStart, lBindingCount);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return 0;
+    for (i = 0; i < lBindingCount; i++)
+        if (!SymTable_put(oSymTable, pcKeys + i * MAX_KEY_LENGTH, pcKeys))
+            return 0;
+    iStart = startPhase(iLeader);
+    for (i = 0; i < lBindingCount; i++)
+        SymTable_remove(oSymTable, pcKeys + i * MAX_KEY_LENGTH);
+    endPhase(aiCounters, iLeader, "remove", iStart, lBindingCount);
+    SymTable_free(oSymTable);
+
+    /*closes the leader last*/
+    for (e = EVENT_COUNT - 1; e >= 0; e--)
+        if (aiCounters[e] != iLeader)
+            closeCounter(aiCounters[e]);
+    closeCounter(iLeader);
+    return 1;
+}
+
+/*Returns the time elapsed on a clock that runs on its own, in seconds, which
+unlike clock() does not add up the time of several threads*/
+static double wallSeconds(void){
+    struct timespec sNow;
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (double)sNow.tv_sec + (double)sNow.tv_nsec / 1e9;
+}
+
+/*Builds a table of the first lBindingCount keys of pcKeys with SymTable_put,
+then with SymTable_buildParallel on 1, 2, 4 and so on up to MAX_BUILD_THREADS
+threads, and writes the time of each build to stdout. Returns 0 if
+insufficient memory, 1 otherwise*/
+static int timeBuilds(const char *pcKeys, long lBindingCount){
+    SymTable_T oSymTable;
+    const char **ppcKeys;
+    const void **ppvValues;
+    size_t uThreadCount;
+    double dStart;
+    double dSeconds;
+    long i;
+
+    ppcKeys = (const char **)malloc(sizeof(char *) * (size_t)lBindingCount);
+    ppvValues = (const void **)malloc(sizeof(void *) * (size_t)lBindingCount);
+    if (ppcKeys == NULL || ppvValues == NULL) return 0;
+    for (i = 0; i < lBindingCount; i++){
+        ppcKeys[i] = pcKeys + i * MAX_KEY_LENGTH;
+        ppvValues[i] = pcKeys;
+    }
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return 0;
+    dStart = wallSeconds();
+    for (i = 0; i < lBindingCount; i++)
+        if (!SymTable_put(oSymTable, ppcKeys[i], ppvValues[i]))
+            return 0;
+    dSeconds = wallSeconds() - dStart;
+    printf("put:              %8.3f s\n", dSeconds);
+    SymTable_free(oSymTable);
+
+    for (uThreadCount = 1; uThreadCount <= MAX_BUILD_THREADS; uThreadCount *= 2){
+        dStart = wallSeconds();
+        oSymTable = SymTable_buildParallel(ppcKeys, ppvValues,
+            (size_t)lBindingCount, uThreadCount, NULL);
+        dSeconds = wallSeconds() - dStart;
+        if (oSymTable == NULL) return 0;
+        printf("build, %2lu threads: %8.3f s\n", (unsigned long)uThreadCount,
+            dSeconds);
+        SymTable_free(oSymTable);
+    }
+
+    free(ppcKeys);
+    free(ppvValues);
+    return 1;
+}
+
+/*Puts the first lBindingCount keys of pcKeys into a new table, timing each
+put, and writes the total time and the time and place of the slowest put to
+stdout, which show whether expanding the table is its worst latency. Returns 0
+if insufficient memory, 1 otherwise*/
+static int timeExpansion(const char *pcKeys, long lBindingCount){
+    SymTable_T oSymTable;
+    double dStart;
+    double dPut;
+    double dTotal = 0.0;
+    double dSlowest = 0.0;
+    long lSlowest = 0;
+    long i;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return 0;
+    for (i = 0; i < lBindingCount; i++){
+        dStart = wallSeconds();
+        if (!SymTable_put(oSymTable, pcKeys + i * MAX_KEY_LENGTH, pcKeys))
+            return 0;
+        dPut = wallSeconds() - dStart;
+        dTotal += dPut;
+        if (dPut > dSlowest){
+            dSlowest = dPut;
+            lSlowest = i;
+        }
+    }
+    printf("puts: %ld  total: %.3f s  slowest: %.3f ms, at binding %ld\n",
+        lBindingCount, dTotal, dSlowest * 1e3, lSlowest);
+    SymTable_free(oSymTable);
+    return 1;
+}
+
+/* Put argv[1] bindings into a SymTable, then look up argv[2] keys chosen
+   at random, 10 times argv[1] if argv[2] is missing. argv[3] percent of
+   the keys looked up, 0 if it is missing, are not in the table. Write the
+   time per lookup and the number of data TLB load misses during the
+   lookups to stdout, then time up to a million of the lookups one at a
+   time and write their latency percentiles. The misses are counted with
+   perf_event_open where the system allows it. Build symtablehash.c with
+   -DSYMTABLE_HUGE_PAGES to compare against bucket arrays and binding
+   pools that are on huge pages. Built with -DSYMTABLE_BLOOM against
+   symtablehash.c built the same way, also write the counters of its Bloom
+   filter, or with -DSYMTABLE_HOT_CACHE those of its hot key cache. With
+   -h before the arguments, look up each key chosen HOT_REPEATS times in a
+   row. With -p before the arguments, instead profile the put, get, map,
+   free and remove phases of a table with hardware counters, or with -b
+   compare the time of building it with SymTable_put and with
+   SymTable_buildParallel on more and more threads, or with -e time the
+   slowest put, which expands the table. Build symtablehash.c with
+   -DSYMTABLE_EXPAND_THREADS=n to compare against expansions on n
+   threads. Exit with EXIT_FAILURE if the arguments are wrong or memory is
+   insufficient. Otherwise return 0. */
+
+int main(int argc, char *argv[]){
+    SymTable_T oSymTable;
+    char *pcKeys;
+    size_t *auOrder;
+    long lBindingCount;
+    long lLookupCount;
+    long lMissPercent = 0;
+    long i;
+    unsigned long ulSeed = 12345;
+    size_t uFound = 0;
+    unsigned long long ulMisses = 0;
+    int iCounter;
+    int iCounted;
+    int iProfile;
+    int iBuild;
+    int iExpand;
+    int iHot;
+    clock_t iStart;
+    double dSeconds;
+#ifdef SYMTABLE_BLOOM
+    struct SymTableBloomStats sStats;
+#endif
+#ifdef SYMTABLE_HOT_CACHE
+    struct SymTableHotStats sHotStats;
+#endif
+
+    iProfile = argc > 1 && strcmp(argv[1], "-p") == 0;
+    iBuild = argc > 1 && strcmp(argv[1], "-b") == 0;
+    iExpand = argc > 1 && strcmp(argv[1], "-e") == 0;
+    iHot = argc > 1 && strcmp(argv[1], "-h") == 0;
+    if (iProfile || iBuild || iExpand || iHot){
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+    if (argc < 2 || argc > 4){
+        fprintf(stderr, "Usage: %s [-p | -b | -e | -h] bindingcount [lookupcount [misspercent]]\n",
+            argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (sscanf(argv[1], "%ld", &lBindingCount) != 1 || lBindingCount <= 0){
+        fprintf(stderr, "bindingcount must be a positive number\n");
+        exit(EXIT_FAILURE);
+    }
+    lLookupCount = 10 * lBindingCount;
+    if (argc >= 3 && (sscanf(argv[2], "%ld", &lLookupCount) != 1 || lLookupCount < 0)){
+        fprintf(stderr, "lookupcount must be a number\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 4 && (sscanf(argv[3], "%ld", &lMissPercent) != 1 ||
+        lMissPercent < 0 || lMissPercent > 100)){
+        fprintf(stderr, "misspercent must be a number from 0 to 100\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /*makes every key and the order of the lookups up front, so that only
+    the table is measured. The keys after the first lBindingCount are
+    negative numbers, which are never put*/
+    pcKeys = (char *)malloc(2 * (size_t)lBindingCount * MAX_KEY_LENGTH);
+    auOrder = (size_t *)malloc(sizeof(size_t) * (size_t)(lLookupCount + 1));
+    oSymTable = SymTable_new();
+    if (pcKeys == NULL || auOrder == NULL || oSymTable == NULL){
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < lBindingCount; i++){
+        sprintf(pcKeys + i * MAX_KEY_LENGTH, "%ld", i);
+        sprintf(pcKeys + (lBindingCount + i) * MAX_KEY_LENGTH, "-%ld", i + 1);
+    }
+    for (i = 0; i < lLookupCount; i++){
+        if (iHot && i % HOT_REPEATS != 0){
+            auOrder[i] = auOrder[i - 1];
+            continue;
+        }
+        ulSeed = ulSeed * 6364136223846793005UL + 1442695040888963407UL;
+        auOrder[i] = (size_t)((ulSeed >> 17) % (unsigned long)lBindingCount);
+        if ((long)((ulSeed >> 7) % 100) < lMissPercent)
+            auOrder[i] += (size_t)lBindingCount;
+    }
+
+    if (iProfile || iBuild || iExpand){
+        SymTable_free(oSymTable);
+        if ((iProfile && !profilePhases(pcKeys, lBindingCount, auOrder, lLookupCount))
+            || (iBuild && !timeBuilds(pcKeys, lBindingCount))
+            || (iExpand && !timeExpansion(pcKeys, lBindingCount))){
+            fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        free(auOrder);
+        free(pcKeys);
+        return 0;
+    }
+    for (i = 0; i < lBindingCount; i++){
+        if (!SymTable_put(oSymTable, pcKeys + i * MAX_KEY_LENGTH, pcKeys)){
+            fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    iCounter = openCounter(DTLB_EVENT, -1);
+    iStart = clock();
+    startCounters(iCounter);
+    for (i = 0; i < lLookupCount; i++)
+        if (SymTable_get(oSymTable, pcKeys + auOrder[i] * MAX_KEY_LENGTH) != NULL)
+            uFound++;
+    stopCounters(iCounter);
+    iCounted = readCounter(iCounter, &ulMisses);
+    dSeconds = (double)(clock() - iStart) / CLOCKS_PER_SEC;
+
+    printf("bindings: %ld  lookups: %ld  found: %lu\n", lBindingCount,
+        lLookupCount, (unsigned long)uFound);
+#ifdef SYMTABLE_BLOOM
+    SymTable_getBloomStats(oSymTable, &sStats);
+    printf("bloom: %lu checked  %lu rejected  %lu false positives (%.4f of misses)\n",
+        (unsigned long)sStats.lookups, (unsigned long)sStats.rejected,
+        (unsigned long)sStats.falsePositives,
+        (sStats.rejected + sStats.falsePositives == 0) ? 0.0
+        : (double)sStats.falsePositives
+        / (double)(sStats.rejected + sStats.falsePositives));
+#endif
+#ifdef SYMTABLE_HOT_CACHE
+    SymTable_getHotStats(oSymTable, &sHotStats);
+    printf("hot keys: %lu checked  %lu hits (%.4f)\n",
+        (unsigned long)sHotStats.lookups, (unsigned long)sHotStats.hits,
+        (sHotStats.lookups == 0) ? 0.0
+        : (double)sHotStats.hits / (double)sHotStats.lookups);
+#endif
+    printf("ns per lookup: %.1f\n",
+        (lLookupCount == 0) ? 0.0 : dSeconds * 1e9 / (double)lLookupCount);
+    if (iCounted)
+        printf("dTLB load misses: %llu (%.3f per lookup)\n", ulMisses,
+            (lLookupCount == 0) ? 0.0 : (double)ulMisses / (double)lLookupCount);
+    else
+        printf("dTLB load misses: not available\n");
+    writeLatencies(oSymTable, pcKeys, auOrder,
+        (lLookupCount < MAX_TIMED_LOOKUPS) ? lLookupCount : MAX_TIMED_LOOKUPS);
+    closeCounter(iCounter);
+
+    SymTable_free(oSymTable);
+    free(auOrder);
+    free(pcKeys);
+    return 0;
+}
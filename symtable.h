@@ -2,6 +2,10 @@
 /* symtable.h                                                         */
 /* Author: Milan Sastry                                               */
 /*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLE_INCLUDED
+#define SYMTABLE_INCLUDED
+
 #include <stddef.h>
  
  /*Creates an alias SymTable_T as an opaque pointer to a SymTable object. A symbol table is a 
@@ -12,14 +16,68 @@ typedef struct SymTable *SymTable_T;
 /*Creates and returns an empty Symbol Table*/
 SymTable_T SymTable_new(void);
 
+/*Creates and returns an empty Symbol Table whose values are blocks of uValueSize
+bytes stored in the bindings themselves instead of void pointers. put and replace
+copy uValueSize bytes from pvValue, or zeros if pvValue is NULL. get, getInnermost
+and map give a pointer to the block in the table, valid until its binding is
+replaced or removed. replace and remove return a pointer to a copy of the old block that is
+valid until the next replace or remove on the table. uValueSize must be positive.
+Returns NULL if insufficient memory*/
+SymTable_T SymTable_newInline(size_t uValueSize);
+
+/*Creates and returns an empty Symbol Table that stores the callers' key pointers
+instead of copies of the keys, and never frees them. Each key passed to put must
+stay unchanged until its binding is removed or the table and all its clones are
+freed. Returns NULL if insufficient memory*/
+SymTable_T SymTable_newBorrowedKeys(void);
+
+/*Creates and returns an empty Symbol Table that copies its keys into a heap of
+large blocks it owns, instead of allocating each key on its own, which saves the
+overhead of an allocation per key in tables with many keys. The bytes of a
+removed key are only reused once the table is cleared. An implementation may
+make it like SymTable_new, as those that store each key with its binding do.
+Returns NULL if insufficient memory*/
+SymTable_T SymTable_newKeyHeap(void);
+
+/*Creates and returns a SymTable with the same bindings as oSymTable. Later
+changes to either table do not affect the other. Values are shared, not copied,
+except in a table made by SymTable_newInline. Returns NULL if insufficient memory*/
+SymTable_T SymTable_clone(SymTable_T oSymTable);
+
+/*Creates and returns a Symbol Table made like SymTable_new that binds ppcKeys[i]
+to ppvValues[i] for every i below uCount, built on up to uThreadCount threads,
+and no more than there are processors online, where the implementation can
+split the work. A key given more than once is bound to the value at its lowest
+index, and unless puDuplicates is NULL the number of later occurrences dropped
+is stored in *puDuplicates, whatever the number of threads. uThreadCount must
+be positive. Returns NULL if insufficient memory*/
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates);
+
 /*Frees all the memory associated with oSymTable*/
 void SymTable_free(SymTable_T oSymTable);
 
+/*Removes every binding of oSymTable and closes every scope but the outermost,
+calling pfFreeValue on each value first unless pfFreeValue is NULL. The table
+may keep the memory of the bindings to reuse in later puts, so that filling it
+again allocates less. It is released by SymTable_free. Returns 1 if successful,
+0 if insufficient memory, in which case oSymTable is unchanged and pfFreeValue
+is not called*/
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue));
+
 /*Returns number of bindings in oSymTable*/
 size_t SymTable_getLength(SymTable_T oSymTable);
 
-/*Inserts new binding with pcKey and pvValue into oSymTable. 
-Returns 0 if pcKey is already in the table or if insufficient memory, 1 if succesful*/
+/*Prepares oSymTable to hold uCount bindings in all, so that puts up to that
+count need not grow it. An implementation may do nothing, as those that grow in
+small steps do. Returns 1 if successful, 0 if insufficient memory, in which case
+oSymTable keeps its bindings and still grows as it needs to*/
+int SymTable_presize(SymTable_T oSymTable, size_t uCount);
+
+/*Inserts new binding with pcKey and pvValue into the innermost scope of oSymTable,
+hiding any binding with pcKey in an outer scope. Returns 0 if pcKey is already in
+the innermost scope or if insufficient memory, 1 if succesful*/
 int SymTable_put(SymTable_T oSymTable,
     const char *pcKey, const void *pvValue);
 
@@ -39,8 +97,88 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
 of binding. Returns NULL if pcKey is not in oSymTable*/
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
-/*Applies the function pfApply to all bindings in oSymTable, passes pvExtra as 
-an argument of pfApply*/
+/*Refers to the visible binding of a key in a SymTable, so that a caller can
+read, replace or remove it without looking the key up again*/
+typedef struct SymTable_HandleRep *SymTable_Handle;
+
+/*Returns a handle to the visible binding with pcKey in oSymTable, or NULL if
+there is none. The handle may only be used with oSymTable. It stays valid until
+that binding is removed, by remove, SymTable_handleRemove, clear or popScope,
+or hidden by a put in an inner scope, until oSymTable is resized, as a put that
+expands the hash table does, or until oSymTable is freed. Other changes leave
+it valid, except that an implementation that copies bindings to change them
+also ends it when it replaces the value of that binding*/
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey);
+
+/*Returns the value of the binding oHandle refers to in oSymTable, as
+SymTable_get would*/
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle);
+
+/*Replaces the value of the binding oHandle refers to in oSymTable with pvValue
+and returns the old value, as SymTable_replace would. Returns NULL if
+insufficient memory in an implementation that copies bindings to change them*/
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue);
+
+/*Removes the binding oHandle refers to from oSymTable and returns its value, as
+SymTable_remove would. Returns NULL if insufficient memory in an implementation
+that copies bindings to change them*/
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle);
+
+/*Applies the function pfApply to all bindings in oSymTable, passes pvExtra as
+an argument of pfApply. The key pfApply gets may only be valid until it returns*/
 void SymTable_map(SymTable_T oSymTable,
     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
-    const void *pvExtra);
\ No newline at end of file
+    const void *pvExtra);
+
+/*Applies the function pfApply to the bindings in oSymTable whose key starts
+with pcPrefix, passes pvExtra as an argument of pfApply. An empty pcPrefix
+matches every key*/
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*What SymTable_merge does with a key that both tables bind: keep the value in
+the destination, overwrite it with the value from the source, or bind the key
+to the value a callback returns*/
+enum SymTable_MergePolicy {SYMTABLE_KEEP_EXISTING, SYMTABLE_OVERWRITE,
+    SYMTABLE_RESOLVE};
+
+/*Moves every binding of oSource into the innermost scope of oDest, then frees
+oSource. oSource must have only its outermost scope open and be made the same
+way as oDest: both by SymTable_new, both by SymTable_newBorrowedKeys, both by
+SymTable_newKeyHeap or both by SymTable_newInline with the same size. A key
+already in the innermost scope of oDest is handled by ePolicy. With
+SYMTABLE_RESOLVE it is bound to the value pfResolve returns when given the key,
+the value in oDest, the value in oSource and pvExtra, copied into the binding if
+oDest is inline. pfResolve may be NULL for the other policies. Values that are
+dropped are not freed. Returns 1 if successful. Returns 0 if insufficient
+memory, in which case oSource is not freed and each of its bindings is in oDest,
+oSource or both*/
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra);
+
+/*A SymTable starts with one open scope, the outermost. Each key is bound at most
+once per scope and only the binding in the innermost scope that binds it is
+visible: getLength, contains, get, replace, remove and map see only visible
+bindings. Removing a visible binding makes the binding it hid visible again*/
+
+/*Opens a new innermost scope in oSymTable. Returns 1 if successful, 0 if
+insufficient memory*/
+int SymTable_pushScope(SymTable_T oSymTable);
+
+/*Closes the innermost scope of oSymTable, freeing all of its bindings and
+making the bindings they hid visible again. Returns 0 if only the outermost
+scope is open or if insufficient memory, 1 if successful*/
+int SymTable_popScope(SymTable_T oSymTable);
+
+/*Returns the value of the visible binding with pcKey in oSymTable and stores
+the depth of its scope in *puDepth, 0 being the outermost scope. Returns NULL
+and leaves *puDepth unchanged if pcKey is not in oSymTable*/
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth);
+
+#endif
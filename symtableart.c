@@ -0,0 +1,1244 @@
+/*--------------------------------------------------------------------*/
+/* symtableart.c                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtable.h"
+#include "symtablebuild.h"
+#include "symtablescope.h"
+
+/* An adaptive radix tree. Each inner node holds the bytes that all the keys
+   below it share, then branches on the next byte of the key, and grows or
+   shrinks between four sizes as children come and go. A binding hangs from
+   the node where its key first differs from every other key, and keeps only
+   the bytes of its key below that node, so a shared prefix is stored once.
+   The '\0' ending a key is a byte like any other, so no key ends inside an
+   inner node*/
+
+/*kinds of node, an inner node of each kind holds at most 4, 16, 48 or 256
+children*/
+enum NodeKind {LEAF, NODE4, NODE16, NODE48, NODE256};
+
+/*number of bytes an inner node of each kind uses to find its children*/
+enum {INDEX_SIZE = 256};
+
+/* Represents the part every node starts with*/
+struct ArtNode{
+    /*kind of the node, LEAF if it is a binding*/
+    enum NodeKind kind;
+};
+
+/* Represents a binding in the symbol table, a leaf of the tree*/
+struct Binding{
+    /*part shared with every node*/
+    struct ArtNode node;
+
+    /*whole key of the binding, or NULL if only its suffix is kept. The whole
+    key is kept when the table borrows keys, for bindings in inner scopes,
+    which popScope has to find again, and for bindings SymTable_find returned,
+    which SymTable_handleRemove has to find again*/
+    const char *key;
+
+    /*the bytes of the key after the byte that leads to the binding, owned by
+    the binding unless the table borrows keys*/
+    const char *suffix;
+
+    /*value of the binding that is a void pointer, or in an inline table a
+    pointer to the value stored after the binding*/
+    const void *value;
+};
+
+/* Represents an inner node. Its children, index and prefix are stored after
+   it*/
+struct Inner{
+    /*part shared with every node*/
+    struct ArtNode node;
+
+    /*number of children*/
+    size_t numOfChildren;
+
+    /*number of bytes in prefix*/
+    size_t prefixLength;
+
+    /*bytes that every key below the node has at this point, never '\0'*/
+    char *prefix;
+
+    /*in a NODE4 or NODE16 the byte of each child, in increasing order. In a
+    NODE48, for each byte 1 + the position of its child, or 0 if it has none.
+    Unused in a NODE256*/
+    unsigned char *index;
+
+    /*children of the node. In a NODE256 the child for each byte, NULL if it
+    has none*/
+    struct ArtNode **children;
+};
+
+/* Represents the symbol table*/
+struct SymTable{
+    /*number of bindings in the table*/
+    size_t numOfBindings;
+
+    /*root of the tree, NULL if the table is empty*/
+    struct ArtNode *root;
+
+    /*holds the key of each binding map visits, with room for the longest key
+    put in the table*/
+    char *keyBuffer;
+
+    /*number of bytes in keyBuffer*/
+    size_t keyBufferSize;
+
+    /*1 while a map of the table is using keyBuffer*/
+    int mapping;
+
+    /*open scopes, which know the depth of each binding put in an inner scope
+    and the binding it hides, which is not in the tree while it is hidden. NULL
+    until the first pushScope, so that bindings carry nothing for scopes*/
+    SymTableScopes_T scopes;
+
+    /*size of the values stored in the bindings, 0 if values are void pointers*/
+    size_t valueSize;
+
+    /*copy of the last value replaced or removed from an inline table*/
+    void *oldValue;
+
+    /*1 if the bindings point to the callers' keys instead of copies*/
+    int borrowedKeys;
+};
+
+/*Returns the number of children an inner node of eKind can hold*/
+static size_t SymTable_capacity(enum NodeKind eKind){
+    switch (eKind){
+    case NODE4: return 4;
+    case NODE16: return 16;
+    case NODE48: return 48;
+    default: return 256;
+    }
+}
+
+/*Returns the number of bytes of index of an inner node of eKind*/
+static size_t SymTable_indexSize(enum NodeKind eKind){
+    switch (eKind){
+    case NODE4: return 4;
+    case NODE16: return 16;
+    case NODE48: return INDEX_SIZE;
+    default: return 0;
+    }
+}
+
+/*Creates an inner node of eKind with no children and the uPrefixLength bytes
+at pcPrefix as its prefix. Returns NULL if insufficient memory*/
+static struct Inner *SymTable_newInner(enum NodeKind eKind, const char *pcPrefix,
+    size_t uPrefixLength){
+    struct Inner *psInner;
+    size_t uCapacity = SymTable_capacity(eKind);
+    size_t uIndexSize = SymTable_indexSize(eKind);
+
+    psInner = (struct Inner *)malloc(sizeof(struct Inner)
+        + sizeof(struct ArtNode *) * uCapacity + uIndexSize + uPrefixLength);
+    if (psInner == NULL) return NULL;
+    psInner->node.kind = eKind;
+    psInner->numOfChildren = 0;
+    psInner->children = (struct ArtNode **)(psInner + 1);
+    psInner->index = (unsigned char *)(psInner->children + uCapacity);
+    psInner->prefix = (char *)(psInner->index + uIndexSize);
+    psInner->prefixLength = uPrefixLength;
+    memcpy(psInner->prefix, pcPrefix, uPrefixLength);
+    if (eKind == NODE48)
+        memset(psInner->index, 0, INDEX_SIZE);
+    if (eKind == NODE256)
+        memset(psInner->children, 0, sizeof(struct ArtNode *) * uCapacity);
+    return psInner;
+}
+
+/*Returns the address of the child of psInner for byte c, or NULL if it has
+none*/
+static struct ArtNode **SymTable_findChild(struct Inner *psInner, unsigned char c){
+    size_t i;
+
+    switch (psInner->node.kind){
+    case NODE48:
+        if (psInner->index[c] == 0) return NULL;
+        return &psInner->children[psInner->index[c] - 1];
+    case NODE256:
+        if (psInner->children[c] == NULL) return NULL;
+        return &psInner->children[c];
+    default:
+        for (i = 0; i < psInner->numOfChildren; i++)
+            if (psInner->index[i] == c)
+                return &psInner->children[i];
+        return NULL;
+    }
+}
+
+/*Returns the address of the child of psInner with the smallest byte that is
+at least *puByte, and stores that byte in *puByte. Returns NULL if there is
+no such child*/
+static struct ArtNode **SymTable_nextChild(struct Inner *psInner, size_t *puByte){
+    size_t i;
+
+    switch (psInner->node.kind){
+    case NODE48:
+        for (i = *puByte; i < INDEX_SIZE; i++){
+            if (psInner->index[i] != 0){
+                *puByte = i;
+                return &psInner->children[psInner->index[i] - 1];
+            }
+        }
+        return NULL;
+    case NODE256:
+        for (i = *puByte; i < INDEX_SIZE; i++){
+            if (psInner->children[i] != NULL){
+                *puByte = i;
+                return &psInner->children[i];
+            }
+        }
+        return NULL;
+    default:
+        for (i = 0; i < psInner->numOfChildren; i++){
+            if (psInner->index[i] >= *puByte){
+                *puByte = psInner->index[i];
+                return &psInner->children[i];
+            }
+        }
+        return NULL;
+    }
+}
+
+/*Adds psChild as the child of psInner for byte c, which has no child. psInner
+must have room for it*/
+static void SymTable_insertChild(struct Inner *psInner, unsigned char c,
+    struct ArtNode *psChild){
+    size_t i;
+
+    switch (psInner->node.kind){
+    case NODE48:
+        psInner->children[psInner->numOfChildren] = psChild;
+        psInner->index[c] = (unsigned char)(psInner->numOfChildren + 1);
+        break;
+    case NODE256:
+        psInner->children[c] = psChild;
+        break;
+    default:
+        /*keeps the bytes in increasing order so that map visits keys in order*/
+        for (i = psInner->numOfChildren; i > 0 && psInner->index[i - 1] > c; i--){
+            psInner->index[i] = psInner->index[i - 1];
+            psInner->children[i] = psInner->children[i - 1];
+        }
+        psInner->index[i] = c;
+        psInner->children[i] = psChild;
+        break;
+    }
+    psInner->numOfChildren++;
+}
+
+/*Returns a copy of psInner of eKind with the same prefix and children, or NULL
+if insufficient memory. psInner is not freed*/
+static struct Inner *SymTable_resize(struct Inner *psInner, enum NodeKind eKind){
+    struct Inner *psResized;
+    struct ArtNode **ppsChild;
+    size_t uByte;
+
+    psResized = SymTable_newInner(eKind, psInner->prefix, psInner->prefixLength);
+    if (psResized == NULL) return NULL;
+    for (uByte = 0; (ppsChild = SymTable_nextChild(psInner, &uByte)) != NULL; uByte++)
+        SymTable_insertChild(psResized, (unsigned char)uByte, *ppsChild);
+    return psResized;
+}
+
+/*Adds psChild as the child for byte c of the inner node *ppsNode, which has no
+child for c, replacing the node by a larger one if it is full. Returns 1 if
+successful, 0 if insufficient memory*/
+static int SymTable_addChild(struct ArtNode **ppsNode, unsigned char c,
+    struct ArtNode *psChild){
+    struct Inner *psInner = (struct Inner *)*ppsNode;
+    struct Inner *psGrown;
+
+    if (psInner->numOfChildren == SymTable_capacity(psInner->node.kind)){
+        psGrown = SymTable_resize(psInner, (enum NodeKind)(psInner->node.kind + 1));
+        if (psGrown == NULL) return 0;
+        free(psInner);
+        *ppsNode = &psGrown->node;
+        psInner = psGrown;
+    }
+    SymTable_insertChild(psInner, c, psChild);
+    return 1;
+}
+
+/*Removes the child for byte c of the inner node *ppsNode, replacing the node by
+a smaller one once it is a quarter empty, or by NULL once it has no children*/
+static void SymTable_removeChild(struct ArtNode **ppsNode, unsigned char c){
+    struct Inner *psInner = (struct Inner *)*ppsNode;
+    struct Inner *psShrunk;
+    size_t uSlot;
+    size_t uLast;
+    size_t i;
+
+    switch (psInner->node.kind){
+    case NODE48:
+        /*moves the last child into the hole so that the children stay packed*/
+        uSlot = (size_t)psInner->index[c] - 1;
+        uLast = psInner->numOfChildren - 1;
+        psInner->index[c] = 0;
+        if (uSlot != uLast){
+            psInner->children[uSlot] = psInner->children[uLast];
+            for (i = 0; psInner->index[i] != uLast + 1; i++);
+            psInner->index[i] = (unsigned char)(uSlot + 1);
+        }
+        break;
+    case NODE256:
+        psInner->children[c] = NULL;
+        break;
+    default:
+        for (i = 0; psInner->index[i] != c; i++);
+        for (; i + 1 < psInner->numOfChildren; i++){
+            psInner->index[i] = psInner->index[i + 1];
+            psInner->children[i] = psInner->children[i + 1];
+        }
+        break;
+    }
+    psInner->numOfChildren--;
+
+    if (psInner->numOfChildren == 0){
+        free(psInner);
+        *ppsNode = NULL;
+    }
+    else if (psInner->node.kind != NODE4 && psInner->numOfChildren <=
+        SymTable_capacity((enum NodeKind)(psInner->node.kind - 1)) * 3 / 4){
+        /*keeps the larger node if there is no memory for the smaller one*/
+        psShrunk = SymTable_resize(psInner, (enum NodeKind)(psInner->node.kind - 1));
+        if (psShrunk != NULL){
+            free(psInner);
+            *ppsNode = &psShrunk->node;
+        }
+    }
+}
+
+/*Frees the subtree psNode of the tree of oSymTable and every binding in it,
+taking the bindings out of their scopes*/
+static void SymTable_freeNode(SymTable_T oSymTable, struct ArtNode *psNode){
+    struct Inner *psInner;
+    struct Binding *psBinding;
+    struct Binding *shadowed;
+    struct ArtNode **ppsChild;
+    size_t uByte;
+
+    if (psNode == NULL) return;
+    if (psNode->kind == LEAF){
+        for (psBinding = (struct Binding *)psNode; psBinding != NULL;
+            psBinding = shadowed){
+            shadowed = (struct Binding *)SymTableScopes_remove(
+                oSymTable->scopes, psBinding);
+            free(psBinding);
+        }
+        return;
+    }
+    psInner = (struct Inner *)psNode;
+    for (uByte = 0; (ppsChild = SymTable_nextChild(psInner, &uByte)) != NULL; uByte++)
+        SymTable_freeNode(oSymTable, *ppsChild);
+    free(psInner);
+}
+
+/*Calls pfFreeValue on the value of every binding in the tree psNode of
+oSymTable, hidden or not*/
+static void SymTable_freeValues(SymTable_T oSymTable, struct ArtNode *psNode,
+    void (*pfFreeValue)(void *pvValue)){
+    struct Binding *psBinding;
+    struct ArtNode **ppsChild;
+    size_t uByte;
+
+    if (psNode == NULL) return;
+    if (psNode->kind == LEAF){
+        for (psBinding = (struct Binding *)psNode; psBinding != NULL;
+            psBinding = (struct Binding *)SymTableScopes_shadowed(
+            oSymTable->scopes, psBinding))
+            (*pfFreeValue)((void *)psBinding->value);
+        return;
+    }
+    for (uByte = 0; (ppsChild = SymTable_nextChild((struct Inner *)psNode,
+        &uByte)) != NULL; uByte++)
+        SymTable_freeValues(oSymTable, *ppsChild, pfFreeValue);
+}
+
+/*Copies the uValueSize bytes at pvValue, or zeros if pvValue is NULL, into
+the inline value pvDest*/
+static void SymTable_storeValue(size_t uValueSize, void *pvDest,
+    const void *pvValue){
+    if (pvValue != NULL)
+        memcpy(pvDest, pvValue, uValueSize);
+    else
+        memset(pvDest, 0, uValueSize);
+}
+
+/*Creates a binding of oSymTable at depth uDepth with the suffix pcSuffix of
+the key pcKey and pvValue, hiding nothing. pcKey may be NULL if oSymTable owns
+its keys and uDepth is 0. The binding and its copy of the key are allocated
+together. Returns NULL if insufficient memory*/
+static struct Binding *SymTable_newBinding(SymTable_T oSymTable,
+    const char *pcKey, const char *pcSuffix, const void *pvValue, size_t uDepth){
+    struct Binding *newBinding;
+    const char *pcKept = NULL;
+    char *pcCopy;
+
+    if (!oSymTable->borrowedKeys)
+        pcKept = (uDepth > 0) ? pcKey : pcSuffix;
+    newBinding = (struct Binding *)malloc(sizeof(struct Binding)
+        + oSymTable->valueSize + ((pcKept != NULL) ? strlen(pcKept) + 1 : 0));
+    if (newBinding == NULL) return NULL;
+    newBinding->node.kind = LEAF;
+    newBinding->value = pvValue;
+    if (oSymTable->valueSize != 0){
+        newBinding->value = newBinding + 1;
+        SymTable_storeValue(oSymTable->valueSize, newBinding + 1, pvValue);
+    }
+
+    if (pcKept == NULL){
+        newBinding->key = pcKey;
+        newBinding->suffix = pcSuffix;
+    }
+    else{
+        pcCopy = strcpy((char *)(newBinding + 1) + oSymTable->valueSize, pcKept);
+        newBinding->key = (uDepth > 0) ? pcCopy : NULL;
+        newBinding->suffix = (uDepth > 0) ? pcCopy + (pcSuffix - pcKey) : pcCopy;
+    }
+    return newBinding;
+}
+
+/*Makes the visible binding *ppsSlot of oSymTable, whose key is pcKey, keep its
+whole key, moving it to a new allocation if it only keeps its suffix. Returns
+the binding, which is left as it was if insufficient memory*/
+static struct Binding *SymTable_keepKey(SymTable_T oSymTable,
+    struct ArtNode **ppsSlot, const char *pcKey){
+    struct Binding *current = (struct Binding *)*ppsSlot;
+    struct Binding *newBinding;
+
+    /*the whole key is copied as for a binding of an inner scope, a binding
+    that keeps only its suffix is in the outermost scope and hides nothing*/
+    if (current->key != NULL) return current;
+    newBinding = SymTable_newBinding(oSymTable, pcKey,
+        pcKey + strlen(pcKey) - strlen(current->suffix), current->value, 1);
+    if (newBinding == NULL) return current;
+    *ppsSlot = &newBinding->node;
+    free(current);
+    return newBinding;
+}
+
+/*Moves the suffix of psBinding of oSymTable and of every binding it shadows
+uCount bytes further into their key, after a new node took over those bytes*/
+static void SymTable_advance(SymTable_T oSymTable, struct Binding *psBinding,
+    size_t uCount){
+    for (; psBinding != NULL; psBinding = (struct Binding *)
+        SymTableScopes_shadowed(oSymTable->scopes, psBinding))
+        psBinding->suffix += uCount;
+}
+
+/*Returns the value pvValue of a binding of oSymTable that is being replaced or
+removed, saving a copy of it first if oSymTable is inline*/
+static void *SymTable_oldValue(SymTable_T oSymTable, const void *pvValue){
+    if (oSymTable->valueSize == 0) return (void *)pvValue;
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/*Returns a copy for oClone of psBinding of oSymTable, putting the copy and a
+copy of every binding psBinding shadows in the same scopes of oClone, which are
+open. Returns NULL if insufficient memory*/
+static struct Binding *SymTable_copyStack(SymTable_T oClone,
+    SymTable_T oSymTable, const struct Binding *psBinding){
+    struct Binding *shadowed = NULL;
+    struct Binding *newBinding;
+    const struct Binding *psShadowed;
+    size_t uDepth;
+
+    /*the bindings it shadows are copied first, so the copy can hide theirs*/
+    psShadowed = (const struct Binding *)SymTableScopes_shadowed(
+        oSymTable->scopes, psBinding);
+    if (psShadowed != NULL){
+        shadowed = SymTable_copyStack(oClone, oSymTable, psShadowed);
+        if (shadowed == NULL) return NULL;
+    }
+
+    uDepth = SymTableScopes_depthOf(oSymTable->scopes, psBinding);
+    if (uDepth > 0 && !SymTableScopes_reserve(oClone->scopes, 1)){
+        SymTable_freeNode(oClone, (struct ArtNode *)shadowed);
+        return NULL;
+    }
+    newBinding = SymTable_newBinding(oClone, psBinding->key, psBinding->suffix,
+        psBinding->value, uDepth);
+    if (newBinding == NULL){
+        SymTable_freeNode(oClone, (struct ArtNode *)shadowed);
+        return NULL;
+    }
+    if (uDepth > 0)
+        SymTableScopes_add(oClone->scopes, newBinding, uDepth, shadowed);
+    return newBinding;
+}
+
+/*Returns a copy for oClone of the subtree psNode of oSymTable, or NULL if
+insufficient memory. *piFailed is set to 1 if memory ran out*/
+static struct ArtNode *SymTable_copyNode(SymTable_T oClone,
+    SymTable_T oSymTable, struct ArtNode *psNode, int *piFailed){
+    struct Inner *psInner;
+    struct Inner *psCopy;
+    struct Binding *psStack;
+    struct ArtNode **ppsChild;
+    struct ArtNode *psChild;
+    size_t uByte;
+
+    if (psNode->kind == LEAF){
+        psStack = SymTable_copyStack(oClone, oSymTable, (struct Binding *)psNode);
+        if (psStack == NULL){
+            *piFailed = 1;
+            return NULL;
+        }
+        return &psStack->node;
+    }
+    psInner = (struct Inner *)psNode;
+    psCopy = SymTable_newInner(psInner->node.kind, psInner->prefix,
+        psInner->prefixLength);
+    if (psCopy == NULL){
+        *piFailed = 1;
+        return NULL;
+    }
+    for (uByte = 0; (ppsChild = SymTable_nextChild(psInner, &uByte)) != NULL; uByte++){
+        psChild = SymTable_copyNode(oClone, oSymTable, *ppsChild, piFailed);
+        if (psChild == NULL){
+            SymTable_freeNode(oClone, &psCopy->node);
+            return NULL;
+        }
+        SymTable_insertChild(psCopy, (unsigned char)uByte, psChild);
+    }
+    return &psCopy->node;
+}
+
+/*Returns the part of pcKey, of length uKeyLength, that starts at byte
+uPosition, which is empty if the key ended before it*/
+static const char *SymTable_rest(const char *pcKey, size_t uKeyLength,
+    size_t uPosition){
+    return pcKey + ((uPosition < uKeyLength) ? uPosition : uKeyLength);
+}
+
+/*Returns the address of the pointer in oSymTable to the visible binding with
+pcKey, or NULL if there is none*/
+static struct ArtNode **SymTable_locate(SymTable_T oSymTable, const char *pcKey){
+    struct ArtNode **ppsNode = &oSymTable->root;
+    struct Inner *psInner;
+    size_t uKeyLength = strlen(pcKey);
+    size_t uPosition = 0;
+    size_t i;
+
+    while (*ppsNode != NULL){
+        if ((*ppsNode)->kind == LEAF){
+            if (strcmp(((struct Binding *)*ppsNode)->suffix,
+                SymTable_rest(pcKey, uKeyLength, uPosition)) == 0)
+                return ppsNode;
+            return NULL;
+        }
+        /*a prefix never holds '\0', so a key that ends inside it fails here*/
+        psInner = (struct Inner *)*ppsNode;
+        for (i = 0; i < psInner->prefixLength; i++)
+            if (psInner->prefix[i] != pcKey[uPosition + i])
+                return NULL;
+        uPosition += psInner->prefixLength;
+        ppsNode = SymTable_findChild(psInner, (unsigned char)pcKey[uPosition]);
+        if (ppsNode == NULL) return NULL;
+        uPosition++;
+    }
+    return NULL;
+}
+
+/*Creates a binding of oSymTable with pcKey, which is not in oSymTable, and
+pvValue, at depth uDepth, and adds it to the tree, splitting the node where
+pcKey leaves the tree. Returns the binding, or NULL if insufficient memory*/
+static struct Binding *SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue, size_t uDepth){
+    struct ArtNode **ppsNode = &oSymTable->root;
+    struct ArtNode **ppsChild;
+    struct Binding *psLeaf;
+    struct Binding *newBinding;
+    struct Inner *psInner;
+    struct Inner *psSplit;
+    const char *pcRest;
+    unsigned char cOld;
+    size_t uKeyLength = strlen(pcKey);
+    size_t uPosition = 0;
+    size_t c;
+
+    for (;;){
+        pcRest = SymTable_rest(pcKey, uKeyLength, uPosition);
+        if (*ppsNode == NULL){
+            newBinding = SymTable_newBinding(oSymTable, pcKey, pcRest, pvValue,
+                uDepth);
+            if (newBinding == NULL) return NULL;
+            *ppsNode = &newBinding->node;
+            return newBinding;
+        }
+
+        if ((*ppsNode)->kind == LEAF){
+            /*puts a node over the bytes both keys share, with the old binding
+            and the new one as its children*/
+            psLeaf = (struct Binding *)*ppsNode;
+            for (c = 0; psLeaf->suffix[c] == pcRest[c]; c++);
+            cOld = (unsigned char)psLeaf->suffix[c];
+            psSplit = SymTable_newInner(NODE4, pcRest, c);
+            if (psSplit == NULL) return NULL;
+            newBinding = SymTable_newBinding(oSymTable, pcKey,
+                pcRest + c + (pcRest[c] != '\0'), pvValue, uDepth);
+            if (newBinding == NULL){
+                free(psSplit);
+                return NULL;
+            }
+            SymTable_advance(oSymTable, psLeaf, c + (cOld != '\0'));
+            SymTable_insertChild(psSplit, cOld, &psLeaf->node);
+            SymTable_insertChild(psSplit, (unsigned char)pcRest[c], &newBinding->node);
+            *ppsNode = &psSplit->node;
+            return newBinding;
+        }
+
+        psInner = (struct Inner *)*ppsNode;
+        for (c = 0; c < psInner->prefixLength && psInner->prefix[c] == pcRest[c]; c++);
+        if (c < psInner->prefixLength){
+            /*puts a node over the part of the prefix pcKey shares, with the
+            old node, which keeps the rest of its prefix, and the new binding
+            as its children*/
+            psSplit = SymTable_newInner(NODE4, psInner->prefix, c);
+            if (psSplit == NULL) return NULL;
+            newBinding = SymTable_newBinding(oSymTable, pcKey,
+                pcRest + c + (pcRest[c] != '\0'), pvValue, uDepth);
+            if (newBinding == NULL){
+                free(psSplit);
+                return NULL;
+            }
+            cOld = (unsigned char)psInner->prefix[c];
+            memmove(psInner->prefix, psInner->prefix + c + 1,
+                psInner->prefixLength - c - 1);
+            psInner->prefixLength -= c + 1;
+            SymTable_insertChild(psSplit, cOld, &psInner->node);
+            SymTable_insertChild(psSplit, (unsigned char)pcRest[c], &newBinding->node);
+            *ppsNode = &psSplit->node;
+            return newBinding;
+        }
+
+        uPosition += psInner->prefixLength;
+        ppsChild = SymTable_findChild(psInner, (unsigned char)pcKey[uPosition]);
+        if (ppsChild == NULL){
+            newBinding = SymTable_newBinding(oSymTable, pcKey,
+                pcKey + uPosition + (pcKey[uPosition] != '\0'), pvValue,
+                uDepth);
+            if (newBinding == NULL) return NULL;
+            if (!SymTable_addChild(ppsNode, (unsigned char)pcKey[uPosition],
+                &newBinding->node)){
+                free(newBinding);
+                return NULL;
+            }
+            return newBinding;
+        }
+        ppsNode = ppsChild;
+        uPosition++;
+    }
+}
+
+/*Takes the visible binding with pcKey, of length uKeyLength, out of the
+subtree *ppsNode of oSymTable, whose keys start at byte uPosition, and out of
+its scope, putting the binding it shadows in its place and removing the nodes
+left without children. Returns the binding, or NULL if there is none*/
+static struct Binding *SymTable_unlink(SymTable_T oSymTable,
+    struct ArtNode **ppsNode, const char *pcKey, size_t uKeyLength,
+    size_t uPosition){
+    struct Binding *current;
+    struct Binding *shadowed;
+    struct Inner *psInner;
+    struct ArtNode **ppsChild;
+    unsigned char c;
+    size_t i;
+
+    if (*ppsNode == NULL) return NULL;
+    if ((*ppsNode)->kind == LEAF){
+        current = (struct Binding *)*ppsNode;
+        if (strcmp(current->suffix, SymTable_rest(pcKey, uKeyLength, uPosition)) != 0)
+            return NULL;
+        shadowed = (struct Binding *)SymTableScopes_remove(oSymTable->scopes,
+            current);
+        if (shadowed != NULL)
+            *ppsNode = &shadowed->node;
+        else{
+            *ppsNode = NULL;
+            oSymTable->numOfBindings--;
+        }
+        return current;
+    }
+
+    psInner = (struct Inner *)*ppsNode;
+    for (i = 0; i < psInner->prefixLength; i++)
+        if (psInner->prefix[i] != pcKey[uPosition + i])
+            return NULL;
+    uPosition += psInner->prefixLength;
+    c = (unsigned char)pcKey[uPosition];
+    ppsChild = SymTable_findChild(psInner, c);
+    if (ppsChild == NULL) return NULL;
+    current = SymTable_unlink(oSymTable, ppsChild, pcKey, uKeyLength, uPosition + 1);
+    if (current != NULL && *ppsChild == NULL)
+        SymTable_removeChild(ppsNode, c);
+    return current;
+}
+
+/*Takes the visible binding psTarget, which hides no other binding and is in
+no scope but the outermost, out of the subtree *ppsNode of oSymTable, removing
+the nodes left without children.
+Every node is searched for it, for when its key is not known. Returns 1 if it
+was in the subtree, 0 if not*/
+static int SymTable_unlinkBinding(SymTable_T oSymTable, struct ArtNode **ppsNode,
+    struct Binding *psTarget){
+    struct ArtNode **ppsChild;
+    size_t uByte;
+
+    if (*ppsNode == &psTarget->node){
+        *ppsNode = NULL;
+        oSymTable->numOfBindings--;
+        return 1;
+    }
+    if ((*ppsNode)->kind == LEAF) return 0;
+    for (uByte = 0; (ppsChild = SymTable_nextChild((struct Inner *)*ppsNode,
+        &uByte)) != NULL; uByte++){
+        if (SymTable_unlinkBinding(oSymTable, ppsChild, psTarget)){
+            if (*ppsChild == NULL)
+                SymTable_removeChild(ppsNode, (unsigned char)uByte);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*Frees current, a binding of oSymTable already out of the tree and its
+scope, and returns its value*/
+static void *SymTable_dropBinding(SymTable_T oSymTable, struct Binding *current){
+    const void *temp;
+
+    temp = SymTable_oldValue(oSymTable, current->value);
+    free(current);
+    return (void *)temp;
+}
+
+/*Applies pfApply with pvExtra to every binding below psNode in key order.
+pcBuffer holds the uLength bytes of key that lead to psNode and has room for
+the longest key in the table*/
+static void SymTable_mapNode(struct ArtNode *psNode, char *pcBuffer,
+    size_t uLength,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+    struct Binding *psBinding;
+    struct Inner *psInner;
+    struct ArtNode **ppsChild;
+    size_t uByte;
+
+    if (psNode->kind == LEAF){
+        psBinding = (struct Binding *)psNode;
+        if (psBinding->key != NULL){
+            (*pfApply)(psBinding->key, (void *)psBinding->value, (void *)pvExtra);
+            return;
+        }
+        strcpy(pcBuffer + uLength, psBinding->suffix);
+        (*pfApply)(pcBuffer, (void *)psBinding->value, (void *)pvExtra);
+        return;
+    }
+    psInner = (struct Inner *)psNode;
+    memcpy(pcBuffer + uLength, psInner->prefix, psInner->prefixLength);
+    uLength += psInner->prefixLength;
+    for (uByte = 0; (ppsChild = SymTable_nextChild(psInner, &uByte)) != NULL; uByte++){
+        pcBuffer[uLength] = (char)uByte;
+        SymTable_mapNode(*ppsChild, pcBuffer, uLength + 1, pfApply, pvExtra);
+    }
+}
+
+/*Returns a buffer for map to build the keys of oSymTable in, which is
+keyBuffer unless a map of oSymTable is already using it. Returns NULL if
+insufficient memory*/
+static char *SymTable_takeBuffer(SymTable_T oSymTable){
+    if (!oSymTable->mapping){
+        oSymTable->mapping = 1;
+        return oSymTable->keyBuffer;
+    }
+    return (char *)malloc(oSymTable->keyBufferSize);
+}
+
+/*Gives back pcBuffer, which SymTable_takeBuffer returned for oSymTable*/
+static void SymTable_giveBuffer(SymTable_T oSymTable, char *pcBuffer){
+    if (pcBuffer == oSymTable->keyBuffer)
+        oSymTable->mapping = 0;
+    else
+        free(pcBuffer);
+}
+
+/*Creates a binding of oSymTable with pcKey and pvValue at the innermost scope.
+ppsSlot is the address of the pointer to the visible binding with pcKey, which
+the new binding hides, or NULL if there is none. Unless the innermost scope is
+the outermost, room for the binding must have been reserved in the scopes of
+oSymTable. Returns 1 if successful, 0 if insufficient memory*/
+static int SymTable_bind(SymTable_T oSymTable, struct ArtNode **ppsSlot,
+    const char *pcKey, const void *pvValue){
+    struct Binding *newBinding;
+    struct Binding *current = NULL;
+    char *pcNewBuffer;
+    size_t uKeyLength;
+    size_t uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+
+    /*makes sure map has room to build the key, and the '\0' a key may branch on*/
+    uKeyLength = strlen(pcKey);
+    if (uKeyLength + 2 > oSymTable->keyBufferSize){
+        pcNewBuffer = (char *)realloc(oSymTable->keyBuffer, uKeyLength + 2);
+        if (pcNewBuffer == NULL) return 0;
+        oSymTable->keyBuffer = pcNewBuffer;
+        oSymTable->keyBufferSize = uKeyLength + 2;
+    }
+
+    /*a binding that shadows another takes its place in the tree*/
+    if (ppsSlot != NULL){
+        current = (struct Binding *)*ppsSlot;
+        newBinding = SymTable_newBinding(oSymTable, pcKey,
+            pcKey + uKeyLength - strlen(current->suffix), pvValue, uDepth);
+        if (newBinding == NULL) return 0;
+        *ppsSlot = &newBinding->node;
+    }
+    else{
+        newBinding = SymTable_insert(oSymTable, pcKey, pvValue, uDepth);
+        if (newBinding == NULL) return 0;
+        oSymTable->numOfBindings++;
+    }
+
+    if (uDepth > 0)
+        SymTableScopes_add(oSymTable->scopes, newBinding, uDepth, current);
+    return 1;
+}
+
+/* State passed to the SymTable_map callback while merging*/
+struct Merge{
+    /*table the bindings are merged into*/
+    SymTable_T dest;
+
+    /*what to do with a key that dest already binds in its innermost scope*/
+    enum SymTable_MergePolicy policy;
+
+    /*function that picks the value of such a key for SYMTABLE_RESOLVE*/
+    void *(*resolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra);
+
+    /*extra argument of resolve*/
+    const void *extra;
+
+    /*1 once memory ran out, the remaining bindings are then skipped*/
+    int failed;
+};
+
+/*Brings the binding with pcKey and pvValue of the table being merged into the
+innermost scope of the destination of the struct Merge pvMerge, or if its key
+is already there sets the value of that key as the policy says. Owned keys
+are copied, since a binding keeps only the part of its key below its node*/
+static void SymTable_mergeBinding(const char *pcKey, void *pvValue,
+    void *pvMerge){
+    struct Merge *psMerge = (struct Merge *)pvMerge;
+    SymTable_T oDest = psMerge->dest;
+    struct ArtNode **ppsSlot;
+    struct Binding *existing;
+    const void *pvNew = pvValue;
+    size_t uDepth = SymTableScopes_getDepth(oDest->scopes);
+
+    if (psMerge->failed) return;
+    ppsSlot = SymTable_locate(oDest, pcKey);
+    if (ppsSlot == NULL || (uDepth > 0 &&
+        SymTableScopes_depthOf(oDest->scopes, *ppsSlot) != uDepth)){
+        if (!SymTable_bind(oDest, ppsSlot, pcKey, pvValue))
+            psMerge->failed = 1;
+        return;
+    }
+
+    existing = (struct Binding *)*ppsSlot;
+    if (psMerge->policy == SYMTABLE_KEEP_EXISTING) return;
+    if (psMerge->policy == SYMTABLE_RESOLVE)
+        pvNew = (*psMerge->resolve)(pcKey, (void *)existing->value, pvValue,
+            (void *)psMerge->extra);
+    if (oDest->valueSize == 0)
+        existing->value = pvNew;
+    else if (pvNew != existing->value)
+        SymTable_storeValue(oDest->valueSize, (void *)existing->value, pvNew);
+}
+
+SymTable_T SymTable_new(void){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL) return NULL;
+    oSymTable->numOfBindings = 0;
+    oSymTable->root = NULL;
+    oSymTable->keyBuffer = NULL;
+    oSymTable->keyBufferSize = 0;
+    oSymTable->mapping = 0;
+    oSymTable->scopes = NULL;
+    oSymTable->valueSize = 0;
+    oSymTable->oldValue = NULL;
+    oSymTable->borrowedKeys = 0;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize){
+    SymTable_T oSymTable;
+    assert(uValueSize > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->oldValue = malloc(uValueSize);
+    if (oSymTable->oldValue == NULL){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    oSymTable->valueSize = uValueSize;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newBorrowedKeys(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->borrowedKeys = 1;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newKeyHeap(void){
+    /*each key is already stored in the allocation of its binding*/
+    return SymTable_new();
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable){
+    SymTable_T oClone;
+    int iFailed = 0;
+    size_t uDepth;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize != 0)
+        oClone = SymTable_newInline(oSymTable->valueSize);
+    else
+        oClone = SymTable_new();
+    if (oClone == NULL) return NULL;
+    oClone->borrowedKeys = oSymTable->borrowedKeys;
+
+    if (oSymTable->keyBufferSize != 0){
+        oClone->keyBuffer = (char *)malloc(oSymTable->keyBufferSize);
+        if (oClone->keyBuffer == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        oClone->keyBufferSize = oSymTable->keyBufferSize;
+    }
+
+    /*gives the clone the same open scopes*/
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (uDepth != 0){
+        oClone->scopes = SymTableScopes_new();
+        if (oClone->scopes == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        for (i = 0; i < uDepth; i++){
+            if (!SymTableScopes_push(oClone->scopes)){
+                SymTable_free(oClone);
+                return NULL;
+            }
+        }
+    }
+
+    if (oSymTable->root != NULL){
+        oClone->root = SymTable_copyNode(oClone, oSymTable, oSymTable->root,
+            &iFailed);
+        if (iFailed){
+            SymTable_free(oClone);
+            return NULL;
+        }
+    }
+    oClone->numOfBindings = oSymTable->numOfBindings;
+    return oClone;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates){
+    assert(ppcKeys != NULL && ppvValues != NULL && uThreadCount > 0);
+
+    /*nodes near the root of the tree are shared by every key, so it is built
+    on the calling thread*/
+    (void)uThreadCount;
+    return SymTable_buildSerial(ppcKeys, ppvValues, uCount, puDuplicates);
+}
+
+void SymTable_free(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    SymTable_freeNode(oSymTable, oSymTable->root);
+    free(oSymTable->keyBuffer);
+    SymTableScopes_free(oSymTable->scopes);
+    free(oSymTable->oldValue);
+    free(oSymTable);
+}
+
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue)){
+    assert(oSymTable != NULL);
+
+    /*the nodes are sized for their children, only keyBuffer is kept*/
+    if (pfFreeValue != NULL)
+        SymTable_freeValues(oSymTable, oSymTable->root, pfFreeValue);
+    SymTable_freeNode(oSymTable, oSymTable->root);
+    oSymTable->root = NULL;
+    oSymTable->numOfBindings = 0;
+    SymTableScopes_clear(oSymTable->scopes);
+    return 1;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+    return oSymTable->numOfBindings;
+}
+
+int SymTable_presize(SymTable_T oSymTable, size_t uCount){
+    assert(oSymTable != NULL);
+    /*a radix tree grows one node at a time as keys are put*/
+    (void)uCount;
+    return 1;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    struct ArtNode **ppsSlot;
+    size_t uDepth;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey);
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (ppsSlot != NULL && (uDepth == 0 ||
+        SymTableScopes_depthOf(oSymTable->scopes, *ppsSlot) == uDepth))
+        return 0;
+    if (uDepth > 0 && !SymTableScopes_reserve(oSymTable->scopes, 1)) return 0;
+    return SymTable_bind(oSymTable, ppsSlot, pcKey, pvValue);
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    struct ArtNode **ppsSlot;
+    struct Binding *current;
+    const void *temp;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey);
+    if (ppsSlot == NULL) return NULL;
+    current = (struct Binding *)*ppsSlot;
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, current->value);
+        SymTable_storeValue(oSymTable->valueSize, (void *)current->value, pvValue);
+        return (void *)temp;
+    }
+    temp = current->value;
+    current->value = pvValue;
+    return (void *)temp;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(oSymTable != NULL && pcKey != NULL);
+    return SymTable_locate(oSymTable, pcKey) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    struct ArtNode **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey);
+    if (ppsSlot == NULL) return NULL;
+    return (void *)((struct Binding *)*ppsSlot)->value;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    struct Binding *current;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    current = SymTable_unlink(oSymTable, &oSymTable->root, pcKey, strlen(pcKey), 0);
+    if (current == NULL) return NULL;
+    return SymTable_dropBinding(oSymTable, current);
+}
+
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey){
+    struct ArtNode **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    /*the handle is the binding, which is given its whole key so that
+    SymTable_handleRemove can follow it down the tree*/
+    ppsSlot = SymTable_locate(oSymTable, pcKey);
+    if (ppsSlot == NULL) return NULL;
+    return (SymTable_Handle)SymTable_keepKey(oSymTable, ppsSlot, pcKey);
+}
+
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return (void *)((struct Binding *)oHandle)->value;
+}
+
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue){
+    struct Binding *current = (struct Binding *)oHandle;
+    const void *temp;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, current->value);
+        SymTable_storeValue(oSymTable->valueSize, (void *)current->value, pvValue);
+        return (void *)temp;
+    }
+    temp = current->value;
+    current->value = pvValue;
+    return (void *)temp;
+}
+
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle){
+    struct Binding *current = (struct Binding *)oHandle;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    /*the tree is only searched for a binding that could not be given its
+    whole key*/
+    if (current->key != NULL)
+        current = SymTable_unlink(oSymTable, &oSymTable->root, current->key,
+            strlen(current->key), 0);
+    else
+        SymTable_unlinkBinding(oSymTable, &oSymTable->root, current);
+    assert(current == (struct Binding *)oHandle);
+    return SymTable_dropBinding(oSymTable, current);
+}
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        char *pcBuffer;
+        assert(oSymTable != NULL && pfApply != NULL);
+
+        if (oSymTable->root == NULL) return;
+        pcBuffer = SymTable_takeBuffer(oSymTable);
+        if (pcBuffer == NULL) return;
+        SymTable_mapNode(oSymTable->root, pcBuffer, 0, pfApply, pvExtra);
+        SymTable_giveBuffer(oSymTable, pcBuffer);
+}
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct ArtNode *psNode;
+        struct ArtNode **ppsChild;
+        struct Inner *psInner;
+        struct Binding *psBinding;
+        char *pcBuffer;
+        size_t uPrefixLength;
+        size_t uPosition = 0;
+        size_t i;
+        assert(oSymTable != NULL && pcPrefix != NULL && pfApply != NULL);
+
+        if (oSymTable->root == NULL) return;
+        pcBuffer = SymTable_takeBuffer(oSymTable);
+        if (pcBuffer == NULL) return;
+        uPrefixLength = strlen(pcPrefix);
+
+        /*walks down while pcPrefix goes on, then maps the subtree it ends in*/
+        psNode = oSymTable->root;
+        while (psNode != NULL){
+            if (psNode->kind == LEAF){
+                psBinding = (struct Binding *)psNode;
+                if (psBinding->key == NULL){
+                    memcpy(pcBuffer, pcPrefix, uPosition);
+                    strcpy(pcBuffer + uPosition, psBinding->suffix);
+                }
+                if (strncmp((psBinding->key != NULL) ? psBinding->key : pcBuffer,
+                    pcPrefix, uPrefixLength) == 0)
+                    SymTable_mapNode(psNode, pcBuffer, uPosition, pfApply, pvExtra);
+                break;
+            }
+            psInner = (struct Inner *)psNode;
+            for (i = 0; i < psInner->prefixLength && uPosition + i < uPrefixLength; i++)
+                if (psInner->prefix[i] != pcPrefix[uPosition + i])
+                    break;
+            if (uPosition + i == uPrefixLength){
+                memcpy(pcBuffer, pcPrefix, uPosition);
+                SymTable_mapNode(psNode, pcBuffer, uPosition, pfApply, pvExtra);
+                break;
+            }
+            if (i < psInner->prefixLength) break;
+            uPosition += psInner->prefixLength;
+            ppsChild = SymTable_findChild(psInner, (unsigned char)pcPrefix[uPosition]);
+            psNode = (ppsChild != NULL) ? *ppsChild : NULL;
+            uPosition++;
+        }
+        SymTable_giveBuffer(oSymTable, pcBuffer);
+}
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    struct Merge sMerge;
+
+    assert(oDest != NULL && oSource != NULL && oDest != oSource);
+    assert(SymTableScopes_getDepth(oSource->scopes) == 0 &&
+        oSource->valueSize == oDest->valueSize &&
+        oSource->borrowedKeys == oDest->borrowedKeys);
+    assert(ePolicy != SYMTABLE_RESOLVE || pfResolve != NULL);
+
+    /*makes room in an inner scope of oDest for every binding before any moves*/
+    if (SymTableScopes_getDepth(oDest->scopes) > 0 &&
+        !SymTableScopes_reserve(oDest->scopes, oSource->numOfBindings))
+        return 0;
+
+    sMerge.dest = oDest;
+    sMerge.policy = ePolicy;
+    sMerge.resolve = pfResolve;
+    sMerge.extra = pvExtra;
+    sMerge.failed = 0;
+    SymTable_map(oSource, SymTable_mergeBinding, &sMerge);
+    if (sMerge.failed) return 0;
+    SymTable_free(oSource);
+    return 1;
+}
+
+int SymTable_pushScope(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    if (oSymTable->scopes == NULL){
+        oSymTable->scopes = SymTableScopes_new();
+        if (oSymTable->scopes == NULL) return 0;
+    }
+    return SymTableScopes_push(oSymTable->scopes);
+}
+
+int SymTable_popScope(SymTable_T oSymTable){
+    struct Binding *current;
+    assert(oSymTable != NULL);
+
+    if (SymTableScopes_getDepth(oSymTable->scopes) == 0) return 0;
+
+    /*bindings of the innermost scope are always visible and keep their whole
+    key, so each can be found again*/
+    while ((current = (struct Binding *)SymTableScopes_last(oSymTable->scopes))
+        != NULL){
+        SymTable_unlink(oSymTable, &oSymTable->root, current->key,
+            strlen(current->key), 0);
+        free(current);
+    }
+    SymTableScopes_pop(oSymTable->scopes);
+    return 1;
+}
+
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth){
+    struct ArtNode **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL && puDepth != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey);
+    if (ppsSlot == NULL) return NULL;
+    *puDepth = SymTableScopes_depthOf(oSymTable->scopes, *ppsSlot);
+    return (void *)((struct Binding *)*ppsSlot)->value;
+}
@@ -0,0 +1,139 @@
+/*--------------------------------------------------------------------*/
+/* symtableasync.c                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtableasync.h"
+
+/*tables are freed on a POSIX thread where the system has them, building
+with -DSYMTABLE_NO_THREADS frees them in SymTable_freeAsync*/
+#if defined(__unix__) && !defined(SYMTABLE_NO_THREADS)
+#include <pthread.h>
+#define SYMTABLE_THREADS
+#endif
+
+#ifdef SYMTABLE_THREADS
+/* Represents a table waiting to be freed*/
+struct PendingFree{
+    /*table to free*/
+    SymTable_T table;
+
+    /*next table to free, in the order they were handed over*/
+    struct PendingFree *next;
+};
+
+/*guards every variable below*/
+static pthread_mutex_t sLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*signalled when a table is added to the queue or the thread must stop*/
+static pthread_cond_t sWork = PTHREAD_COND_INITIALIZER;
+
+/*signalled when the thread has freed every table in the queue*/
+static pthread_cond_t sIdle = PTHREAD_COND_INITIALIZER;
+
+/*first and last tables waiting to be freed*/
+static struct PendingFree *psFirst = NULL;
+static struct PendingFree *psLast = NULL;
+
+/*1 while the thread is freeing a table it took off the queue*/
+static int iBusy = 0;
+
+/*1 while the thread is running*/
+static int iRunning = 0;
+
+/*1 once SymTable_drainPendingFrees has asked the thread to stop*/
+static int iStopping = 0;
+
+/*the thread that frees the tables*/
+static pthread_t sThread;
+
+/*Frees the tables in the queue as they arrive until asked to stop. pvArg is
+unused*/
+static void *SymTable_freeLoop(void *pvArg){
+    struct PendingFree *psPending;
+    (void)pvArg;
+
+    pthread_mutex_lock(&sLock);
+    for (;;){
+        while (psFirst == NULL && !iStopping)
+            pthread_cond_wait(&sWork, &sLock);
+        if (psFirst == NULL) break;
+        psPending = psFirst;
+        psFirst = psPending->next;
+        if (psFirst == NULL) psLast = NULL;
+        iBusy = 1;
+
+        /*frees outside the lock so that callers never wait for a table*/
+        pthread_mutex_unlock(&sLock);
+        SymTable_free(psPending->table);
+        free(psPending);
+        pthread_mutex_lock(&sLock);
+
+        iBusy = 0;
+        if (psFirst == NULL)
+            pthread_cond_broadcast(&sIdle);
+    }
+    pthread_mutex_unlock(&sLock);
+    return NULL;
+}
+#endif
+
+void SymTable_freeAsync(SymTable_T oSymTable){
+#ifdef SYMTABLE_THREADS
+    struct PendingFree *psPending;
+    assert(oSymTable != NULL);
+
+    psPending = (struct PendingFree *)malloc(sizeof(struct PendingFree));
+    if (psPending == NULL){
+        SymTable_free(oSymTable);
+        return;
+    }
+    psPending->table = oSymTable;
+    psPending->next = NULL;
+
+    pthread_mutex_lock(&sLock);
+    if (!iRunning){
+        if (pthread_create(&sThread, NULL, SymTable_freeLoop, NULL) != 0){
+            pthread_mutex_unlock(&sLock);
+            free(psPending);
+            SymTable_free(oSymTable);
+            return;
+        }
+        iRunning = 1;
+    }
+    if (psLast != NULL)
+        psLast->next = psPending;
+    else
+        psFirst = psPending;
+    psLast = psPending;
+    pthread_cond_signal(&sWork);
+    pthread_mutex_unlock(&sLock);
+#else
+    assert(oSymTable != NULL);
+    SymTable_free(oSymTable);
+#endif
+}
+
+void SymTable_drainPendingFrees(void){
+#ifdef SYMTABLE_THREADS
+    pthread_mutex_lock(&sLock);
+    if (!iRunning){
+        pthread_mutex_unlock(&sLock);
+        return;
+    }
+    while (psFirst != NULL || iBusy)
+        pthread_cond_wait(&sIdle, &sLock);
+    iStopping = 1;
+    pthread_cond_signal(&sWork);
+    pthread_mutex_unlock(&sLock);
+
+    pthread_join(sThread, NULL);
+    pthread_mutex_lock(&sLock);
+    iRunning = 0;
+    iStopping = 0;
+    pthread_mutex_unlock(&sLock);
+#endif
+}
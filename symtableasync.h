@@ -0,0 +1,24 @@
+/*--------------------------------------------------------------------*/
+/* symtableasync.h                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEASYNC_INCLUDED
+#define SYMTABLEASYNC_INCLUDED
+
+#include "symtable.h"
+
+/*Hands oSymTable to a background thread that frees all the memory associated
+with it, and returns without waiting. oSymTable must not be used afterwards.
+Tables that share memory with oSymTable, such as the clones of a HAMT table,
+must not be changed, cloned or freed until it has been freed. Frees oSymTable
+before returning if no thread can be started or memory is insufficient*/
+void SymTable_freeAsync(SymTable_T oSymTable);
+
+/*Waits until every table passed to SymTable_freeAsync has been freed, then
+stops the background thread. It must not run at the same time as another
+call to it or to SymTable_freeAsync. SymTable_freeAsync may be called again
+afterwards*/
+void SymTable_drainPendingFrees(void);
+
+#endif
@@ -0,0 +1,33 @@
+/*--------------------------------------------------------------------*/
+/* symtablebloom.h                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEBLOOM_INCLUDED
+#define SYMTABLEBLOOM_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Counters of the Bloom filter that symtablehash.c keeps in front of its
+buckets when built with -DSYMTABLE_BLOOM. The false positive rate is
+falsePositives / (rejected + falsePositives) of the lookups of keys not in the
+table, or falsePositives / lookups of all lookups*/
+struct SymTableBloomStats{
+    /*lookups by contains, get, getInnermost, replace, find and remove checked
+    against the filter*/
+    size_t lookups;
+
+    /*lookups the filter answered without reading a bucket*/
+    size_t rejected;
+
+    /*lookups the filter let through whose key was not in the table*/
+    size_t falsePositives;
+};
+
+/*Stores the counters of the Bloom filter of oSymTable in *psStats, all 0 if
+oSymTable has no filter*/
+void SymTable_getBloomStats(SymTable_T oSymTable,
+    struct SymTableBloomStats *psStats);
+
+#endif
@@ -0,0 +1,37 @@
+/*--------------------------------------------------------------------*/
+/* symtablebuild.c                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include "symtablebuild.h"
+
+SymTable_T SymTable_buildSerial(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t *puDuplicates){
+    SymTable_T oSymTable;
+    size_t uDuplicates = 0;
+    size_t i;
+    assert(ppcKeys != NULL && ppvValues != NULL);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    if (!SymTable_presize(oSymTable, uCount)){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    /*a put that fails on a key already bound is a duplicate, any other
+    failure is insufficient memory*/
+    for (i = 0; i < uCount; i++){
+        if (SymTable_put(oSymTable, ppcKeys[i], ppvValues[i])) continue;
+        if (!SymTable_contains(oSymTable, ppcKeys[i])){
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+        uDuplicates++;
+    }
+    if (puDuplicates != NULL)
+        *puDuplicates = uDuplicates;
+    return oSymTable;
+}
@@ -0,0 +1,20 @@
+/*--------------------------------------------------------------------*/
+/* symtablebuild.h                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEBUILD_INCLUDED
+#define SYMTABLEBUILD_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Builds and returns a SymTable like SymTable_buildParallel, but on the
+calling thread: the table is presized for uCount keys, then the keys are put
+one at a time in order. This is how SymTable_buildParallel works for
+implementations that cannot split the work between threads. Returns NULL if
+insufficient memory*/
+SymTable_T SymTable_buildSerial(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t *puDuplicates);
+
+#endif
@@ -0,0 +1,955 @@
+/*--------------------------------------------------------------------*/
+/* symtablecompact.c                                                  */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "symtable.h"
+#include "symtablebuild.h"
+
+/*index that stands for no binding, so a table holds at most NO_BINDING
+bindings*/
+#define NO_BINDING UINT32_MAX
+
+/*number of buckets of a new table, a power of 2*/
+static const size_t INITIAL_BUCKET_COUNT = 64;
+
+/*number of bindings the array of a table holds when it is first allocated*/
+static const size_t INITIAL_BINDING_COUNT = 64;
+
+/* Represents a binding in the symbol table. Bindings live in one array of
+   the table and refer to each other by their index in it, which is half
+   the size of a pointer*/
+struct Binding{
+    /*key of the binding that is a string, owned by the table unless it
+    borrows keys, NULL while the binding is free*/
+    const char *key;
+
+    /*value of the binding that is a void pointer, or in an inline table a
+    pointer to a block allocated for the binding*/
+    const void *value;
+
+    /*index of the next binding in the bucket, or of the next free binding
+    while the binding is free*/
+    uint32_t next;
+};
+
+/* Represents the scope of a binding. The scopes of the bindings live in an
+   array of the table parallel to the bindings, which is only allocated once
+   the table opens a scope*/
+struct BindingScope{
+    /*index of the binding with the same key in an outer scope that this
+    binding hides, it is in no bucket while it is hidden*/
+    uint32_t shadowed;
+
+    /*index of the next binding put in the same scope, unused in the
+    outermost scope*/
+    uint32_t scopeNext;
+
+    /*depth of the scope the binding was put in, 0 for the outermost scope*/
+    uint32_t depth;
+};
+
+/* Represents the symbol table*/
+struct SymTable{
+    /*number of buckets, a power of 2*/
+    size_t numOfBuckets;
+
+    /*number of visible bindings*/
+    size_t numOfBindings;
+
+    /*index of the first binding in each bucket, NO_BINDING if it is empty*/
+    uint32_t *buckets;
+
+    /*every binding of the table, visible, hidden or free*/
+    struct Binding *bindings;
+
+    /*number of entries of bindings in use, visible, hidden or free*/
+    size_t bindingsUsed;
+
+    /*number of entries allocated in bindings*/
+    size_t bindingsCapacity;
+
+    /*index of the first free binding below bindingsUsed, NO_BINDING if none*/
+    uint32_t freeBindings;
+
+    /*depth of the innermost scope, 0 when only the outermost scope is open*/
+    size_t numOfScopes;
+
+    /*number of entries allocated in scopes*/
+    size_t scopesCapacity;
+
+    /*scopes[d] is the index of the last binding put in open scope d, for
+    1 <= d <= numOfScopes*/
+    uint32_t *scopes;
+
+    /*scope of each entry of bindings, with as many entries allocated, or NULL
+    until the first pushScope, when every binding is in the outermost scope*/
+    struct BindingScope *bindingScopes;
+
+    /*size of the values stored in the bindings, 0 if values are void pointers*/
+    size_t valueSize;
+
+    /*copy of the last value replaced or removed from an inline table*/
+    void *oldValue;
+
+    /*1 if the bindings point to the callers' keys instead of copies*/
+    int borrowedKeys;
+};
+
+/* Return a hash code for pcKey that uses all the bits of a size_t. */
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = (size_t)1099511628211UL;
+   const size_t MIX_MULTIPLIER = (size_t)0xff51afd7ed558ccdUL;
+   size_t u;
+   size_t uHash = (size_t)14695981039346656037UL;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+      uHash = (uHash ^ (size_t)(unsigned char)pcKey[u]) * HASH_MULTIPLIER;
+
+   uHash ^= uHash >> 33;
+   uHash *= MIX_MULTIPLIER;
+   uHash ^= uHash >> 33;
+   return uHash;
+}
+
+/*Returns the bucket of pcKey in oSymTable*/
+static size_t SymTable_bucket(SymTable_T oSymTable, const char *pcKey){
+    return SymTable_hash(pcKey) & (oSymTable->numOfBuckets - 1);
+}
+
+/*Copies the uValueSize bytes at pvValue, or zeros if pvValue is NULL, into
+the inline value pvDest*/
+static void SymTable_storeValue(size_t uValueSize, void *pvDest,
+    const void *pvValue){
+    if (pvValue != NULL)
+        memcpy(pvDest, pvValue, uValueSize);
+    else
+        memset(pvDest, 0, uValueSize);
+}
+
+/*Returns the key to store for pcKey in oSymTable, which is pcKey itself if
+oSymTable borrows keys and a copy of it otherwise. Returns NULL if insufficient
+memory*/
+static const char *SymTable_keepKey(SymTable_T oSymTable, const char *pcKey){
+    char *pcCopy;
+
+    if (oSymTable->borrowedKeys) return pcKey;
+    pcCopy = (char *)malloc(strlen(pcKey) + 1);
+    if (pcCopy == NULL) return NULL;
+    return strcpy(pcCopy, pcKey);
+}
+
+/*Frees the key pcKey of a binding of oSymTable unless oSymTable borrows keys*/
+static void SymTable_dropKey(SymTable_T oSymTable, const char *pcKey){
+    if (!oSymTable->borrowedKeys)
+        free((void *)pcKey);
+}
+
+/*Returns an empty array of uCount buckets, or NULL if insufficient memory*/
+static uint32_t *SymTable_newBuckets(size_t uCount){
+    uint32_t *auBuckets;
+
+    /*NO_BINDING has every bit set, so every byte of an empty bucket is 0xff*/
+    auBuckets = (uint32_t *)malloc(uCount * sizeof(uint32_t));
+    if (auBuckets == NULL) return NULL;
+    memset(auBuckets, 0xff, uCount * sizeof(uint32_t));
+    return auBuckets;
+}
+
+/*Moves every visible binding of oSymTable into a new array of uCount buckets,
+a power of 2. Returns 1 if successful, 0 if insufficient memory, leaving
+oSymTable unchanged*/
+static int SymTable_grow(SymTable_T oSymTable, size_t uCount){
+    uint32_t *newBuckets;
+    struct Binding *psBinding;
+    uint32_t current;
+    uint32_t next;
+    size_t hash;
+    size_t i;
+
+    newBuckets = SymTable_newBuckets(uCount);
+    if (newBuckets == NULL) return 0;
+
+    /*the bindings hold no hash codes, so each key is hashed again*/
+    for (i = 0; i < oSymTable->numOfBuckets; i++){
+        for (current = oSymTable->buckets[i]; current != NO_BINDING;
+            current = next){
+            psBinding = &oSymTable->bindings[current];
+            next = psBinding->next;
+            hash = SymTable_hash(psBinding->key) & (uCount - 1);
+            psBinding->next = newBuckets[hash];
+            newBuckets[hash] = current;
+        }
+    }
+    free(oSymTable->buckets);
+    oSymTable->buckets = newBuckets;
+    oSymTable->numOfBuckets = uCount;
+    return 1;
+}
+
+/*Makes room in the array of bindings of oSymTable, and in the scopes of the
+bindings if it has them, for at least uCount bindings. Returns 1 if
+successful, 0 if insufficient memory or if uCount is more than a table can
+index, leaving the capacity of oSymTable unchanged*/
+static int SymTable_reserve(SymTable_T oSymTable, size_t uCount){
+    struct Binding *newBindings;
+    struct BindingScope *newScopes;
+    size_t newCapacity = oSymTable->bindingsCapacity;
+
+    if (uCount <= newCapacity) return 1;
+    if (uCount > NO_BINDING ||
+        uCount > (size_t)-1 / sizeof(struct Binding)) return 0;
+    if (newCapacity == 0)
+        newCapacity = INITIAL_BINDING_COUNT;
+    while (newCapacity < uCount)
+        newCapacity *= 2;
+    if (newCapacity > NO_BINDING ||
+        newCapacity > (size_t)-1 / sizeof(struct Binding))
+        newCapacity = uCount;
+
+    /*an array that grew before the other failed to is just larger than the
+    capacity says*/
+    if (oSymTable->bindingScopes != NULL){
+        if (newCapacity > (size_t)-1 / sizeof(struct BindingScope)) return 0;
+        newScopes = (struct BindingScope *)realloc(oSymTable->bindingScopes,
+            newCapacity * sizeof(struct BindingScope));
+        if (newScopes == NULL) return 0;
+        oSymTable->bindingScopes = newScopes;
+    }
+    newBindings = (struct Binding *)realloc(oSymTable->bindings,
+        newCapacity * sizeof(struct Binding));
+    if (newBindings == NULL) return 0;
+    oSymTable->bindings = newBindings;
+    oSymTable->bindingsCapacity = newCapacity;
+    return 1;
+}
+
+/*Gives the bindings of oSymTable their scopes, all of them in the outermost
+scope, the first time oSymTable opens a scope. Returns 1 if successful, 0 if
+insufficient memory*/
+static int SymTable_allocScopes(SymTable_T oSymTable){
+    struct BindingScope *psScope;
+    size_t i;
+
+    if (oSymTable->bindingScopes != NULL) return 1;
+    if (!SymTable_reserve(oSymTable, INITIAL_BINDING_COUNT)) return 0;
+    oSymTable->bindingScopes = (struct BindingScope *)malloc(
+        oSymTable->bindingsCapacity * sizeof(struct BindingScope));
+    if (oSymTable->bindingScopes == NULL) return 0;
+    for (i = 0; i < oSymTable->bindingsUsed; i++){
+        psScope = &oSymTable->bindingScopes[i];
+        psScope->shadowed = NO_BINDING;
+        psScope->scopeNext = NO_BINDING;
+        psScope->depth = 0;
+    }
+    return 1;
+}
+
+/*Returns the depth of the scope binding uIndex of oSymTable was put in*/
+static size_t SymTable_depth(SymTable_T oSymTable, uint32_t uIndex){
+    if (oSymTable->bindingScopes == NULL) return 0;
+    return oSymTable->bindingScopes[uIndex].depth;
+}
+
+/*Returns the index of a binding of oSymTable with pcKey and pvValue, which
+it takes as they are, at the innermost scope, hiding nothing and in no
+bucket. The array of bindings may move. Returns NO_BINDING if insufficient
+memory*/
+static uint32_t SymTable_addBinding(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+    struct Binding *psBinding;
+    struct BindingScope *psScope;
+    uint32_t index;
+
+    /*a free binding is reused before the array grows*/
+    if (oSymTable->freeBindings != NO_BINDING){
+        index = oSymTable->freeBindings;
+        oSymTable->freeBindings = oSymTable->bindings[index].next;
+    }
+    else{
+        if (!SymTable_reserve(oSymTable, oSymTable->bindingsUsed + 1))
+            return NO_BINDING;
+        index = (uint32_t)oSymTable->bindingsUsed++;
+    }
+    psBinding = &oSymTable->bindings[index];
+    psBinding->key = pcKey;
+    psBinding->value = pvValue;
+    psBinding->next = NO_BINDING;
+    if (oSymTable->bindingScopes != NULL){
+        psScope = &oSymTable->bindingScopes[index];
+        psScope->shadowed = NO_BINDING;
+        psScope->scopeNext = NO_BINDING;
+        psScope->depth = (uint32_t)oSymTable->numOfScopes;
+    }
+    return index;
+}
+
+/*Frees the key and inline value of binding uIndex of oSymTable and puts it on
+the list of free bindings*/
+static void SymTable_freeBinding(SymTable_T oSymTable, uint32_t uIndex){
+    struct Binding *psBinding = &oSymTable->bindings[uIndex];
+
+    SymTable_dropKey(oSymTable, psBinding->key);
+    if (oSymTable->valueSize != 0)
+        free((void *)psBinding->value);
+    psBinding->key = NULL;
+    psBinding->next = oSymTable->freeBindings;
+    oSymTable->freeBindings = uIndex;
+}
+
+/*Returns the index of a new binding of oSymTable with a copy of pcKey unless
+oSymTable borrows keys, and pvValue, at the innermost scope, hiding nothing
+and in no bucket. The array of bindings may move. Returns NO_BINDING if
+insufficient memory*/
+static uint32_t SymTable_newBinding(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+    const char *pcKeep;
+    void *pvBlock = NULL;
+    uint32_t index;
+
+    pcKeep = SymTable_keepKey(oSymTable, pcKey);
+    if (pcKeep == NULL) return NO_BINDING;
+
+    /*an inline value gets a block of its own, so that it stays where it is
+    when the array of bindings moves*/
+    if (oSymTable->valueSize != 0){
+        pvBlock = malloc(oSymTable->valueSize);
+        if (pvBlock == NULL){
+            SymTable_dropKey(oSymTable, pcKeep);
+            return NO_BINDING;
+        }
+        SymTable_storeValue(oSymTable->valueSize, pvBlock, pvValue);
+        pvValue = pvBlock;
+    }
+
+    index = SymTable_addBinding(oSymTable, pcKeep, pvValue);
+    if (index == NO_BINDING){
+        SymTable_dropKey(oSymTable, pcKeep);
+        free(pvBlock);
+    }
+    return index;
+}
+
+/*Returns the value pvValue of a binding of oSymTable that is being replaced or
+removed, saving a copy of it first if oSymTable is inline*/
+static void *SymTable_oldValue(SymTable_T oSymTable, const void *pvValue){
+    if (oSymTable->valueSize == 0) return (void *)pvValue;
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/*Returns the index of the visible binding with pcKey in bucket uBucket of
+oSymTable, or NO_BINDING if there is none. Stores in *puPrev the index of the
+binding before it in the bucket, NO_BINDING if it is the first, or of the last
+binding in the bucket if there is none*/
+static uint32_t SymTable_locate(SymTable_T oSymTable, const char *pcKey,
+    size_t uBucket, uint32_t *puPrev){
+    uint32_t current;
+    uint32_t prev = NO_BINDING;
+
+    for (current = oSymTable->buckets[uBucket]; current != NO_BINDING;
+        current = oSymTable->bindings[current].next){
+        if (strcmp(oSymTable->bindings[current].key, pcKey) == 0){
+            *puPrev = prev;
+            return current;
+        }
+        prev = current;
+    }
+    *puPrev = prev;
+    return NO_BINDING;
+}
+
+/*Returns the address of the index of the binding that follows uPrev in bucket
+uBucket of oSymTable, or of the first binding if uPrev is NO_BINDING. It is
+only valid until the array of bindings moves*/
+static uint32_t *SymTable_link(SymTable_T oSymTable, size_t uBucket,
+    uint32_t uPrev){
+    if (uPrev == NO_BINDING) return &oSymTable->buckets[uBucket];
+    return &oSymTable->bindings[uPrev].next;
+}
+
+/*Returns the handle of binding uIndex, which is its index plus 1 so that no
+handle is NULL*/
+static SymTable_Handle SymTable_handleOf(uint32_t uIndex){
+    return (SymTable_Handle)(uintptr_t)(uIndex + 1);
+}
+
+/*Returns the index of the binding oHandle refers to*/
+static uint32_t SymTable_indexOf(SymTable_Handle oHandle){
+    return (uint32_t)((uintptr_t)oHandle - 1);
+}
+
+/*Makes binding uIndex of oSymTable, which is not in any bucket, the visible
+binding for its key, in the place of uFound, the visible binding it hides that
+follows uPrev in bucket uBucket, or first in bucket uBucket if uFound is
+NO_BINDING, and adds it to the list of its scope*/
+static void SymTable_insert(SymTable_T oSymTable, uint32_t uIndex,
+    size_t uBucket, uint32_t uFound, uint32_t uPrev){
+    struct Binding *psBinding = &oSymTable->bindings[uIndex];
+    struct BindingScope *psScope;
+
+    /*only a binding in an inner scope can hide another*/
+    if (uFound != NO_BINDING){
+        oSymTable->bindingScopes[uIndex].shadowed = uFound;
+        psBinding->next = oSymTable->bindings[uFound].next;
+        *SymTable_link(oSymTable, uBucket, uPrev) = uIndex;
+    }
+    else{
+        psBinding->next = oSymTable->buckets[uBucket];
+        oSymTable->buckets[uBucket] = uIndex;
+        oSymTable->numOfBindings++;
+    }
+    if (SymTable_depth(oSymTable, uIndex) > 0){
+        psScope = &oSymTable->bindingScopes[uIndex];
+        psScope->scopeNext = oSymTable->scopes[psScope->depth];
+        oSymTable->scopes[psScope->depth] = uIndex;
+    }
+}
+
+/*Takes the visible binding *puLink out of its bucket of oSymTable, putting the
+binding it shadows in its place*/
+static void SymTable_unlink(SymTable_T oSymTable, uint32_t *puLink){
+    struct Binding *psBinding = &oSymTable->bindings[*puLink];
+    uint32_t shadowed = NO_BINDING;
+
+    if (oSymTable->bindingScopes != NULL)
+        shadowed = oSymTable->bindingScopes[*puLink].shadowed;
+    if (shadowed != NO_BINDING){
+        oSymTable->bindings[shadowed].next = psBinding->next;
+        *puLink = shadowed;
+        return;
+    }
+    *puLink = psBinding->next;
+    oSymTable->numOfBindings--;
+}
+
+/*Removes the visible binding *puLink from oSymTable and returns its value*/
+static void *SymTable_removeLink(SymTable_T oSymTable, uint32_t *puLink){
+    struct Binding *psBinding;
+    uint32_t found = *puLink;
+    const void *temp;
+
+    SymTable_unlink(oSymTable, puLink);
+    psBinding = &oSymTable->bindings[found];
+
+    /*takes the binding off the list of its scope*/
+    if (SymTable_depth(oSymTable, found) > 0){
+        puLink = &oSymTable->scopes[oSymTable->bindingScopes[found].depth];
+        while (*puLink != found)
+            puLink = &oSymTable->bindingScopes[*puLink].scopeNext;
+        *puLink = oSymTable->bindingScopes[found].scopeNext;
+    }
+
+    temp = SymTable_oldValue(oSymTable, psBinding->value);
+    SymTable_freeBinding(oSymTable, found);
+    return (void *)temp;
+}
+
+/*Sets the value of binding uIndex of oSymTable to pvValue and returns the old
+one*/
+static void *SymTable_setValue(SymTable_T oSymTable, uint32_t uIndex,
+    const void *pvValue){
+    struct Binding *psBinding = &oSymTable->bindings[uIndex];
+    const void *temp;
+
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, psBinding->value);
+        SymTable_storeValue(oSymTable->valueSize, (void *)psBinding->value, pvValue);
+        return (void *)temp;
+    }
+    temp = psBinding->value;
+    psBinding->value = pvValue;
+    return (void *)temp;
+}
+
+/*Sets the value *ppvValue of the binding of oSymTable with pcKey, which a merge
+also brings the value pvIncoming for, as ePolicy says*/
+static void SymTable_resolve(SymTable_T oSymTable, const char *pcKey,
+    const void **ppvValue, const void *pvIncoming,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    const void *pvValue = pvIncoming;
+
+    if (ePolicy == SYMTABLE_KEEP_EXISTING) return;
+    if (ePolicy == SYMTABLE_RESOLVE)
+        pvValue = (*pfResolve)(pcKey, (void *)*ppvValue, (void *)pvIncoming,
+            (void *)pvExtra);
+    if (oSymTable->valueSize == 0)
+        *ppvValue = pvValue;
+    else if (pvValue != *ppvValue)
+        SymTable_storeValue(oSymTable->valueSize, (void *)*ppvValue, pvValue);
+}
+
+SymTable_T SymTable_new(void){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL) return NULL;
+    oSymTable->buckets = SymTable_newBuckets(INITIAL_BUCKET_COUNT);
+    if (oSymTable->buckets == NULL){
+        free(oSymTable);
+        return NULL;
+    }
+    oSymTable->numOfBuckets = INITIAL_BUCKET_COUNT;
+    oSymTable->numOfBindings = 0;
+    oSymTable->bindings = NULL;
+    oSymTable->bindingsUsed = 0;
+    oSymTable->bindingsCapacity = 0;
+    oSymTable->freeBindings = NO_BINDING;
+    oSymTable->numOfScopes = 0;
+    oSymTable->scopesCapacity = 0;
+    oSymTable->scopes = NULL;
+    oSymTable->bindingScopes = NULL;
+    oSymTable->valueSize = 0;
+    oSymTable->oldValue = NULL;
+    oSymTable->borrowedKeys = 0;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize){
+    SymTable_T oSymTable;
+    assert(uValueSize > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->oldValue = malloc(uValueSize);
+    if (oSymTable->oldValue == NULL){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    oSymTable->valueSize = uValueSize;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newBorrowedKeys(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->borrowedKeys = 1;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newKeyHeap(void){
+    /*keys stay allocated one by one, only the bindings share an array*/
+    return SymTable_new();
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable){
+    SymTable_T oClone;
+    struct Binding *psBinding;
+    const char *pcKey;
+    void *pvBlock;
+    size_t i;
+    size_t j;
+
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize != 0)
+        oClone = SymTable_newInline(oSymTable->valueSize);
+    else
+        oClone = SymTable_new();
+    if (oClone == NULL) return NULL;
+    oClone->borrowedKeys = oSymTable->borrowedKeys;
+
+    /*the indices stay the same, so the arrays are copied as they are*/
+    if (!SymTable_grow(oClone, oSymTable->numOfBuckets) ||
+        !SymTable_reserve(oClone, oSymTable->bindingsUsed)){
+        SymTable_free(oClone);
+        return NULL;
+    }
+    if (oSymTable->bindingScopes != NULL){
+        if (!SymTable_allocScopes(oClone)){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        if (oSymTable->bindingsUsed != 0)
+            memcpy(oClone->bindingScopes, oSymTable->bindingScopes,
+                oSymTable->bindingsUsed * sizeof(struct BindingScope));
+    }
+    if (oSymTable->numOfScopes != 0){
+        oClone->scopes = (uint32_t *)malloc((oSymTable->numOfScopes + 1) *
+            sizeof(uint32_t));
+        if (oClone->scopes == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        memcpy(oClone->scopes, oSymTable->scopes,
+            (oSymTable->numOfScopes + 1) * sizeof(uint32_t));
+        oClone->scopesCapacity = oSymTable->numOfScopes + 1;
+        oClone->numOfScopes = oSymTable->numOfScopes;
+    }
+    memcpy(oClone->buckets, oSymTable->buckets,
+        oSymTable->numOfBuckets * sizeof(uint32_t));
+    if (oSymTable->bindingsUsed != 0)
+        memcpy(oClone->bindings, oSymTable->bindings,
+            oSymTable->bindingsUsed * sizeof(struct Binding));
+    oClone->bindingsUsed = oSymTable->bindingsUsed;
+    oClone->freeBindings = oSymTable->freeBindings;
+    oClone->numOfBindings = oSymTable->numOfBindings;
+
+    /*gives the clone its own keys and values, a binding left sharing them
+    after a failure is marked free so that freeing the clone skips it*/
+    for (i = 0; i < oClone->bindingsUsed; i++){
+        psBinding = &oClone->bindings[i];
+        if (psBinding->key == NULL) continue;
+        pcKey = SymTable_keepKey(oClone, psBinding->key);
+        pvBlock = NULL;
+        if (pcKey != NULL && oClone->valueSize != 0){
+            pvBlock = malloc(oClone->valueSize);
+            if (pvBlock == NULL)
+                SymTable_dropKey(oClone, pcKey);
+        }
+        if (pcKey == NULL || (oClone->valueSize != 0 && pvBlock == NULL)){
+            for (j = i; j < oClone->bindingsUsed; j++)
+                oClone->bindings[j].key = NULL;
+            SymTable_free(oClone);
+            return NULL;
+        }
+        psBinding->key = pcKey;
+        if (pvBlock != NULL){
+            memcpy(pvBlock, psBinding->value, oClone->valueSize);
+            psBinding->value = pvBlock;
+        }
+    }
+    return oClone;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates){
+    assert(ppcKeys != NULL && ppvValues != NULL && uThreadCount > 0);
+
+    /*the bindings share one array that a put may move, so it is built on the
+    calling thread*/
+    (void)uThreadCount;
+    return SymTable_buildSerial(ppcKeys, ppvValues, uCount, puDuplicates);
+}
+
+void SymTable_free(SymTable_T oSymTable){
+    size_t i;
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->bindingsUsed; i++){
+        if (oSymTable->bindings[i].key == NULL) continue;
+        SymTable_dropKey(oSymTable, oSymTable->bindings[i].key);
+        if (oSymTable->valueSize != 0)
+            free((void *)oSymTable->bindings[i].value);
+    }
+    free(oSymTable->bindings);
+    free(oSymTable->buckets);
+    free(oSymTable->scopes);
+    free(oSymTable->bindingScopes);
+    free(oSymTable->oldValue);
+    free(oSymTable);
+}
+
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue)){
+    size_t i;
+    assert(oSymTable != NULL);
+
+    /*keeps both arrays at their size, so that the next fill does not grow them*/
+    for (i = 0; i < oSymTable->bindingsUsed; i++){
+        if (oSymTable->bindings[i].key == NULL) continue;
+        if (pfFreeValue != NULL)
+            (*pfFreeValue)((void *)oSymTable->bindings[i].value);
+        SymTable_dropKey(oSymTable, oSymTable->bindings[i].key);
+        if (oSymTable->valueSize != 0)
+            free((void *)oSymTable->bindings[i].value);
+    }
+    memset(oSymTable->buckets, 0xff, oSymTable->numOfBuckets * sizeof(uint32_t));
+    oSymTable->bindingsUsed = 0;
+    oSymTable->freeBindings = NO_BINDING;
+    oSymTable->numOfBindings = 0;
+    oSymTable->numOfScopes = 0;
+    return 1;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+    return oSymTable->numOfBindings;
+}
+
+int SymTable_presize(SymTable_T oSymTable, size_t uCount){
+    size_t uBuckets;
+    assert(oSymTable != NULL);
+
+    uBuckets = oSymTable->numOfBuckets;
+    while (uBuckets < uCount && uBuckets <= NO_BINDING / 2)
+        uBuckets *= 2;
+    if (uBuckets != oSymTable->numOfBuckets &&
+        !SymTable_grow(oSymTable, uBuckets))
+        return 0;
+    return SymTable_reserve(oSymTable, uCount);
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    uint32_t found;
+    uint32_t prev;
+    uint32_t newBinding;
+    size_t uHash;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+    found = SymTable_locate(oSymTable, pcKey,
+        uHash & (oSymTable->numOfBuckets - 1), &prev);
+    if (found != NO_BINDING &&
+        SymTable_depth(oSymTable, found) == oSymTable->numOfScopes) return 0;
+
+    /*a table whose buckets cannot grow still works with longer chains*/
+    if (found == NO_BINDING &&
+        oSymTable->numOfBindings >= oSymTable->numOfBuckets &&
+        oSymTable->numOfBuckets <= NO_BINDING / 2)
+        SymTable_grow(oSymTable, 2 * oSymTable->numOfBuckets);
+
+    newBinding = SymTable_newBinding(oSymTable, pcKey, pvValue);
+    if (newBinding == NO_BINDING) return 0;
+    SymTable_insert(oSymTable, newBinding,
+        uHash & (oSymTable->numOfBuckets - 1), found, prev);
+    return 1;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    uint32_t found;
+    uint32_t prev;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    found = SymTable_locate(oSymTable, pcKey, SymTable_bucket(oSymTable, pcKey),
+        &prev);
+    if (found == NO_BINDING) return NULL;
+    return SymTable_setValue(oSymTable, found, pvValue);
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    uint32_t prev;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    return SymTable_locate(oSymTable, pcKey, SymTable_bucket(oSymTable, pcKey),
+        &prev) != NO_BINDING;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    uint32_t found;
+    uint32_t prev;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    found = SymTable_locate(oSymTable, pcKey, SymTable_bucket(oSymTable, pcKey),
+        &prev);
+    if (found == NO_BINDING) return NULL;
+    return (void *)oSymTable->bindings[found].value;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    uint32_t prev;
+    size_t uBucket;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    uBucket = SymTable_bucket(oSymTable, pcKey);
+    if (SymTable_locate(oSymTable, pcKey, uBucket, &prev) == NO_BINDING)
+        return NULL;
+    return SymTable_removeLink(oSymTable, SymTable_link(oSymTable, uBucket, prev));
+}
+
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey){
+    uint32_t found;
+    uint32_t prev;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    /*the handle is the index of the binding, which the array of bindings
+    keeps as it grows*/
+    found = SymTable_locate(oSymTable, pcKey, SymTable_bucket(oSymTable, pcKey),
+        &prev);
+    if (found == NO_BINDING) return NULL;
+    return SymTable_handleOf(found);
+}
+
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return (void *)oSymTable->bindings[SymTable_indexOf(oHandle)].value;
+}
+
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return SymTable_setValue(oSymTable, SymTable_indexOf(oHandle), pvValue);
+}
+
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle){
+    uint32_t uIndex;
+    uint32_t *puLink;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    /*walks the bucket of the binding again to the index that links to it*/
+    uIndex = SymTable_indexOf(oHandle);
+    puLink = &oSymTable->buckets[SymTable_bucket(oSymTable,
+        oSymTable->bindings[uIndex].key)];
+    while (*puLink != uIndex){
+        assert(*puLink != NO_BINDING);
+        puLink = &oSymTable->bindings[*puLink].next;
+    }
+    return SymTable_removeLink(oSymTable, puLink);
+}
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Binding *psBinding;
+        uint32_t current;
+        size_t i;
+        assert(oSymTable != NULL && pfApply != NULL);
+
+        /*hidden bindings are in no bucket, so the buckets are walked instead
+        of the array*/
+        for (i = 0; i < oSymTable->numOfBuckets; i++){
+            for (current = oSymTable->buckets[i]; current != NO_BINDING;
+                current = psBinding->next){
+                psBinding = &oSymTable->bindings[current];
+                (*pfApply)(psBinding->key, (void *)psBinding->value,
+                    (void *)pvExtra);
+            }
+        }
+}
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Binding *psBinding;
+        uint32_t current;
+        size_t uPrefixLength;
+        size_t i;
+        assert(oSymTable != NULL && pcPrefix != NULL && pfApply != NULL);
+
+        /*the keys are spread over the buckets, so every binding is checked*/
+        uPrefixLength = strlen(pcPrefix);
+        for (i = 0; i < oSymTable->numOfBuckets; i++){
+            for (current = oSymTable->buckets[i]; current != NO_BINDING;
+                current = psBinding->next){
+                psBinding = &oSymTable->bindings[current];
+                if (strncmp(psBinding->key, pcPrefix, uPrefixLength) == 0)
+                    (*pfApply)(psBinding->key, (void *)psBinding->value,
+                        (void *)pvExtra);
+            }
+        }
+}
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    struct Binding *psBinding;
+    uint32_t current;
+    uint32_t found;
+    uint32_t prev;
+    uint32_t newBinding;
+    size_t uBucket;
+    size_t i;
+
+    assert(oDest != NULL && oSource != NULL && oDest != oSource);
+    assert(oSource->numOfScopes == 0 && oSource->valueSize == oDest->valueSize &&
+        oSource->borrowedKeys == oDest->borrowedKeys);
+    assert(ePolicy != SYMTABLE_RESOLVE || pfResolve != NULL);
+
+    /*grows oDest once, straight to the size that both tables need*/
+    if (!SymTable_presize(oDest, oDest->bindingsUsed + oSource->numOfBindings))
+        return 0;
+
+    /*a binding leaves oSource only once oDest has taken it, with its key and
+    inline value*/
+    for (i = 0; i < oSource->numOfBuckets; i++){
+        while ((current = oSource->buckets[i]) != NO_BINDING){
+            psBinding = &oSource->bindings[current];
+            uBucket = SymTable_bucket(oDest, psBinding->key);
+            found = SymTable_locate(oDest, psBinding->key, uBucket, &prev);
+            if (found != NO_BINDING &&
+                SymTable_depth(oDest, found) == oDest->numOfScopes){
+                SymTable_resolve(oDest, oDest->bindings[found].key,
+                    &oDest->bindings[found].value, psBinding->value, ePolicy,
+                    pfResolve, pvExtra);
+                oSource->buckets[i] = psBinding->next;
+                oSource->numOfBindings--;
+                SymTable_freeBinding(oSource, current);
+                continue;
+            }
+            newBinding = SymTable_addBinding(oDest, psBinding->key,
+                psBinding->value);
+            if (newBinding == NO_BINDING) return 0;
+            SymTable_insert(oDest, newBinding, uBucket, found, prev);
+            oSource->buckets[i] = psBinding->next;
+            oSource->numOfBindings--;
+            psBinding->key = NULL;
+            psBinding->next = oSource->freeBindings;
+            oSource->freeBindings = current;
+        }
+    }
+    SymTable_free(oSource);
+    return 1;
+}
+
+int SymTable_pushScope(SymTable_T oSymTable){
+    uint32_t *newScopes;
+    size_t newCapacity;
+    assert(oSymTable != NULL);
+
+    /*a binding keeps its depth in 32 bits*/
+    if (oSymTable->numOfScopes == UINT32_MAX) return 0;
+    if (!SymTable_allocScopes(oSymTable)) return 0;
+    if (oSymTable->numOfScopes + 1 >= oSymTable->scopesCapacity){
+        newCapacity = 2 * oSymTable->scopesCapacity + 2;
+        newScopes = (uint32_t *)realloc(oSymTable->scopes,
+            sizeof(uint32_t) * newCapacity);
+        if (newScopes == NULL) return 0;
+        oSymTable->scopes = newScopes;
+        oSymTable->scopesCapacity = newCapacity;
+    }
+    oSymTable->numOfScopes++;
+    oSymTable->scopes[oSymTable->numOfScopes] = NO_BINDING;
+    return 1;
+}
+
+int SymTable_popScope(SymTable_T oSymTable){
+    uint32_t current;
+    uint32_t next;
+    uint32_t prev;
+    size_t uBucket;
+    const char *pcKey;
+    assert(oSymTable != NULL);
+
+    if (oSymTable->numOfScopes == 0) return 0;
+
+    /*bindings of the innermost scope are always visible, so each is in a bucket*/
+    current = oSymTable->scopes[oSymTable->numOfScopes];
+    while (current != NO_BINDING){
+        next = oSymTable->bindingScopes[current].scopeNext;
+        pcKey = oSymTable->bindings[current].key;
+        uBucket = SymTable_bucket(oSymTable, pcKey);
+        SymTable_locate(oSymTable, pcKey, uBucket, &prev);
+        SymTable_unlink(oSymTable, SymTable_link(oSymTable, uBucket, prev));
+        SymTable_freeBinding(oSymTable, current);
+        current = next;
+    }
+    oSymTable->numOfScopes--;
+    return 1;
+}
+
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth){
+    uint32_t found;
+    uint32_t prev;
+    assert(oSymTable != NULL && pcKey != NULL && puDepth != NULL);
+
+    found = SymTable_locate(oSymTable, pcKey, SymTable_bucket(oSymTable, pcKey),
+        &prev);
+    if (found == NO_BINDING) return NULL;
+    *puDepth = SymTable_depth(oSymTable, found);
+    return (void *)oSymTable->bindings[found].value;
+}
@@ -0,0 +1,966 @@
+/*--------------------------------------------------------------------*/
+/* symtablecuckoo.c                                                   */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtable.h"
+#include "symtablebuild.h"
+#include "symtablescope.h"
+
+/*number of slots in a bucket and number of bindings the stash can hold*/
+enum {SLOTS_PER_BUCKET = 4, STASH_SIZE = 8};
+
+/*size of a cache line, buckets are aligned to it*/
+static const size_t CACHE_LINE_SIZE = 64;
+
+/*number of buckets of a new table, a power of 2*/
+static const size_t INITIAL_BUCKET_COUNT = 128;
+
+/*a table grows when more than MAX_LOAD_NUMERATOR / MAX_LOAD_DENOMINATOR of its
+slots are full*/
+static const size_t MAX_LOAD_NUMERATOR = 9;
+static const size_t MAX_LOAD_DENOMINATOR = 10;
+
+/*number of bindings moved by one insertion before it uses the stash*/
+enum {MAX_KICKS = 256};
+
+/* Represents a binding in the symbol table*/
+struct Binding{
+    /*key of the binding that is a string, owned by the table unless it
+    borrows keys*/
+    const char *key;
+
+    /*value of the binding that is a void pointer, or in an inline table a
+    pointer to the value stored after the binding*/
+    const void *value;
+
+    /*hash code of the key*/
+    size_t hash;
+};
+
+/* Represents a bucket, a group of slots that fits in one cache line. The hash
+   codes are kept next to the bindings so that a lookup follows only the
+   binding whose hash code matches*/
+struct Bucket{
+    /*hash code of the key of the binding in each full slot*/
+    size_t hashes[SLOTS_PER_BUCKET];
+
+    /*binding in each slot, NULL if the slot is empty*/
+    struct Binding *bindings[SLOTS_PER_BUCKET];
+};
+
+/* Represents the symbol table. Every visible binding is in a slot of one of
+   the two buckets its hash code selects, or in the stash*/
+struct SymTable{
+    /*number of bindings in the table*/
+    size_t numOfBindings;
+
+    /*number of buckets, a power of 2*/
+    size_t numOfBuckets;
+
+    /*buckets of the table, aligned to a cache line*/
+    struct Bucket *buckets;
+
+    /*memory block that holds buckets*/
+    void *bucketsBlock;
+
+    /*bindings that found no slot, checked by lookups only when not empty*/
+    struct Binding *stash[STASH_SIZE];
+
+    /*number of bindings in stash*/
+    size_t stashLength;
+
+    /*state of the generator that picks the slots that insertions evict*/
+    size_t randomState;
+
+    /*open scopes, which know the depth of each binding put in an inner scope
+    and the binding it hides, which is in no slot while it is hidden. NULL until
+    the first pushScope, so that bindings carry nothing for scopes*/
+    SymTableScopes_T scopes;
+
+    /*size of the values stored in the bindings, 0 if values are void pointers*/
+    size_t valueSize;
+
+    /*copy of the last value replaced or removed from an inline table*/
+    void *oldValue;
+
+    /*1 if the bindings point to the callers' keys instead of copies*/
+    int borrowedKeys;
+};
+
+/* Return a hash code for pcKey that uses all the bits of a size_t. */
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = (size_t)1099511628211UL;
+   const size_t MIX_MULTIPLIER = (size_t)0xff51afd7ed558ccdUL;
+   size_t u;
+   size_t uHash = (size_t)14695981039346656037UL;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+      uHash = (uHash ^ (size_t)(unsigned char)pcKey[u]) * HASH_MULTIPLIER;
+
+   uHash ^= uHash >> 33;
+   uHash *= MIX_MULTIPLIER;
+   uHash ^= uHash >> 33;
+   return uHash;
+}
+
+/*Returns the first bucket of hash code uHash in a table of uMask + 1 buckets*/
+static size_t SymTable_first(size_t uHash, size_t uMask){
+    return uHash & uMask;
+}
+
+/*Returns the second bucket of hash code uHash in a table of uMask + 1 buckets,
+taken from the other half of the hash code*/
+static size_t SymTable_second(size_t uHash, size_t uMask){
+    return (uHash >> (sizeof(size_t) * 4)) & uMask;
+}
+
+/*Returns the bucket other than uBucket that hash code uHash selects in a table
+of uMask + 1 buckets*/
+static size_t SymTable_other(size_t uHash, size_t uBucket, size_t uMask){
+    if (uBucket == SymTable_first(uHash, uMask))
+        return SymTable_second(uHash, uMask);
+    return SymTable_first(uHash, uMask);
+}
+
+/*Returns a pseudo-random number from the generator of oSymTable*/
+static size_t SymTable_random(SymTable_T oSymTable){
+    oSymTable->randomState = oSymTable->randomState * 1103515245 + 12345;
+    return oSymTable->randomState >> 16;
+}
+
+/*Copies the uValueSize bytes at pvValue, or zeros if pvValue is NULL, into
+the inline value pvDest*/
+static void SymTable_storeValue(size_t uValueSize, void *pvDest,
+    const void *pvValue){
+    if (pvValue != NULL)
+        memcpy(pvDest, pvValue, uValueSize);
+    else
+        memset(pvDest, 0, uValueSize);
+}
+
+/*Returns the key to store for pcKey in oSymTable, which is pcKey itself if
+oSymTable borrows keys and a copy of it otherwise. Returns NULL if insufficient
+memory*/
+static const char *SymTable_keepKey(SymTable_T oSymTable, const char *pcKey){
+    char *pcCopy;
+
+    if (oSymTable->borrowedKeys) return pcKey;
+    pcCopy = (char *)malloc(strlen(pcKey) + 1);
+    if (pcCopy == NULL) return NULL;
+    return strcpy(pcCopy, pcKey);
+}
+
+/*Frees the key pcKey of a binding of oSymTable unless oSymTable borrows keys*/
+static void SymTable_dropKey(SymTable_T oSymTable, const char *pcKey){
+    if (!oSymTable->borrowedKeys)
+        free((void *)pcKey);
+}
+
+/*Creates a binding of oSymTable with pcKey, its hash code uHash and pvValue.
+Returns NULL if insufficient memory*/
+static struct Binding *SymTable_newBinding(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash, const void *pvValue){
+    struct Binding *newBinding;
+
+    newBinding = (struct Binding *)malloc(sizeof(struct Binding)
+        + oSymTable->valueSize);
+    if (newBinding == NULL) return NULL;
+    newBinding->key = SymTable_keepKey(oSymTable, pcKey);
+    if (newBinding->key == NULL){
+        free(newBinding);
+        return NULL;
+    }
+    newBinding->value = pvValue;
+    if (oSymTable->valueSize != 0){
+        newBinding->value = newBinding + 1;
+        SymTable_storeValue(oSymTable->valueSize, newBinding + 1, pvValue);
+    }
+    newBinding->hash = uHash;
+    return newBinding;
+}
+
+/*Returns the value pvValue of a binding of oSymTable that is being replaced or
+removed, saving a copy of it first if oSymTable is inline*/
+static void *SymTable_oldValue(SymTable_T oSymTable, const void *pvValue){
+    if (oSymTable->valueSize == 0) return (void *)pvValue;
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/*Frees psBinding of oSymTable and every binding it shadows, taking them out of
+their scopes*/
+static void SymTable_freeStack(SymTable_T oSymTable, struct Binding *psBinding){
+    struct Binding *shadowed;
+
+    while (psBinding != NULL){
+        shadowed = (struct Binding *)SymTableScopes_remove(oSymTable->scopes,
+            psBinding);
+        SymTable_dropKey(oSymTable, psBinding->key);
+        free(psBinding);
+        psBinding = shadowed;
+    }
+}
+
+/*Calls pfFreeValue on the value of psBinding of oSymTable and of every binding
+it shadows*/
+static void SymTable_freeValues(SymTable_T oSymTable, struct Binding *psBinding,
+    void (*pfFreeValue)(void *pvValue)){
+    for (; psBinding != NULL; psBinding = (struct Binding *)
+        SymTableScopes_shadowed(oSymTable->scopes, psBinding))
+        (*pfFreeValue)((void *)psBinding->value);
+}
+
+/*Returns a copy for oClone of psBinding of oSymTable, putting the copy and a
+copy of every binding psBinding shadows in the same scopes of oClone, which are
+open. Returns NULL if insufficient memory*/
+static struct Binding *SymTable_copyStack(SymTable_T oClone,
+    SymTable_T oSymTable, const struct Binding *psBinding){
+    struct Binding *shadowed = NULL;
+    struct Binding *newBinding;
+    const struct Binding *psShadowed;
+    size_t uDepth;
+
+    /*the bindings it shadows are copied first, so the copy can hide theirs*/
+    psShadowed = (const struct Binding *)SymTableScopes_shadowed(
+        oSymTable->scopes, psBinding);
+    if (psShadowed != NULL){
+        shadowed = SymTable_copyStack(oClone, oSymTable, psShadowed);
+        if (shadowed == NULL) return NULL;
+    }
+
+    uDepth = SymTableScopes_depthOf(oSymTable->scopes, psBinding);
+    if (uDepth > 0 && !SymTableScopes_reserve(oClone->scopes, 1)){
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    newBinding = SymTable_newBinding(oClone, psBinding->key, psBinding->hash,
+        psBinding->value);
+    if (newBinding == NULL){
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    if (uDepth > 0)
+        SymTableScopes_add(oClone->scopes, newBinding, uDepth, shadowed);
+    return newBinding;
+}
+
+/*Sets oSymTable to use a new array of uCount empty buckets, without freeing
+the old one. Returns 1 if successful, 0 if insufficient memory*/
+static int SymTable_allocBuckets(SymTable_T oSymTable, size_t uCount){
+    char *pcBlock;
+    size_t uSkip;
+
+    pcBlock = (char *)calloc(1, sizeof(struct Bucket) * uCount + CACHE_LINE_SIZE);
+    if (pcBlock == NULL) return 0;
+    uSkip = (CACHE_LINE_SIZE - (size_t)pcBlock % CACHE_LINE_SIZE) % CACHE_LINE_SIZE;
+    oSymTable->bucketsBlock = pcBlock;
+    oSymTable->buckets = (struct Bucket *)(pcBlock + uSkip);
+    oSymTable->numOfBuckets = uCount;
+    return 1;
+}
+
+/*Returns the address of the slot or stash entry of oSymTable that holds the
+visible binding with pcKey and hash code uHash, or NULL if there is none*/
+static struct Binding **SymTable_locate(SymTable_T oSymTable, const char *pcKey,
+    size_t uHash){
+    struct Bucket *psBucket;
+    size_t uMask = oSymTable->numOfBuckets - 1;
+    size_t i;
+
+    psBucket = &oSymTable->buckets[SymTable_first(uHash, uMask)];
+    for (i = 0; i < SLOTS_PER_BUCKET; i++)
+        if (psBucket->bindings[i] != NULL && psBucket->hashes[i] == uHash &&
+            strcmp(psBucket->bindings[i]->key, pcKey) == 0)
+            return &psBucket->bindings[i];
+
+    psBucket = &oSymTable->buckets[SymTable_second(uHash, uMask)];
+    for (i = 0; i < SLOTS_PER_BUCKET; i++)
+        if (psBucket->bindings[i] != NULL && psBucket->hashes[i] == uHash &&
+            strcmp(psBucket->bindings[i]->key, pcKey) == 0)
+            return &psBucket->bindings[i];
+
+    for (i = 0; i < oSymTable->stashLength; i++)
+        if (oSymTable->stash[i]->hash == uHash &&
+            strcmp(oSymTable->stash[i]->key, pcKey) == 0)
+            return &oSymTable->stash[i];
+    return NULL;
+}
+
+/*Returns the address of the slot or stash entry of oSymTable that holds the
+visible binding psBinding*/
+static struct Binding **SymTable_slotOf(SymTable_T oSymTable,
+    struct Binding *psBinding){
+    struct Bucket *psBucket;
+    size_t uMask = oSymTable->numOfBuckets - 1;
+    size_t i;
+
+    psBucket = &oSymTable->buckets[SymTable_first(psBinding->hash, uMask)];
+    for (i = 0; i < SLOTS_PER_BUCKET; i++)
+        if (psBucket->bindings[i] == psBinding)
+            return &psBucket->bindings[i];
+
+    psBucket = &oSymTable->buckets[SymTable_second(psBinding->hash, uMask)];
+    for (i = 0; i < SLOTS_PER_BUCKET; i++)
+        if (psBucket->bindings[i] == psBinding)
+            return &psBucket->bindings[i];
+
+    /*a binding in neither of its buckets is in the stash*/
+    for (i = 0; oSymTable->stash[i] != psBinding; i++)
+        assert(i + 1 < oSymTable->stashLength);
+    return &oSymTable->stash[i];
+}
+
+/*Puts psBinding in an empty slot of bucket uBucket of oSymTable. Returns 1 if
+successful, 0 if the bucket is full*/
+static int SymTable_fill(SymTable_T oSymTable, size_t uBucket,
+    struct Binding *psBinding){
+    struct Bucket *psBucket = &oSymTable->buckets[uBucket];
+    size_t i;
+
+    for (i = 0; i < SLOTS_PER_BUCKET; i++){
+        if (psBucket->bindings[i] == NULL){
+            psBucket->bindings[i] = psBinding;
+            psBucket->hashes[i] = psBinding->hash;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*Places psBinding, whose key is not in oSymTable, in a slot of one of its
+buckets, moving at most MAX_KICKS other bindings to their other bucket to make
+room, and puts the binding left without a slot in the stash. Returns 1 if
+successful. Returns 0 and leaves oSymTable unchanged if the stash is full*/
+static int SymTable_place(SymTable_T oSymTable, struct Binding *psBinding){
+    size_t auBuckets[MAX_KICKS];
+    size_t auSlots[MAX_KICKS];
+    struct Bucket *psBucket;
+    struct Binding *psEvicted;
+    size_t uMask = oSymTable->numOfBuckets - 1;
+    size_t uBucket;
+    size_t uSlot;
+    size_t k;
+
+    if (SymTable_fill(oSymTable, SymTable_first(psBinding->hash, uMask), psBinding) ||
+        SymTable_fill(oSymTable, SymTable_second(psBinding->hash, uMask), psBinding))
+        return 1;
+
+    /*evicts a random binding of a full bucket, which then tries its other bucket*/
+    uBucket = SymTable_first(psBinding->hash, uMask);
+    for (k = 0; k < MAX_KICKS; k++){
+        uSlot = SymTable_random(oSymTable) % SLOTS_PER_BUCKET;
+        psBucket = &oSymTable->buckets[uBucket];
+        auBuckets[k] = uBucket;
+        auSlots[k] = uSlot;
+        psEvicted = psBucket->bindings[uSlot];
+        psBucket->bindings[uSlot] = psBinding;
+        psBucket->hashes[uSlot] = psBinding->hash;
+        psBinding = psEvicted;
+
+        uBucket = SymTable_other(psBinding->hash, uBucket, uMask);
+        if (SymTable_fill(oSymTable, uBucket, psBinding))
+            return 1;
+    }
+
+    if (oSymTable->stashLength < STASH_SIZE){
+        oSymTable->stash[oSymTable->stashLength++] = psBinding;
+        return 1;
+    }
+
+    /*puts every evicted binding back, newest eviction first*/
+    while (k > 0){
+        k--;
+        psBucket = &oSymTable->buckets[auBuckets[k]];
+        psEvicted = psBucket->bindings[auSlots[k]];
+        psBucket->bindings[auSlots[k]] = psBinding;
+        psBucket->hashes[auSlots[k]] = psBinding->hash;
+        psBinding = psEvicted;
+    }
+    return 0;
+}
+
+/*Moves every visible binding of oSymTable into a new array of uCount buckets,
+a power of 2, or more if the bindings do not fit. Returns 1 if successful, 0 if
+insufficient memory, leaving oSymTable unchanged*/
+static int SymTable_grow(SymTable_T oSymTable, size_t uCount){
+    struct Bucket *psOldBuckets = oSymTable->buckets;
+    void *pvOldBlock = oSymTable->bucketsBlock;
+    size_t uOldCount = oSymTable->numOfBuckets;
+    struct Binding *apsOldStash[STASH_SIZE];
+    size_t uOldStashLength = oSymTable->stashLength;
+    size_t i;
+    size_t j;
+    int iPlaced = 0;
+
+    for (i = 0; i < uOldStashLength; i++)
+        apsOldStash[i] = oSymTable->stash[i];
+
+    while (!iPlaced){
+        if (!SymTable_allocBuckets(oSymTable, uCount)){
+            oSymTable->buckets = psOldBuckets;
+            oSymTable->bucketsBlock = pvOldBlock;
+            oSymTable->numOfBuckets = uOldCount;
+            for (i = 0; i < uOldStashLength; i++)
+                oSymTable->stash[i] = apsOldStash[i];
+            oSymTable->stashLength = uOldStashLength;
+            return 0;
+        }
+        oSymTable->stashLength = 0;
+        iPlaced = 1;
+        for (i = 0; i < uOldCount && iPlaced; i++)
+            for (j = 0; j < SLOTS_PER_BUCKET && iPlaced; j++)
+                if (psOldBuckets[i].bindings[j] != NULL)
+                    iPlaced = SymTable_place(oSymTable, psOldBuckets[i].bindings[j]);
+        for (i = 0; i < uOldStashLength && iPlaced; i++)
+            iPlaced = SymTable_place(oSymTable, apsOldStash[i]);
+
+        /*the bindings still have their old slots, so a failed try is dropped*/
+        if (!iPlaced){
+            free(oSymTable->bucketsBlock);
+            uCount *= 2;
+        }
+    }
+    free(pvOldBlock);
+    return 1;
+}
+
+/*Takes the visible binding *ppsSlot out of its slot and its scope of
+oSymTable, putting the binding it shadows back in its place*/
+static void SymTable_unlink(SymTable_T oSymTable, struct Binding **ppsSlot){
+    struct Binding *shadowed;
+
+    shadowed = (struct Binding *)SymTableScopes_remove(oSymTable->scopes,
+        *ppsSlot);
+    if (shadowed != NULL){
+        *ppsSlot = shadowed;
+        return;
+    }
+    oSymTable->numOfBindings--;
+    if (ppsSlot >= oSymTable->stash && ppsSlot < oSymTable->stash + STASH_SIZE)
+        *ppsSlot = oSymTable->stash[--oSymTable->stashLength];
+    else
+        *ppsSlot = NULL;
+}
+
+/*Removes the visible binding *ppsSlot from oSymTable and returns its value*/
+static void *SymTable_removeSlot(SymTable_T oSymTable, struct Binding **ppsSlot){
+    struct Binding *current = *ppsSlot;
+    const void *temp;
+
+    SymTable_unlink(oSymTable, ppsSlot);
+    temp = SymTable_oldValue(oSymTable, current->value);
+    SymTable_dropKey(oSymTable, current->key);
+    free(current);
+    return (void *)temp;
+}
+
+/*Sets the value of psBinding of oSymTable to pvValue and returns the old one*/
+static void *SymTable_setValue(SymTable_T oSymTable, struct Binding *psBinding,
+    const void *pvValue){
+    const void *temp;
+
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, psBinding->value);
+        SymTable_storeValue(oSymTable->valueSize, (void *)psBinding->value, pvValue);
+        return (void *)temp;
+    }
+    temp = psBinding->value;
+    psBinding->value = pvValue;
+    return (void *)temp;
+}
+
+/*Sets the value *ppvValue of the binding of oSymTable with pcKey, which a merge
+also brings the value pvIncoming for, as ePolicy says*/
+static void SymTable_resolve(SymTable_T oSymTable, const char *pcKey,
+    const void **ppvValue, const void *pvIncoming,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    const void *pvValue = pvIncoming;
+
+    if (ePolicy == SYMTABLE_KEEP_EXISTING) return;
+    if (ePolicy == SYMTABLE_RESOLVE)
+        pvValue = (*pfResolve)(pcKey, (void *)*ppvValue, (void *)pvIncoming,
+            (void *)pvExtra);
+    if (oSymTable->valueSize == 0)
+        *ppvValue = pvValue;
+    else if (pvValue != *ppvValue)
+        SymTable_storeValue(oSymTable->valueSize, (void *)*ppvValue, pvValue);
+}
+
+/*Moves psBinding, a binding of a table being merged into oDest, into the
+innermost scope of oDest, or frees it after resolving its value as ePolicy says
+if its key is already there. Room for psBinding must have been reserved in the
+scopes of oDest unless its innermost scope is the outermost. Returns 1 if
+successful, 0 if insufficient memory, leaving psBinding alone*/
+static int SymTable_mergeBinding(SymTable_T oDest, struct Binding *psBinding,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    struct Binding **ppsSlot;
+    struct Binding *shadowed = NULL;
+    size_t uDepth = SymTableScopes_getDepth(oDest->scopes);
+
+    ppsSlot = SymTable_locate(oDest, psBinding->key, psBinding->hash);
+    if (ppsSlot != NULL && (uDepth == 0 ||
+        SymTableScopes_depthOf(oDest->scopes, *ppsSlot) == uDepth)){
+        SymTable_resolve(oDest, (*ppsSlot)->key, &(*ppsSlot)->value,
+            psBinding->value, ePolicy, pfResolve, pvExtra);
+        SymTable_dropKey(oDest, psBinding->key);
+        free(psBinding);
+        return 1;
+    }
+
+    /*the hash code moves with the binding, so its key is not hashed again*/
+    if (ppsSlot != NULL){
+        shadowed = *ppsSlot;
+        *ppsSlot = psBinding;
+    }
+    else{
+        while (!SymTable_place(oDest, psBinding))
+            if (!SymTable_grow(oDest, 2 * oDest->numOfBuckets))
+                return 0;
+        oDest->numOfBindings++;
+    }
+    if (uDepth > 0)
+        SymTableScopes_add(oDest->scopes, psBinding, uDepth, shadowed);
+    return 1;
+}
+
+SymTable_T SymTable_new(void){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL) return NULL;
+    if (!SymTable_allocBuckets(oSymTable, INITIAL_BUCKET_COUNT)){
+        free(oSymTable);
+        return NULL;
+    }
+    oSymTable->numOfBindings = 0;
+    oSymTable->stashLength = 0;
+    oSymTable->randomState = 1;
+    oSymTable->scopes = NULL;
+    oSymTable->valueSize = 0;
+    oSymTable->oldValue = NULL;
+    oSymTable->borrowedKeys = 0;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize){
+    SymTable_T oSymTable;
+    assert(uValueSize > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->oldValue = malloc(uValueSize);
+    if (oSymTable->oldValue == NULL){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    oSymTable->valueSize = uValueSize;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newBorrowedKeys(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->borrowedKeys = 1;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newKeyHeap(void){
+    /*keys stay allocated one by one, the slots hold only bindings*/
+    return SymTable_new();
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable){
+    SymTable_T oClone;
+    struct Bucket *psBucket;
+    struct Binding *copy;
+    size_t uDepth;
+    size_t i;
+    size_t j;
+
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize != 0)
+        oClone = SymTable_newInline(oSymTable->valueSize);
+    else
+        oClone = SymTable_new();
+    if (oClone == NULL) return NULL;
+    oClone->borrowedKeys = oSymTable->borrowedKeys;
+
+    /*gives the clone the same bucket count so that every binding keeps its slot*/
+    free(oClone->bucketsBlock);
+    if (!SymTable_allocBuckets(oClone, oSymTable->numOfBuckets)){
+        free(oClone->oldValue);
+        free(oClone);
+        return NULL;
+    }
+
+    /*gives the clone the same open scopes*/
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (uDepth != 0){
+        oClone->scopes = SymTableScopes_new();
+        if (oClone->scopes == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        for (i = 0; i < uDepth; i++){
+            if (!SymTableScopes_push(oClone->scopes)){
+                SymTable_free(oClone);
+                return NULL;
+            }
+        }
+    }
+
+    for (i = 0; i < oSymTable->numOfBuckets; i++){
+        psBucket = &oSymTable->buckets[i];
+        for (j = 0; j < SLOTS_PER_BUCKET; j++){
+            if (psBucket->bindings[j] == NULL) continue;
+            copy = SymTable_copyStack(oClone, oSymTable,
+                psBucket->bindings[j]);
+            if (copy == NULL){
+                SymTable_free(oClone);
+                return NULL;
+            }
+            oClone->buckets[i].bindings[j] = copy;
+            oClone->buckets[i].hashes[j] = copy->hash;
+            oClone->numOfBindings++;
+        }
+    }
+    for (i = 0; i < oSymTable->stashLength; i++){
+        copy = SymTable_copyStack(oClone, oSymTable, oSymTable->stash[i]);
+        if (copy == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        oClone->stash[oClone->stashLength++] = copy;
+        oClone->numOfBindings++;
+    }
+    return oClone;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates){
+    assert(ppcKeys != NULL && ppvValues != NULL && uThreadCount > 0);
+
+    /*a put can move bindings between any two buckets, so it is built on the
+    calling thread*/
+    (void)uThreadCount;
+    return SymTable_buildSerial(ppcKeys, ppvValues, uCount, puDuplicates);
+}
+
+void SymTable_free(SymTable_T oSymTable){
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->numOfBuckets; i++)
+        for (j = 0; j < SLOTS_PER_BUCKET; j++)
+            SymTable_freeStack(oSymTable, oSymTable->buckets[i].bindings[j]);
+    for (i = 0; i < oSymTable->stashLength; i++)
+        SymTable_freeStack(oSymTable, oSymTable->stash[i]);
+    free(oSymTable->bucketsBlock);
+    SymTableScopes_free(oSymTable->scopes);
+    free(oSymTable->oldValue);
+    free(oSymTable);
+}
+
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue)){
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+
+    /*keeps the buckets at their size, so that the next fill does not grow them*/
+    for (i = 0; i < oSymTable->numOfBuckets; i++){
+        for (j = 0; j < SLOTS_PER_BUCKET; j++){
+            if (pfFreeValue != NULL)
+                SymTable_freeValues(oSymTable, oSymTable->buckets[i].bindings[j],
+                    pfFreeValue);
+            SymTable_freeStack(oSymTable, oSymTable->buckets[i].bindings[j]);
+            oSymTable->buckets[i].bindings[j] = NULL;
+        }
+    }
+    for (i = 0; i < oSymTable->stashLength; i++){
+        if (pfFreeValue != NULL)
+            SymTable_freeValues(oSymTable, oSymTable->stash[i], pfFreeValue);
+        SymTable_freeStack(oSymTable, oSymTable->stash[i]);
+    }
+    oSymTable->stashLength = 0;
+    oSymTable->numOfBindings = 0;
+    SymTableScopes_clear(oSymTable->scopes);
+    return 1;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+    return oSymTable->numOfBindings;
+}
+
+int SymTable_presize(SymTable_T oSymTable, size_t uCount){
+    size_t uBuckets;
+    assert(oSymTable != NULL);
+
+    /*the same load limit as a put, so the puts up to uCount do not grow*/
+    uBuckets = oSymTable->numOfBuckets;
+    while (uCount * MAX_LOAD_DENOMINATOR >
+        uBuckets * SLOTS_PER_BUCKET * MAX_LOAD_NUMERATOR)
+        uBuckets *= 2;
+    if (uBuckets == oSymTable->numOfBuckets) return 1;
+    return SymTable_grow(oSymTable, uBuckets);
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    struct Binding *newBinding;
+    struct Binding **ppsSlot;
+    struct Binding *shadowed = NULL;
+    size_t uHash;
+    size_t uDepth;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+    ppsSlot = SymTable_locate(oSymTable, pcKey, uHash);
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (ppsSlot != NULL && (uDepth == 0 ||
+        SymTableScopes_depthOf(oSymTable->scopes, *ppsSlot) == uDepth))
+        return 0;
+    if (uDepth > 0 && !SymTableScopes_reserve(oSymTable->scopes, 1)) return 0;
+
+    /*grows before the load gets high enough to make insertions slow*/
+    if (ppsSlot == NULL && (oSymTable->numOfBindings + 1) * MAX_LOAD_DENOMINATOR >
+        oSymTable->numOfBuckets * SLOTS_PER_BUCKET * MAX_LOAD_NUMERATOR &&
+        !SymTable_grow(oSymTable, 2 * oSymTable->numOfBuckets))
+        return 0;
+
+    newBinding = SymTable_newBinding(oSymTable, pcKey, uHash, pvValue);
+    if (newBinding == NULL) return 0;
+
+    /*a binding that shadows another takes its slot*/
+    if (ppsSlot != NULL){
+        shadowed = *ppsSlot;
+        *ppsSlot = newBinding;
+    }
+    else{
+        while (!SymTable_place(oSymTable, newBinding)){
+            if (!SymTable_grow(oSymTable, 2 * oSymTable->numOfBuckets)){
+                SymTable_freeStack(oSymTable, newBinding);
+                return 0;
+            }
+        }
+        oSymTable->numOfBindings++;
+    }
+
+    if (uDepth > 0)
+        SymTableScopes_add(oSymTable->scopes, newBinding, uDepth, shadowed);
+    return 1;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    struct Binding **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey, SymTable_hash(pcKey));
+    if (ppsSlot == NULL) return NULL;
+    return SymTable_setValue(oSymTable, *ppsSlot, pvValue);
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(oSymTable != NULL && pcKey != NULL);
+    return SymTable_locate(oSymTable, pcKey, SymTable_hash(pcKey)) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    struct Binding **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey, SymTable_hash(pcKey));
+    if (ppsSlot == NULL) return NULL;
+    return (void *)(*ppsSlot)->value;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    struct Binding **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey, SymTable_hash(pcKey));
+    if (ppsSlot == NULL) return NULL;
+    return SymTable_removeSlot(oSymTable, ppsSlot);
+}
+
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey){
+    struct Binding **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    /*the handle is the binding itself, which keeps its place in memory as it
+    moves between slots*/
+    ppsSlot = SymTable_locate(oSymTable, pcKey, SymTable_hash(pcKey));
+    if (ppsSlot == NULL) return NULL;
+    return (SymTable_Handle)*ppsSlot;
+}
+
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return (void *)((struct Binding *)oHandle)->value;
+}
+
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return SymTable_setValue(oSymTable, (struct Binding *)oHandle, pvValue);
+}
+
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return SymTable_removeSlot(oSymTable,
+        SymTable_slotOf(oSymTable, (struct Binding *)oHandle));
+}
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Binding *current;
+        size_t i;
+        size_t j;
+        assert(oSymTable != NULL && pfApply != NULL);
+
+        for (i = 0; i < oSymTable->numOfBuckets; i++){
+            for (j = 0; j < SLOTS_PER_BUCKET; j++){
+                current = oSymTable->buckets[i].bindings[j];
+                if (current != NULL)
+                    (*pfApply)(current->key, (void *)current->value, (void *)pvExtra);
+            }
+        }
+        for (i = 0; i < oSymTable->stashLength; i++){
+            current = oSymTable->stash[i];
+            (*pfApply)(current->key, (void *)current->value, (void *)pvExtra);
+        }
+}
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Binding *current;
+        size_t uPrefixLength;
+        size_t i;
+        size_t j;
+        assert(oSymTable != NULL && pcPrefix != NULL && pfApply != NULL);
+
+        /*the keys are spread over the buckets, so every binding is checked*/
+        uPrefixLength = strlen(pcPrefix);
+        for (i = 0; i < oSymTable->numOfBuckets; i++){
+            for (j = 0; j < SLOTS_PER_BUCKET; j++){
+                current = oSymTable->buckets[i].bindings[j];
+                if (current != NULL &&
+                    strncmp(current->key, pcPrefix, uPrefixLength) == 0)
+                    (*pfApply)(current->key, (void *)current->value, (void *)pvExtra);
+            }
+        }
+        for (i = 0; i < oSymTable->stashLength; i++){
+            current = oSymTable->stash[i];
+            if (strncmp(current->key, pcPrefix, uPrefixLength) == 0)
+                (*pfApply)(current->key, (void *)current->value, (void *)pvExtra);
+        }
+}
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    struct Binding **ppsSlot;
+    size_t uCount;
+    size_t i;
+    size_t j;
+
+    assert(oDest != NULL && oSource != NULL && oDest != oSource);
+    assert(SymTableScopes_getDepth(oSource->scopes) == 0 &&
+        oSource->valueSize == oDest->valueSize &&
+        oSource->borrowedKeys == oDest->borrowedKeys);
+    assert(ePolicy != SYMTABLE_RESOLVE || pfResolve != NULL);
+
+    /*makes room in an inner scope of oDest for every binding before any moves*/
+    if (SymTableScopes_getDepth(oDest->scopes) > 0 &&
+        !SymTableScopes_reserve(oDest->scopes, oSource->numOfBindings))
+        return 0;
+
+    /*grows oDest once, straight to the bucket count that both tables need*/
+    uCount = oDest->numOfBuckets;
+    while ((oDest->numOfBindings + oSource->numOfBindings) * MAX_LOAD_DENOMINATOR >
+        uCount * SLOTS_PER_BUCKET * MAX_LOAD_NUMERATOR)
+        uCount *= 2;
+    if (uCount != oDest->numOfBuckets && !SymTable_grow(oDest, uCount))
+        return 0;
+
+    /*a binding leaves oSource only once oDest has taken it*/
+    for (i = 0; i < oSource->numOfBuckets; i++){
+        for (j = 0; j < SLOTS_PER_BUCKET; j++){
+            ppsSlot = &oSource->buckets[i].bindings[j];
+            if (*ppsSlot == NULL) continue;
+            if (!SymTable_mergeBinding(oDest, *ppsSlot, ePolicy, pfResolve, pvExtra))
+                return 0;
+            *ppsSlot = NULL;
+            oSource->numOfBindings--;
+        }
+    }
+    while (oSource->stashLength > 0){
+        if (!SymTable_mergeBinding(oDest, oSource->stash[oSource->stashLength - 1],
+            ePolicy, pfResolve, pvExtra))
+            return 0;
+        oSource->stashLength--;
+        oSource->numOfBindings--;
+    }
+    SymTable_free(oSource);
+    return 1;
+}
+
+int SymTable_pushScope(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    if (oSymTable->scopes == NULL){
+        oSymTable->scopes = SymTableScopes_new();
+        if (oSymTable->scopes == NULL) return 0;
+    }
+    return SymTableScopes_push(oSymTable->scopes);
+}
+
+int SymTable_popScope(SymTable_T oSymTable){
+    struct Binding *current;
+    assert(oSymTable != NULL);
+
+    if (SymTableScopes_getDepth(oSymTable->scopes) == 0) return 0;
+
+    /*bindings of the innermost scope are always visible, so each is in a slot*/
+    while ((current = (struct Binding *)SymTableScopes_last(oSymTable->scopes))
+        != NULL){
+        SymTable_unlink(oSymTable, SymTable_locate(oSymTable, current->key,
+            current->hash));
+        SymTable_dropKey(oSymTable, current->key);
+        free(current);
+    }
+    SymTableScopes_pop(oSymTable->scopes);
+    return 1;
+}
+
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth){
+    struct Binding **ppsSlot;
+    assert(oSymTable != NULL && pcKey != NULL && puDepth != NULL);
+
+    ppsSlot = SymTable_locate(oSymTable, pcKey, SymTable_hash(pcKey));
+    if (ppsSlot == NULL) return NULL;
+    *puDepth = SymTableScopes_depthOf(oSymTable->scopes, *ppsSlot);
+    return (void *)(*ppsSlot)->value;
+}
@@ -0,0 +1,522 @@
+/*--------------------------------------------------------------------*/
+/* symtabledurable.c                                                  */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+/*records are synced with fsync where the system has it, elsewhere they are
+only flushed to the operating system*/
+#if defined(__unix__)
+#define _POSIX_C_SOURCE 200809L
+#define SYMTABLE_FSYNC
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtabledurable.h"
+
+#ifdef SYMTABLE_FSYNC
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+/*bytes at the start of every log, followed by the value size in 4 bytes*/
+static const char acMagic[] = "SYMTWAL1";
+enum {MAGIC_LENGTH = 8};
+
+/*record types: a binding of a key to a value, or the removal of a key*/
+enum {RECORD_SET = 'S', RECORD_REMOVE = 'R'};
+
+/*number of records written between two syncs of the log*/
+static const size_t GROUP_COMMIT_SIZE = 64;
+
+/*the log is compacted once it holds more than COMPACT_FACTOR records per
+binding and more than COMPACT_MINIMUM records*/
+static const size_t COMPACT_FACTOR = 4;
+static const size_t COMPACT_MINIMUM = 1024;
+
+/*suffix of the file a compacted log is written to before it replaces the log*/
+static const char acCompactSuffix[] = ".compact";
+
+/* Represents a durable symbol table*/
+struct SymTableDurable{
+    /*table holding the bindings*/
+    SymTable_T table;
+
+    /*size of every value*/
+    size_t valueSize;
+
+    /*path of the log, and of the file it is compacted into*/
+    char *path;
+    char *compactPath;
+
+    /*log opened for appending, or NULL once it could not be reopened*/
+    FILE *log;
+
+    /*number of records in the log*/
+    size_t numOfRecords;
+
+    /*number of records written since the log was last synced*/
+    size_t numOfPending;
+
+    /*valueSize zero bytes, logged for a NULL value*/
+    void *zeros;
+};
+
+/* State passed to the SymTable_map callback while compacting*/
+struct Snapshot{
+    /*file the records are written to*/
+    FILE *file;
+
+    /*size of every value*/
+    size_t valueSize;
+
+    /*1 once a record could not be written*/
+    int failed;
+};
+
+/*Stores ulValue, which must be less than 2^32, in the 4 bytes at pucBytes,
+least significant first*/
+static void SymTable_encode(unsigned char *pucBytes, unsigned long ulValue){
+    size_t i;
+    for (i = 0; i < 4; i++)
+        pucBytes[i] = (unsigned char)((ulValue >> (8 * i)) & 0xFF);
+}
+
+/*Returns the number stored in the 4 bytes at pucBytes by SymTable_encode*/
+static unsigned long SymTable_decode(const unsigned char *pucBytes){
+    unsigned long ulValue = 0;
+    size_t i;
+    for (i = 4; i-- > 0; )
+        ulValue = (ulValue << 8) | pucBytes[i];
+    return ulValue;
+}
+
+/*Returns the 32 bit FNV-1a checksum ulHash continued over the uCount bytes at
+pvBytes. A checksum starts at 2166136261*/
+static unsigned long SymTable_checksum(unsigned long ulHash,
+    const void *pvBytes, size_t uCount){
+    const unsigned char *pucBytes = (const unsigned char *)pvBytes;
+    size_t i;
+
+    for (i = 0; i < uCount; i++)
+        ulHash = ((ulHash ^ pucBytes[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    return ulHash;
+}
+
+/*Writes to psFile a record of type iType for pcKey, with the uValueSize bytes
+at pvValue if it is a RECORD_SET: its type, the length of pcKey, pcKey, the
+value and a checksum of all of them. Returns 1 if successful, 0 if not*/
+static int SymTable_writeRecord(FILE *psFile, int iType, const char *pcKey,
+    const void *pvValue, size_t uValueSize){
+    unsigned char aucHead[5];
+    unsigned char aucChecksum[4];
+    size_t uKeyLength = strlen(pcKey);
+    unsigned long ulChecksum;
+
+    if (iType != RECORD_SET) uValueSize = 0;
+    aucHead[0] = (unsigned char)iType;
+    SymTable_encode(aucHead + 1, (unsigned long)uKeyLength);
+    ulChecksum = SymTable_checksum(2166136261UL, aucHead, sizeof(aucHead));
+    ulChecksum = SymTable_checksum(ulChecksum, pcKey, uKeyLength);
+    ulChecksum = SymTable_checksum(ulChecksum, pvValue, uValueSize);
+    SymTable_encode(aucChecksum, ulChecksum);
+
+    return fwrite(aucHead, 1, sizeof(aucHead), psFile) == sizeof(aucHead)
+        && fwrite(pcKey, 1, uKeyLength, psFile) == uKeyLength
+        && fwrite(pvValue, 1, uValueSize, psFile) == uValueSize
+        && fwrite(aucChecksum, 1, sizeof(aucChecksum), psFile) == sizeof(aucChecksum);
+}
+
+/*Writes the header of a log of values of uValueSize bytes to psFile. Returns 1
+if successful, 0 if not*/
+static int SymTable_writeHeader(FILE *psFile, size_t uValueSize){
+    unsigned char aucSize[4];
+
+    SymTable_encode(aucSize, (unsigned long)uValueSize);
+    return fwrite(acMagic, 1, MAGIC_LENGTH, psFile) == MAGIC_LENGTH
+        && fwrite(aucSize, 1, sizeof(aucSize), psFile) == sizeof(aucSize);
+}
+
+/*Writes out everything buffered for psFile and waits until it is on the disk.
+Returns 1 if successful, 0 if not*/
+static int SymTable_syncFile(FILE *psFile){
+    if (fflush(psFile) != 0 || ferror(psFile)) return 0;
+#ifdef SYMTABLE_FSYNC
+    if (fsync(fileno(psFile)) != 0) return 0;
+#endif
+    return 1;
+}
+
+/*Waits until the name of the file at pcPath, which was just renamed, is on the
+disk, by syncing the directory that holds it. Returns 1 if successful, 0 if
+not or if insufficient memory*/
+static int SymTable_syncDirectory(const char *pcPath){
+#ifdef SYMTABLE_FSYNC
+    const char *pcSlash = strrchr(pcPath, '/');
+    char *pcDirectory;
+    size_t uLength = 1;
+    int iDirectory;
+    int iSynced;
+
+    if (pcSlash == NULL)
+        pcPath = ".";
+    else if (pcSlash != pcPath)
+        uLength = (size_t)(pcSlash - pcPath);
+    pcDirectory = (char *)malloc(uLength + 1);
+    if (pcDirectory == NULL) return 0;
+    memcpy(pcDirectory, pcPath, uLength);
+    pcDirectory[uLength] = '\0';
+
+    iDirectory = open(pcDirectory, O_RDONLY);
+    free(pcDirectory);
+    if (iDirectory < 0) return 0;
+    iSynced = fsync(iDirectory) == 0;
+    close(iDirectory);
+    return iSynced;
+#else
+    (void)pcPath;
+    return 1;
+#endif
+}
+
+/*Writes the binding with pcKey and pvValue to the struct Snapshot pvSnapshot
+as a record*/
+static void SymTable_writeBinding(const char *pcKey, void *pvValue,
+    void *pvSnapshot){
+    struct Snapshot *psSnapshot = (struct Snapshot *)pvSnapshot;
+
+    if (psSnapshot->failed) return;
+    if (!SymTable_writeRecord(psSnapshot->file, RECORD_SET, pcKey, pvValue,
+        psSnapshot->valueSize))
+        psSnapshot->failed = 1;
+}
+
+/*Returns the number of records that bind a key in the log psFile of size
+lSize, from where psFile is up to its end or to the first record with a bad
+type or cut short, which is at least the number of bindings the log replays
+to. Reads only the head of each record, and leaves psFile anywhere*/
+static size_t SymTable_countSets(FILE *psFile, long lSize, size_t uValueSize){
+    unsigned char aucHead[5];
+    size_t uCount = 0;
+    size_t uSkip;
+
+    while (fread(aucHead, 1, sizeof(aucHead), psFile) == sizeof(aucHead)){
+        uSkip = (size_t)SymTable_decode(aucHead + 1) + 4;
+        if (aucHead[0] == RECORD_SET){
+            uSkip += uValueSize;
+            uCount++;
+        }
+        else if (aucHead[0] != RECORD_REMOVE)
+            break;
+        if (uSkip > (size_t)(lSize - ftell(psFile)) ||
+            fseek(psFile, (long)uSkip, SEEK_CUR) != 0)
+            break;
+    }
+    return uCount;
+}
+
+/*Reads the records of the log psFile of size lSize, whose header has been read,
+into the table of oSymTableDurable. Returns 1 if every record was read, 0 if
+the log ends in a record that was cut short or is damaged, which is dropped
+with the rest of the log, and -1 if insufficient memory*/
+static int SymTable_replay(SymTableDurable_T oSymTableDurable, FILE *psFile,
+    long lSize){
+    unsigned char aucHead[5];
+    unsigned char aucChecksum[4];
+    char *pcKey = NULL;
+    size_t uKeyCapacity = 0;
+    char *pcNewKey;
+    void *pvValue;
+    size_t uKeyLength;
+    size_t uValueLength;
+    unsigned long ulChecksum;
+    size_t uSets;
+    long lGoodEnd = ftell(psFile);
+    int iResult = 1;
+
+    /*sizes the table for every key the log binds before replaying it, so that
+    the table does not grow one put at a time*/
+    uSets = SymTable_countSets(psFile, lSize, oSymTableDurable->valueSize);
+    if (fseek(psFile, lGoodEnd, SEEK_SET) != 0) return -1;
+    SymTable_presize(oSymTableDurable->table, uSets);
+
+    pvValue = malloc(oSymTableDurable->valueSize);
+    if (pvValue == NULL) return -1;
+
+    while (fread(aucHead, 1, sizeof(aucHead), psFile) == sizeof(aucHead)){
+        uKeyLength = (size_t)SymTable_decode(aucHead + 1);
+        uValueLength = (aucHead[0] == RECORD_SET) ? oSymTableDurable->valueSize : 0;
+        if ((aucHead[0] != RECORD_SET && aucHead[0] != RECORD_REMOVE) ||
+            uKeyLength + uValueLength + sizeof(aucChecksum) >
+            (size_t)(lSize - ftell(psFile))){
+            iResult = 0;
+            break;
+        }
+        if (uKeyLength + 1 > uKeyCapacity){
+            pcNewKey = (char *)realloc(pcKey, uKeyLength + 1);
+            if (pcNewKey == NULL){
+                iResult = -1;
+                break;
+            }
+            pcKey = pcNewKey;
+            uKeyCapacity = uKeyLength + 1;
+        }
+        if (fread(pcKey, 1, uKeyLength, psFile) != uKeyLength ||
+            fread(pvValue, 1, uValueLength, psFile) != uValueLength ||
+            fread(aucChecksum, 1, sizeof(aucChecksum), psFile) != sizeof(aucChecksum)){
+            iResult = 0;
+            break;
+        }
+        ulChecksum = SymTable_checksum(2166136261UL, aucHead, sizeof(aucHead));
+        ulChecksum = SymTable_checksum(ulChecksum, pcKey, uKeyLength);
+        ulChecksum = SymTable_checksum(ulChecksum, pvValue, uValueLength);
+        if (ulChecksum != SymTable_decode(aucChecksum)){
+            iResult = 0;
+            break;
+        }
+        pcKey[uKeyLength] = '\0';
+
+        if (aucHead[0] == RECORD_REMOVE)
+            SymTable_remove(oSymTableDurable->table, pcKey);
+        else if (SymTable_contains(oSymTableDurable->table, pcKey))
+            SymTable_replace(oSymTableDurable->table, pcKey, pvValue);
+        else if (!SymTable_put(oSymTableDurable->table, pcKey, pvValue)){
+            iResult = -1;
+            break;
+        }
+        oSymTableDurable->numOfRecords++;
+        lGoodEnd = ftell(psFile);
+    }
+    if (iResult == 1 && lGoodEnd != lSize)
+        iResult = 0;
+
+    free(pcKey);
+    free(pvValue);
+    return iResult;
+}
+
+/*Closes the log of oSymTableDurable once it could not be written, so that no
+record goes after one that may be lost or cut short. Recovery drops a record
+cut short at the end of the log*/
+static void SymTable_breakLog(SymTableDurable_T oSymTableDurable){
+    fclose(oSymTableDurable->log);
+    oSymTableDurable->log = NULL;
+    oSymTableDurable->numOfPending = 0;
+}
+
+/*Appends a record of type iType for pcKey and pvValue to the log of
+oSymTableDurable, syncing the log once GROUP_COMMIT_SIZE records are pending.
+pvValue may be NULL for zeros. Returns 1 if the whole record was written, even
+if the sync then failed, since the record may still reach the disk and be
+replayed, so the change must be made. Returns 0 if the log is closed or the
+record could not be written. Either failure closes the log*/
+static int SymTable_log(SymTableDurable_T oSymTableDurable, int iType,
+    const char *pcKey, const void *pvValue){
+    if (oSymTableDurable->log == NULL) return 0;
+    if (pvValue == NULL) pvValue = oSymTableDurable->zeros;
+    if (!SymTable_writeRecord(oSymTableDurable->log, iType, pcKey, pvValue,
+        oSymTableDurable->valueSize)){
+        SymTable_breakLog(oSymTableDurable);
+        return 0;
+    }
+    oSymTableDurable->numOfRecords++;
+    oSymTableDurable->numOfPending++;
+    if (oSymTableDurable->numOfPending >= GROUP_COMMIT_SIZE)
+        (void)SymTableDurable_sync(oSymTableDurable);
+    return 1;
+}
+
+/*Compacts the log of oSymTableDurable if it holds many more records than the
+table has bindings. A failed compaction keeps the old log, so it is ignored*/
+static void SymTable_maybeCompact(SymTableDurable_T oSymTableDurable){
+    size_t uLength = SymTable_getLength(oSymTableDurable->table);
+
+    if (oSymTableDurable->numOfRecords > COMPACT_MINIMUM &&
+        oSymTableDurable->numOfRecords / COMPACT_FACTOR > uLength)
+        (void)SymTableDurable_compact(oSymTableDurable);
+}
+
+SymTableDurable_T SymTable_recover(const char *pcPath, size_t uValueSize){
+    SymTableDurable_T oSymTableDurable;
+    FILE *psFile;
+    char acHeader[MAGIC_LENGTH + 4];
+    long lSize = 0;
+    int iReplayed = 1;
+    assert(pcPath != NULL && uValueSize > 0);
+
+    oSymTableDurable = (SymTableDurable_T)malloc(sizeof(struct SymTableDurable));
+    if (oSymTableDurable == NULL) return NULL;
+    oSymTableDurable->table = SymTable_newInline(uValueSize);
+    oSymTableDurable->path = (char *)malloc(strlen(pcPath) + 1);
+    oSymTableDurable->compactPath =
+        (char *)malloc(strlen(pcPath) + sizeof(acCompactSuffix));
+    oSymTableDurable->zeros = calloc(1, uValueSize);
+    oSymTableDurable->log = NULL;
+    if (oSymTableDurable->table == NULL || oSymTableDurable->path == NULL ||
+        oSymTableDurable->compactPath == NULL || oSymTableDurable->zeros == NULL){
+        SymTableDurable_close(oSymTableDurable);
+        return NULL;
+    }
+    strcpy(oSymTableDurable->path, pcPath);
+    strcat(strcpy(oSymTableDurable->compactPath, pcPath), acCompactSuffix);
+    oSymTableDurable->valueSize = uValueSize;
+    oSymTableDurable->numOfRecords = 0;
+    oSymTableDurable->numOfPending = 0;
+
+    psFile = fopen(pcPath, "rb");
+    if (psFile != NULL){
+        if (fseek(psFile, 0, SEEK_END) != 0 || (lSize = ftell(psFile)) < 0 ||
+            fseek(psFile, 0, SEEK_SET) != 0)
+            iReplayed = -1;
+        else if (lSize < (long)sizeof(acHeader))
+            iReplayed = 0;
+        else if (fread(acHeader, 1, sizeof(acHeader), psFile) != sizeof(acHeader) ||
+            memcmp(acHeader, acMagic, MAGIC_LENGTH) != 0 ||
+            SymTable_decode((unsigned char *)acHeader + MAGIC_LENGTH) !=
+            (unsigned long)uValueSize)
+            iReplayed = -1;
+        else
+            iReplayed = SymTable_replay(oSymTableDurable, psFile, lSize);
+        fclose(psFile);
+        if (iReplayed < 0){
+            SymTableDurable_close(oSymTableDurable);
+            return NULL;
+        }
+    }
+
+    /*a new log, or one whose end was damaged, is written from the table*/
+    if (psFile == NULL || iReplayed == 0){
+        if (!SymTableDurable_compact(oSymTableDurable)){
+            SymTableDurable_close(oSymTableDurable);
+            return NULL;
+        }
+        return oSymTableDurable;
+    }
+
+    oSymTableDurable->log = fopen(pcPath, "ab");
+    if (oSymTableDurable->log == NULL){
+        SymTableDurable_close(oSymTableDurable);
+        return NULL;
+    }
+    return oSymTableDurable;
+}
+
+void SymTableDurable_close(SymTableDurable_T oSymTableDurable){
+    if (oSymTableDurable == NULL) return;
+    if (oSymTableDurable->log != NULL){
+        (void)SymTable_syncFile(oSymTableDurable->log);
+        fclose(oSymTableDurable->log);
+    }
+    if (oSymTableDurable->table != NULL)
+        SymTable_free(oSymTableDurable->table);
+    free(oSymTableDurable->zeros);
+    free(oSymTableDurable->path);
+    free(oSymTableDurable->compactPath);
+    free(oSymTableDurable);
+}
+
+SymTable_T SymTableDurable_table(SymTableDurable_T oSymTableDurable){
+    assert(oSymTableDurable != NULL);
+    return oSymTableDurable->table;
+}
+
+int SymTableDurable_put(SymTableDurable_T oSymTableDurable,
+    const char *pcKey, const void *pvValue){
+    assert(oSymTableDurable != NULL && pcKey != NULL);
+
+    /*put first, since it may fail for lack of memory, and a binding whose
+    record could not be written is taken out again*/
+    if (!SymTable_put(oSymTableDurable->table, pcKey, pvValue)) return 0;
+    if (!SymTable_log(oSymTableDurable, RECORD_SET, pcKey, pvValue)){
+        SymTable_remove(oSymTableDurable->table, pcKey);
+        return 0;
+    }
+    SymTable_maybeCompact(oSymTableDurable);
+    return 1;
+}
+
+void *SymTableDurable_replace(SymTableDurable_T oSymTableDurable,
+    const char *pcKey, const void *pvValue){
+    void *pvOld;
+    assert(oSymTableDurable != NULL && pcKey != NULL);
+
+    if (!SymTable_contains(oSymTableDurable->table, pcKey)) return NULL;
+    if (!SymTable_log(oSymTableDurable, RECORD_SET, pcKey, pvValue)) return NULL;
+    pvOld = SymTable_replace(oSymTableDurable->table, pcKey, pvValue);
+    SymTable_maybeCompact(oSymTableDurable);
+    return pvOld;
+}
+
+void *SymTableDurable_remove(SymTableDurable_T oSymTableDurable,
+    const char *pcKey){
+    void *pvOld;
+    assert(oSymTableDurable != NULL && pcKey != NULL);
+
+    if (!SymTable_contains(oSymTableDurable->table, pcKey)) return NULL;
+    if (!SymTable_log(oSymTableDurable, RECORD_REMOVE, pcKey, NULL)) return NULL;
+    pvOld = SymTable_remove(oSymTableDurable->table, pcKey);
+    SymTable_maybeCompact(oSymTableDurable);
+    return pvOld;
+}
+
+int SymTableDurable_sync(SymTableDurable_T oSymTableDurable){
+    assert(oSymTableDurable != NULL);
+
+    if (oSymTableDurable->log == NULL) return 0;
+    if (!SymTable_syncFile(oSymTableDurable->log)){
+        SymTable_breakLog(oSymTableDurable);
+        return 0;
+    }
+    oSymTableDurable->numOfPending = 0;
+    return 1;
+}
+
+int SymTableDurable_compact(SymTableDurable_T oSymTableDurable){
+    struct Snapshot sSnapshot;
+    int iWasOpen;
+    assert(oSymTableDurable != NULL);
+
+    /*the snapshot is written beside the log and renamed over it once it is
+    on the disk, so that a crash leaves one of the two whole*/
+    sSnapshot.file = fopen(oSymTableDurable->compactPath, "wb");
+    if (sSnapshot.file == NULL) return 0;
+    sSnapshot.valueSize = oSymTableDurable->valueSize;
+    sSnapshot.failed = !SymTable_writeHeader(sSnapshot.file,
+        oSymTableDurable->valueSize);
+    SymTable_map(oSymTableDurable->table, SymTable_writeBinding, &sSnapshot);
+    if (!sSnapshot.failed && !SymTable_syncFile(sSnapshot.file))
+        sSnapshot.failed = 1;
+    if (fclose(sSnapshot.file) != 0)
+        sSnapshot.failed = 1;
+    if (sSnapshot.failed){
+        remove(oSymTableDurable->compactPath);
+        return 0;
+    }
+
+    /*a log closed after a failed write is only reopened by a new snapshot,
+    since a record after one cut short would be dropped*/
+    iWasOpen = oSymTableDurable->log != NULL;
+    if (iWasOpen){
+        fclose(oSymTableDurable->log);
+        oSymTableDurable->log = NULL;
+    }
+    if (rename(oSymTableDurable->compactPath, oSymTableDurable->path) != 0){
+        remove(oSymTableDurable->compactPath);
+        if (iWasOpen)
+            oSymTableDurable->log = fopen(oSymTableDurable->path, "ab");
+        return 0;
+    }
+
+    /*until the directory is synced a crash may bring back the old log, which
+    lacks its unsynced records, so records are only appended to the new one
+    once its name is on the disk*/
+    if (!SymTable_syncDirectory(oSymTableDurable->path)) return 0;
+    oSymTableDurable->log = fopen(oSymTableDurable->path, "ab");
+    if (oSymTableDurable->log == NULL) return 0;
+    oSymTableDurable->numOfRecords = SymTable_getLength(oSymTableDurable->table);
+    oSymTableDurable->numOfPending = 0;
+    return 1;
+}
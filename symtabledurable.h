@@ -0,0 +1,69 @@
+/*--------------------------------------------------------------------*/
+/* symtabledurable.h                                                  */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEDURABLE_INCLUDED
+#define SYMTABLEDURABLE_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Creates an alias SymTableDurable_T as an opaque pointer to a durable symbol
+table. A durable symbol table is a SymTable made by SymTable_newInline whose
+changes are appended to a log file, so that it can be rebuilt after a restart
+by replaying the log. The log is rewritten as a snapshot of the bindings once
+it holds many more records than the table has bindings*/
+typedef struct SymTableDurable *SymTableDurable_T;
+
+/*Creates and returns a durable table whose values are blocks of uValueSize
+bytes, with the bindings recorded in the log file at pcPath, which is created
+if it does not exist. A record cut short by a crash at the end of the log is
+dropped. Returns NULL if insufficient memory, if the log cannot be read or
+written, or if it was written with another uValueSize*/
+SymTableDurable_T SymTable_recover(const char *pcPath, size_t uValueSize);
+
+/*Writes out the records not yet on disk, then frees all the memory associated
+with oSymTableDurable and closes its log*/
+void SymTableDurable_close(SymTableDurable_T oSymTableDurable);
+
+/*Returns the table of oSymTableDurable, for lookups and maps. It must not be
+changed other than through the functions below, nor freed*/
+SymTable_T SymTableDurable_table(SymTableDurable_T oSymTableDurable);
+
+/*Inserts new binding with pcKey and a copy of the uValueSize bytes at pvValue
+into oSymTableDurable and logs it. Returns 0 if pcKey is already in
+oSymTableDurable, if insufficient memory or if the log cannot be written, 1 if
+succesful*/
+int SymTableDurable_put(SymTableDurable_T oSymTableDurable,
+    const char *pcKey, const void *pvValue);
+
+/*Replaces the value in oSymTableDurable associated with pcKey with a copy of
+the block at pvValue, logs it and returns a copy of the old value like
+SymTable_replace. Returns NULL if pcKey is not in oSymTableDurable or if the
+log cannot be written*/
+void *SymTableDurable_replace(SymTableDurable_T oSymTableDurable,
+    const char *pcKey, const void *pvValue);
+
+/*Removes the binding with pcKey if it exists in oSymTableDurable and logs it,
+returns a copy of its value like SymTable_remove. Returns NULL if pcKey is not
+in oSymTableDurable or if the log cannot be written*/
+void *SymTableDurable_remove(SymTableDurable_T oSymTableDurable,
+    const char *pcKey);
+
+/*Records are written to the disk in groups, so a crash loses at most the last
+group of changes. Once a record cannot be written or synced the log is closed:
+a change whose record was written stays made, later puts, replaces and removes
+fail, and SymTableDurable_sync returns 0 until SymTableDurable_compact starts
+a new log. Writes out and syncs every record not yet on disk. Returns 1 if
+successful, 0 if the log could not be written*/
+int SymTableDurable_sync(SymTableDurable_T oSymTableDurable);
+
+/*Rewrites the log of oSymTableDurable as one record per binding. Returns 1 if
+successful, 0 if insufficient memory or if the new log cannot be written, in
+which case the old log is kept. Also returns 0 if the new log replaced the old
+one but cannot be made durable or reopened, in which case the log is closed as
+after a failed sync*/
+int SymTableDurable_compact(SymTableDurable_T oSymTableDurable);
+
+#endif
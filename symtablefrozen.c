@@ -0,0 +1,263 @@
+/*--------------------------------------------------------------------*/
+/* symtablefrozen.c                                                   */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtablefrozen.h"
+#include "symtablestatic.h"
+
+/*average number of keys that share a displacement bucket*/
+static const size_t KEYS_PER_BUCKET = 5;
+
+/*number of hash seeds tried before freezing gives up*/
+static const size_t MAX_SEED_ATTEMPTS = 64;
+
+/*number of displacements tried for one bucket before trying a new seed,
+unless the table has more slots than that*/
+static const size_t MAX_DISPLACEMENTS = 1048576;
+
+/* Represents the frozen table */
+struct SymTableFrozen{
+    /*perfect hash table that owns its displacements, slots and keys*/
+    struct SymTableStatic table;
+};
+
+/* State passed to the SymTable_map callbacks while freezing*/
+struct FrozenBuilder{
+    /*number of bindings counted or copied so far*/
+    size_t numOfBindings;
+
+    /*number of key bytes counted or copied so far*/
+    size_t keyBytes;
+
+    /*contiguous key storage being filled*/
+    char *keys;
+
+    /*bindings in the order SymTable_map visited them*/
+    struct SymTableStaticSlot *entries;
+};
+
+/*Adds the length of pcKey and its '\0' to the key byte count of the
+FrozenBuilder pvExtra*/
+static void SymTableFrozen_countKey(const char *pcKey, void *pvValue,
+    void *pvExtra){
+    struct FrozenBuilder *psBuilder = (struct FrozenBuilder *)pvExtra;
+    (void)pvValue;
+    psBuilder->keyBytes += strlen(pcKey) + 1;
+    psBuilder->numOfBindings++;
+}
+
+/*Copies the binding with pcKey and pvValue into the FrozenBuilder pvExtra*/
+static void SymTableFrozen_copyBinding(const char *pcKey, void *pvValue,
+    void *pvExtra){
+    struct FrozenBuilder *psBuilder = (struct FrozenBuilder *)pvExtra;
+    struct SymTableStaticSlot *psEntry;
+
+    psEntry = &psBuilder->entries[psBuilder->numOfBindings];
+    psEntry->keyOffset = psBuilder->keyBytes;
+    psEntry->value = pvValue;
+    strcpy(psBuilder->keys + psBuilder->keyBytes, pcKey);
+    psBuilder->keyBytes += strlen(pcKey) + 1;
+    psBuilder->numOfBindings++;
+}
+
+/*Searches displacements for every bucket of psTable using its current seed,
+storing them in auDisplacements, and places the bindings of aoEntries into
+aoSlots. auHashes, auOrder, auBucketStart, auBucketOrder and acTaken are
+scratch arrays sized for psTable. Returns 1 if every bucket was placed, 0 if
+the seed must be changed*/
+static int SymTableFrozen_place(const struct SymTableStatic *psTable,
+    size_t *auDisplacements, struct SymTableStaticSlot *aoSlots,
+    const struct SymTableStaticSlot *aoEntries, size_t *auHashes, size_t *auOrder,
+    size_t *auBucketStart, size_t *auBucketOrder, char *acTaken){
+    size_t n = psTable->numOfBindings;
+    size_t r = psTable->numOfBuckets;
+    size_t uLimit;
+    size_t uMaxSize = 0;
+    size_t uSize;
+    size_t uBucket;
+    size_t uDisp;
+    size_t i;
+    size_t j;
+
+    /*displacements below n move a key through every slot, so with at least n
+    of them a bucket of one key always finds a free slot, however large n is*/
+    uLimit = (n < MAX_DISPLACEMENTS / n) ? n * n : MAX_DISPLACEMENTS;
+    if (uLimit < n)
+        uLimit = n;
+
+    /*hashes every key once and groups the keys by bucket*/
+    memset(auBucketStart, 0, sizeof(size_t) * (r + 1));
+    for (i = 0; i < n; i++){
+        auHashes[i] = SymTableStatic_hash(psTable->keys + aoEntries[i].keyOffset,
+            psTable->seed);
+        auBucketStart[SymTableStatic_bucket(auHashes[i], n, r) + 1]++;
+    }
+    for (i = 0; i < r; i++){
+        if (auBucketStart[i + 1] > uMaxSize)
+            uMaxSize = auBucketStart[i + 1];
+        auBucketStart[i + 1] += auBucketStart[i];
+    }
+    memset(auBucketOrder, 0, sizeof(size_t) * r);
+    for (i = 0; i < n; i++){
+        uBucket = SymTableStatic_bucket(auHashes[i], n, r);
+        auOrder[auBucketStart[uBucket] + auBucketOrder[uBucket]++] = i;
+    }
+
+    /*orders the buckets from largest to smallest, the largest are hardest to place*/
+    j = 0;
+    for (uSize = uMaxSize; uSize > 0; uSize--)
+        for (i = 0; i < r; i++)
+            if (auBucketStart[i + 1] - auBucketStart[i] == uSize)
+                auBucketOrder[j++] = i;
+    for (i = 0; i < r; i++)
+        auDisplacements[i] = 0;
+
+    memset(acTaken, 0, n);
+    for (i = 0; i < j; i++){
+        size_t uFirst;
+        size_t uEnd;
+        size_t k;
+
+        uBucket = auBucketOrder[i];
+        uFirst = auBucketStart[uBucket];
+        uEnd = auBucketStart[uBucket + 1];
+        for (uDisp = 0; uDisp < uLimit; uDisp++){
+            /*tentatively claims a slot for every key of the bucket*/
+            for (k = uFirst; k < uEnd; k++){
+                size_t uSlot = SymTableStatic_slot(auHashes[auOrder[k]], uDisp, n);
+                if (acTaken[uSlot])
+                    break;
+                acTaken[uSlot] = 1;
+            }
+            if (k == uEnd)
+                break;
+            /*releases the slots claimed before the collision*/
+            while (k > uFirst){
+                k--;
+                acTaken[SymTableStatic_slot(auHashes[auOrder[k]], uDisp, n)] = 0;
+            }
+        }
+        if (uDisp == uLimit)
+            return 0;
+
+        auDisplacements[uBucket] = uDisp;
+        for (k = uFirst; k < uEnd; k++)
+            aoSlots[SymTableStatic_slot(auHashes[auOrder[k]], uDisp, n)] =
+                aoEntries[auOrder[k]];
+    }
+    return 1;
+}
+
+SymTableFrozen_T SymTable_freeze(SymTable_T oSymTable){
+    SymTableFrozen_T oFrozen;
+    struct FrozenBuilder sBuilder;
+    size_t *auDisplacements;
+    struct SymTableStaticSlot *aoSlots;
+    size_t *auHashes;
+    size_t *auOrder;
+    size_t *auBucketStart;
+    size_t *auBucketOrder;
+    char *acTaken;
+    size_t n;
+    size_t r;
+    int iPlaced = 0;
+
+    assert(oSymTable != NULL);
+
+    oFrozen = (SymTableFrozen_T)malloc(sizeof(struct SymTableFrozen));
+    if (oFrozen == NULL) return NULL;
+
+    sBuilder.numOfBindings = 0;
+    sBuilder.keyBytes = 0;
+    SymTable_map(oSymTable, SymTableFrozen_countKey, &sBuilder);
+    n = sBuilder.numOfBindings;
+    r = n / KEYS_PER_BUCKET + 1;
+
+    sBuilder.keys = (char *)malloc(sBuilder.keyBytes + 1);
+    aoSlots = (struct SymTableStaticSlot *)malloc(sizeof(struct SymTableStaticSlot) * (n + 1));
+    auDisplacements = (size_t *)malloc(sizeof(size_t) * r);
+    oFrozen->table.numOfBindings = n;
+    oFrozen->table.numOfBuckets = r;
+    oFrozen->table.seed = 0;
+    oFrozen->table.keys = sBuilder.keys;
+    oFrozen->table.slots = aoSlots;
+    oFrozen->table.displacements = auDisplacements;
+
+    sBuilder.entries = (struct SymTableStaticSlot *)malloc(sizeof(struct SymTableStaticSlot) * (n + 1));
+    auHashes = (size_t *)malloc(sizeof(size_t) * (n + 1));
+    auOrder = (size_t *)malloc(sizeof(size_t) * (n + 1));
+    auBucketStart = (size_t *)malloc(sizeof(size_t) * (r + 1));
+    auBucketOrder = (size_t *)malloc(sizeof(size_t) * r);
+    acTaken = (char *)malloc(n + 1);
+
+    if (sBuilder.keys != NULL && aoSlots != NULL && auDisplacements != NULL &&
+        sBuilder.entries != NULL && auHashes != NULL && auOrder != NULL &&
+        auBucketStart != NULL && auBucketOrder != NULL && acTaken != NULL){
+        sBuilder.numOfBindings = 0;
+        sBuilder.keyBytes = 0;
+        SymTable_map(oSymTable, SymTableFrozen_copyBinding, &sBuilder);
+
+        iPlaced = (n == 0);
+        while (!iPlaced && oFrozen->table.seed < MAX_SEED_ATTEMPTS){
+            iPlaced = SymTableFrozen_place(&oFrozen->table, auDisplacements,
+                aoSlots, sBuilder.entries, auHashes, auOrder, auBucketStart,
+                auBucketOrder, acTaken);
+            if (!iPlaced)
+                oFrozen->table.seed++;
+        }
+    }
+
+    free(sBuilder.entries);
+    free(auHashes);
+    free(auOrder);
+    free(auBucketStart);
+    free(auBucketOrder);
+    free(acTaken);
+
+    if (!iPlaced){
+        SymTableFrozen_free(oFrozen);
+        return NULL;
+    }
+    return oFrozen;
+}
+
+void SymTableFrozen_free(SymTableFrozen_T oSymTableFrozen){
+    assert(oSymTableFrozen != NULL);
+    free((void *)oSymTableFrozen->table.keys);
+    free((void *)oSymTableFrozen->table.slots);
+    free((void *)oSymTableFrozen->table.displacements);
+    free(oSymTableFrozen);
+}
+
+size_t SymTableFrozen_getLength(SymTableFrozen_T oSymTableFrozen){
+    assert(oSymTableFrozen != NULL);
+    return SymTableStatic_getLength(&oSymTableFrozen->table);
+}
+
+int SymTableFrozen_contains(SymTableFrozen_T oSymTableFrozen,
+    const char *pcKey){
+    assert(oSymTableFrozen != NULL && pcKey != NULL);
+    return SymTableStatic_contains(&oSymTableFrozen->table, pcKey);
+}
+
+void *SymTableFrozen_get(SymTableFrozen_T oSymTableFrozen, const char *pcKey){
+    assert(oSymTableFrozen != NULL && pcKey != NULL);
+    return SymTableStatic_get(&oSymTableFrozen->table, pcKey);
+}
+
+void SymTableFrozen_map(SymTableFrozen_T oSymTableFrozen,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        assert(oSymTableFrozen != NULL && pfApply != NULL);
+        SymTableStatic_map(&oSymTableFrozen->table, pfApply, pvExtra);
+}
+
+SymTableStatic_T SymTableFrozen_asStatic(SymTableFrozen_T oSymTableFrozen){
+    assert(oSymTableFrozen != NULL);
+    return &oSymTableFrozen->table;
+}
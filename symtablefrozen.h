@@ -0,0 +1,50 @@
+/*--------------------------------------------------------------------*/
+/* symtablefrozen.h                                                   */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEFROZEN_INCLUDED
+#define SYMTABLEFROZEN_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+#include "symtablestatic.h"
+
+/*Creates an alias SymTableFrozen_T as an opaque pointer to a frozen symbol table.
+A frozen symbol table is a read-only copy of a SymTable whose keys are stored
+contiguously and indexed by a minimal perfect hash, so every lookup does one hash,
+one probe and one key comparison.*/
+typedef struct SymTableFrozen *SymTableFrozen_T;
+
+/*Creates and returns a frozen copy of the bindings in oSymTable. The keys are
+copied, the values are shared with oSymTable. oSymTable is not changed and may be
+freed independently. Returns NULL if insufficient memory, or if no perfect hash
+was found for the keys, which the search makes unlikely for any number of keys*/
+SymTableFrozen_T SymTable_freeze(SymTable_T oSymTable);
+
+/*Frees all the memory associated with oSymTableFrozen*/
+void SymTableFrozen_free(SymTableFrozen_T oSymTableFrozen);
+
+/*Returns number of bindings in oSymTableFrozen*/
+size_t SymTableFrozen_getLength(SymTableFrozen_T oSymTableFrozen);
+
+/*Returns 1 if there is a binding with pcKey in oSymTableFrozen,
+returns 0 if there is not*/
+int SymTableFrozen_contains(SymTableFrozen_T oSymTableFrozen,
+    const char *pcKey);
+
+/*Returns the value associated with pcKey in oSymTableFrozen, or NULL if
+pcKey is not in oSymTableFrozen*/
+void *SymTableFrozen_get(SymTableFrozen_T oSymTableFrozen, const char *pcKey);
+
+/*Applies the function pfApply to all bindings in oSymTableFrozen, passes
+pvExtra as an argument of pfApply*/
+void SymTableFrozen_map(SymTableFrozen_T oSymTableFrozen,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*Returns oSymTableFrozen viewed as a static table, valid until oSymTableFrozen
+is freed. symtablegen uses it to write a frozen table out as C source*/
+SymTableStatic_T SymTableFrozen_asStatic(SymTableFrozen_T oSymTableFrozen);
+
+#endif
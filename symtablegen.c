@@ -0,0 +1,191 @@
+/*--------------------------------------------------------------------*/
+/* symtablegen.c                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "symtable.h"
+#include "symtablefrozen.h"
+#include "symtablestatic.h"
+
+/*number of numbers written on one line of an array initializer*/
+static const size_t NUMBERS_PER_LINE = 12;
+
+/*Reads one line of psFile without its '\n' into a new string and returns it.
+Returns NULL at end of file or if insufficient memory*/
+static char *readLine(FILE *psFile){
+    size_t uLength = 0;
+    size_t uSize = 64;
+    char *pcLine;
+    char *pcBigger;
+    int iChar;
+
+    pcLine = (char *)malloc(uSize);
+    if (pcLine == NULL) return NULL;
+
+    while ((iChar = getc(psFile)) != EOF && iChar != '\n'){
+        if (uLength + 1 == uSize){
+            uSize *= 2;
+            pcBigger = (char *)realloc(pcLine, uSize);
+            if (pcBigger == NULL){
+                free(pcLine);
+                return NULL;
+            }
+            pcLine = pcBigger;
+        }
+        pcLine[uLength++] = (char)iChar;
+    }
+    if (iChar == EOF && uLength == 0){
+        free(pcLine);
+        return NULL;
+    }
+    pcLine[uLength] = '\0';
+    return pcLine;
+}
+
+/*Frees the value expression pvValue of a binding, pcKey and pvExtra are unused*/
+static void freeValue(const char *pcKey, void *pvValue, void *pvExtra){
+    (void)pcKey;
+    (void)pvExtra;
+    free(pvValue);
+}
+
+/*Writes the array of numbers auNumbers of length uCount to psFile, as the
+body of an array initializer*/
+static void writeNumbers(FILE *psFile, const size_t *auNumbers, size_t uCount){
+    size_t i;
+    for (i = 0; i < uCount; i++)
+        fprintf(psFile, "%s%lu,", (i % NUMBERS_PER_LINE == 0) ? "\n    " : " ",
+            (unsigned long)auNumbers[i]);
+    fprintf(psFile, "\n");
+}
+
+/*Writes oSymTableStatic to psFile as the definition of a const struct
+SymTableStatic named pcName. The value of each binding must be a string
+holding a C expression, or NULL. pcHeader, if not NULL, is included by the
+written file*/
+static void writeTable(FILE *psFile, SymTableStatic_T oSymTableStatic,
+    const char *pcName, const char *pcHeader){
+    const struct SymTableStaticSlot *psSlot;
+    size_t uKeyBytes = 0;
+    size_t uKeyEnd;
+    size_t n;
+    size_t i;
+
+    /*the key storage ends after the key with the largest offset*/
+    n = oSymTableStatic->numOfBindings;
+    for (i = 0; i < n; i++){
+        psSlot = &oSymTableStatic->slots[i];
+        uKeyEnd = psSlot->keyOffset
+            + strlen(oSymTableStatic->keys + psSlot->keyOffset) + 1;
+        if (uKeyEnd > uKeyBytes)
+            uKeyBytes = uKeyEnd;
+    }
+
+    fprintf(psFile, "/* %s: generated by symtablegen, do not edit. */\n\n", pcName);
+    fprintf(psFile, "#include <stddef.h>\n#include \"symtablestatic.h\"\n");
+    if (pcHeader != NULL)
+        fprintf(psFile, "#include \"%s\"\n", pcHeader);
+
+    fprintf(psFile, "\nstatic const size_t auDisplacements[] = {");
+    writeNumbers(psFile, oSymTableStatic->displacements,
+        oSymTableStatic->numOfBuckets);
+    fprintf(psFile, "};\n");
+
+    fprintf(psFile, "\nstatic const struct SymTableStaticSlot asSlots[] = {\n");
+    for (i = 0; i < n; i++){
+        psSlot = &oSymTableStatic->slots[i];
+        fprintf(psFile, "    {%lu, (const void *)(%s)},\n",
+            (unsigned long)psSlot->keyOffset,
+            (psSlot->value == NULL) ? "NULL" : (const char *)psSlot->value);
+    }
+    if (n == 0)
+        fprintf(psFile, "    {0, NULL}\n");
+    fprintf(psFile, "};\n");
+
+    fprintf(psFile, "\nstatic const char acKeys[] = {");
+    for (i = 0; i < uKeyBytes; i++)
+        fprintf(psFile, "%s%d,", (i % NUMBERS_PER_LINE == 0) ? "\n    " : " ",
+            (int)(unsigned char)oSymTableStatic->keys[i]);
+    if (uKeyBytes == 0)
+        fprintf(psFile, "\n    0,");
+    fprintf(psFile, "\n};\n");
+
+    fprintf(psFile, "\nconst struct SymTableStatic %s = {\n", pcName);
+    fprintf(psFile, "    %lu, %lu, %lu, auDisplacements, asSlots, acKeys\n};\n",
+        (unsigned long)n, (unsigned long)oSymTableStatic->numOfBuckets,
+        (unsigned long)oSymTableStatic->seed);
+}
+
+/* Read a key list from stdin and write to stdout a C source file that
+   defines a const struct SymTableStatic named argv[1] holding those keys.
+   Each line of the key list is a key, optionally followed by a tab and a
+   C expression that is the value of the binding; a key without a value is
+   bound to NULL. argv[2], if present, is a header that the written file
+   includes, for the names its values use. Exit with EXIT_FAILURE if the
+   arguments are wrong, a key is repeated, or memory is insufficient.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[]){
+    SymTable_T oSymTable;
+    SymTableFrozen_T oSymTableFrozen;
+    char *pcLine;
+    char *pcTab;
+    char *pcValue;
+
+    if (argc != 2 && argc != 3){
+        fprintf(stderr, "Usage: %s tablename [header] < keylist > table.c\n",
+            argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL){
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    while ((pcLine = readLine(stdin)) != NULL){
+        pcValue = NULL;
+        pcTab = strchr(pcLine, '\t');
+        if (pcTab != NULL){
+            *pcTab = '\0';
+            if (pcTab[1] != '\0'){
+                pcValue = (char *)malloc(strlen(pcTab + 1) + 1);
+                if (pcValue == NULL){
+                    fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                strcpy(pcValue, pcTab + 1);
+            }
+        }
+        if (pcLine[0] != '\0' || pcTab != NULL){
+            if (SymTable_contains(oSymTable, pcLine)){
+                fprintf(stderr, "%s: duplicate key \"%s\"\n", argv[0], pcLine);
+                exit(EXIT_FAILURE);
+            }
+            if (!SymTable_put(oSymTable, pcLine, pcValue)){
+                fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        free(pcLine);
+    }
+
+    oSymTableFrozen = SymTable_freeze(oSymTable);
+    if (oSymTableFrozen == NULL){
+        fprintf(stderr, "%s: insufficient memory\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    writeTable(stdout, SymTableFrozen_asStatic(oSymTableFrozen), argv[1],
+        (argc == 3) ? argv[2] : NULL);
+
+    SymTableFrozen_free(oSymTableFrozen);
+    SymTable_map(oSymTable, freeValue, NULL);
+    SymTable_free(oSymTable);
+    return 0;
+}
@@ -0,0 +1,1046 @@
+/*--------------------------------------------------------------------*/
+/* symtablehamt.c                                                     */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtable.h"
+#include "symtablebuild.h"
+
+/*number of hash bits consumed by each level of the trie*/
+static const size_t BITS_PER_LEVEL = 5;
+
+/*mask that extracts the bits of one level from a hash code*/
+static const size_t LEVEL_MASK = 31;
+
+/*number of bits in a hash code, a node deeper than this holds collisions*/
+static const size_t HASH_BITS = sizeof(size_t) * 8;
+
+/*kinds of node in the trie*/
+enum NodeKind {LEAF, BRANCH, COLLISION};
+
+/* Represents a node of the trie. A leaf is a binding, a branch maps up to 32
+   positions to children, and a collision node holds leaves whose hash codes
+   are equal. Nodes are shared between a table and its clones, so a node may
+   be changed in place only when its refCount is 1 */
+struct HamtNode{
+    /*number of tables and nodes that point to this node*/
+    size_t refCount;
+
+    /*kind of the node*/
+    enum NodeKind kind;
+
+    /*1 if the node is a leaf put in a scope other than the outermost, which
+    is followed by its struct LeafScope*/
+    int scoped;
+
+    /*hash code of the key of a leaf, or shared by the leaves of a collision node*/
+    size_t hash;
+
+    /*key of a leaf, stored in the same allocation as the leaf unless the table
+    borrows keys*/
+    const char *key;
+
+    /*value of a leaf that is a void pointer, or in an inline table a pointer
+    to the value stored after the leaf*/
+    const void *value;
+
+    /*bit i of a branch is set when position i has a child*/
+    unsigned long bitmap;
+
+    /*number of children of a branch or collision node*/
+    size_t numOfChildren;
+
+    /*children of a branch in position order, stored after the node*/
+    struct HamtNode **children;
+};
+
+/* Represents the scope of a leaf put in a scope other than the outermost. It
+   is stored right after the leaf, before its value and key, so that the leaves
+   of a table that never opens a scope carry nothing for scopes*/
+struct LeafScope{
+    /*depth of the scope the leaf was put in, at least 1*/
+    size_t depth;
+
+    /*leaf with the same key in an outer scope that the leaf hides, or NULL*/
+    struct HamtNode *shadowed;
+};
+
+/* Represents the symbol table */
+struct SymTable{
+    /*number of bindings in the table*/
+    size_t numOfBindings;
+
+    /*root branch of the trie, possibly shared with clones of the table*/
+    struct HamtNode *root;
+
+    /*depth of the innermost scope, 0 when only the outermost scope is open*/
+    size_t numOfScopes;
+
+    /*scopeStarts[d] is the index in scopeLeaves of the first leaf put in open
+    scope d, for 1 <= d <= numOfScopes*/
+    size_t *scopeStarts;
+
+    /*number of entries allocated in scopeStarts*/
+    size_t scopeStartsCapacity;
+
+    /*every leaf put in a scope other than the outermost, in the order they
+    were put, each holding a reference to the leaf*/
+    struct HamtNode **scopeLeaves;
+
+    /*number of leaves in scopeLeaves*/
+    size_t numOfScopeLeaves;
+
+    /*number of entries allocated in scopeLeaves*/
+    size_t scopeLeavesCapacity;
+
+    /*size of the values stored in the leaves, 0 if values are void pointers*/
+    size_t valueSize;
+
+    /*copy of the last value replaced or removed from an inline table*/
+    void *oldValue;
+
+    /*1 if the leaves point to the callers' keys instead of copies*/
+    int borrowedKeys;
+};
+
+/* Return a hash code for pcKey that uses all the bits of a size_t. */
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = (size_t)1099511628211UL;
+   const size_t MIX_MULTIPLIER = (size_t)0xff51afd7ed558ccdUL;
+   size_t u;
+   size_t uHash = (size_t)14695981039346656037UL;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+      uHash = (uHash ^ (size_t)(unsigned char)pcKey[u]) * HASH_MULTIPLIER;
+
+   uHash ^= uHash >> 33;
+   uHash *= MIX_MULTIPLIER;
+   uHash ^= uHash >> 33;
+   return uHash;
+}
+
+/*Returns the number of bits set in the 32 low bits of ulBits*/
+static size_t SymTable_popcount(unsigned long ulBits){
+    ulBits = ulBits - ((ulBits >> 1) & 0x55555555UL);
+    ulBits = (ulBits & 0x33333333UL) + ((ulBits >> 2) & 0x33333333UL);
+    ulBits = (ulBits + (ulBits >> 4)) & 0x0f0f0f0fUL;
+    return (size_t)(((ulBits * 0x01010101UL) & 0xffffffffUL) >> 24);
+}
+
+/*Returns the position of hash code uHash in a branch at depth uShift*/
+static unsigned long SymTable_bit(size_t uHash, size_t uShift){
+    if (uShift >= HASH_BITS) return 1;
+    return 1UL << ((uHash >> uShift) & LEVEL_MASK);
+}
+
+/*Returns the index among the children of psBranch of the child at position
+ulBit*/
+static size_t SymTable_index(const struct HamtNode *psBranch, unsigned long ulBit){
+    return SymTable_popcount(psBranch->bitmap & (ulBit - 1));
+}
+
+/*Creates a branch or collision node of kind eKind with room for uCapacity
+children and no children. Returns NULL if insufficient memory*/
+static struct HamtNode *SymTable_newNode(enum NodeKind eKind, size_t uCapacity){
+    struct HamtNode *psNode;
+
+    psNode = (struct HamtNode *)malloc(sizeof(struct HamtNode)
+        + uCapacity * sizeof(struct HamtNode *));
+    if (psNode == NULL) return NULL;
+    psNode->refCount = 1;
+    psNode->kind = eKind;
+    psNode->scoped = 0;
+    psNode->hash = 0;
+    psNode->key = NULL;
+    psNode->value = NULL;
+    psNode->bitmap = 0;
+    psNode->numOfChildren = 0;
+    psNode->children = (struct HamtNode **)(psNode + 1);
+    return psNode;
+}
+
+/*Copies the uValueSize bytes at pvValue, or zeros if pvValue is NULL, into
+the inline value pvDest*/
+static void SymTable_storeValue(size_t uValueSize, void *pvDest,
+    const void *pvValue){
+    if (pvValue != NULL)
+        memcpy(pvDest, pvValue, uValueSize);
+    else
+        memset(pvDest, 0, uValueSize);
+}
+
+/*Creates a leaf of oSymTable with pcKey, its hash code uHash and pvValue, in
+the scope at depth uDepth, hiding psShadowed, which must be NULL if uDepth is
+0. The leaf holds a reference to psShadowed. The key is copied into the leaf
+unless oSymTable borrows keys, and so is the value if oSymTable is inline.
+Returns NULL if insufficient memory*/
+static struct HamtNode *SymTable_newLeaf(SymTable_T oSymTable, size_t uHash,
+    const char *pcKey, const void *pvValue, size_t uDepth,
+    struct HamtNode *psShadowed){
+    struct HamtNode *psLeaf;
+    struct LeafScope *psScope;
+    char *pcData;
+    size_t uScopeSize = (uDepth > 0) ? sizeof(struct LeafScope) : 0;
+    size_t uValueSize = oSymTable->valueSize;
+    size_t uKeySize = oSymTable->borrowedKeys ? 0 : strlen(pcKey) + 1;
+    assert(uDepth > 0 || psShadowed == NULL);
+
+    psLeaf = (struct HamtNode *)malloc(sizeof(struct HamtNode) + uScopeSize
+        + uValueSize + uKeySize);
+    if (psLeaf == NULL) return NULL;
+    psLeaf->refCount = 1;
+    psLeaf->kind = LEAF;
+    psLeaf->scoped = (uDepth > 0);
+    if (uDepth > 0){
+        psScope = (struct LeafScope *)(psLeaf + 1);
+        psScope->depth = uDepth;
+        psScope->shadowed = psShadowed;
+        if (psShadowed != NULL)
+            psShadowed->refCount++;
+    }
+    pcData = (char *)(psLeaf + 1) + uScopeSize;
+    psLeaf->hash = uHash;
+    psLeaf->key = pcKey;
+    if (!oSymTable->borrowedKeys)
+        psLeaf->key = strcpy(pcData + uValueSize, pcKey);
+    psLeaf->value = pvValue;
+    if (uValueSize != 0){
+        psLeaf->value = pcData;
+        SymTable_storeValue(uValueSize, pcData, pvValue);
+    }
+    psLeaf->bitmap = 0;
+    psLeaf->numOfChildren = 0;
+    psLeaf->children = NULL;
+    return psLeaf;
+}
+
+/*Returns the depth of the scope the leaf psLeaf was put in, 0 for the
+outermost scope*/
+static size_t SymTable_depth(const struct HamtNode *psLeaf){
+    if (!psLeaf->scoped) return 0;
+    return ((const struct LeafScope *)(psLeaf + 1))->depth;
+}
+
+/*Returns the leaf that the leaf psLeaf hides, or NULL if it hides none*/
+static struct HamtNode *SymTable_shadowed(const struct HamtNode *psLeaf){
+    if (!psLeaf->scoped) return NULL;
+    return ((const struct LeafScope *)(psLeaf + 1))->shadowed;
+}
+
+/*Drops one reference to psNode, freeing it and dropping its references to
+its children and to the leaf it hides when it was the last one*/
+static void SymTable_release(struct HamtNode *psNode){
+    size_t i;
+
+    if (psNode == NULL) return;
+    if (--psNode->refCount > 0) return;
+    for (i = 0; i < psNode->numOfChildren; i++)
+        SymTable_release(psNode->children[i]);
+    SymTable_release(SymTable_shadowed(psNode));
+    free(psNode);
+}
+
+/*Calls pfFreeValue on the value of every leaf in the trie psNode, hidden or
+not*/
+static void SymTable_freeValues(struct HamtNode *psNode,
+    void (*pfFreeValue)(void *pvValue)){
+    size_t i;
+
+    if (psNode->kind == LEAF){
+        for (; psNode != NULL; psNode = SymTable_shadowed(psNode))
+            (*pfFreeValue)((void *)psNode->value);
+        return;
+    }
+    for (i = 0; i < psNode->numOfChildren; i++)
+        SymTable_freeValues(psNode->children[i], pfFreeValue);
+}
+
+/*Takes over the caller's reference to psNode and returns a node with the same
+contents that only the caller points to, with room for uCapacity children. A
+node that is not shared and already has room is returned as is, otherwise
+it is copied. Returns NULL and leaves psNode alone if insufficient memory*/
+static struct HamtNode *SymTable_edit(struct HamtNode *psNode, size_t uCapacity){
+    struct HamtNode *psCopy;
+    size_t i;
+
+    if (psNode->refCount == 1 && uCapacity <= psNode->numOfChildren)
+        return psNode;
+
+    psCopy = SymTable_newNode(psNode->kind, uCapacity);
+    if (psCopy == NULL) return NULL;
+    psCopy->hash = psNode->hash;
+    psCopy->bitmap = psNode->bitmap;
+    psCopy->numOfChildren = psNode->numOfChildren;
+    for (i = 0; i < psNode->numOfChildren; i++)
+        psCopy->children[i] = psNode->children[i];
+
+    /*a shared node keeps its children, so the copy needs its own references*/
+    if (psNode->refCount > 1){
+        for (i = 0; i < psNode->numOfChildren; i++)
+            psNode->children[i]->refCount++;
+        psNode->refCount--;
+    }
+    else
+        free(psNode);
+    return psCopy;
+}
+
+/*Returns the leaf with pcKey and hash code uHash below psNode at depth
+uShift, or NULL if there is none*/
+static struct HamtNode *SymTable_locate(struct HamtNode *psNode, size_t uHash,
+    const char *pcKey, size_t uShift){
+    unsigned long ulBit;
+    size_t i;
+
+    while (psNode != NULL){
+        switch (psNode->kind){
+        case LEAF:
+            if (psNode->hash == uHash && strcmp(psNode->key, pcKey) == 0)
+                return psNode;
+            return NULL;
+        case COLLISION:
+            if (psNode->hash != uHash) return NULL;
+            for (i = 0; i < psNode->numOfChildren; i++)
+                if (strcmp(psNode->children[i]->key, pcKey) == 0)
+                    return psNode->children[i];
+            return NULL;
+        case BRANCH:
+            ulBit = SymTable_bit(uHash, uShift);
+            if ((psNode->bitmap & ulBit) == 0) return NULL;
+            psNode = psNode->children[SymTable_index(psNode, ulBit)];
+            uShift += BITS_PER_LEVEL;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*Returns a new node at depth uShift that holds both psNode, a leaf or
+collision node, and psLeaf, whose hash codes differ or psNode is a leaf.
+Takes over the caller's references to both. Sets *piFailed and returns
+psNode if insufficient memory*/
+static struct HamtNode *SymTable_join(struct HamtNode *psNode,
+    struct HamtNode *psLeaf, size_t uShift, int *piFailed){
+    struct HamtNode *psJoined;
+    struct HamtNode *psChild;
+    unsigned long ulBitA;
+    unsigned long ulBitB;
+
+    if (psNode->hash == psLeaf->hash){
+        psJoined = SymTable_newNode(COLLISION, 2);
+        if (psJoined == NULL){
+            *piFailed = 1;
+            return psNode;
+        }
+        psJoined->hash = psNode->hash;
+        psJoined->children[0] = psNode;
+        psJoined->children[1] = psLeaf;
+        psJoined->numOfChildren = 2;
+        return psJoined;
+    }
+
+    ulBitA = SymTable_bit(psNode->hash, uShift);
+    ulBitB = SymTable_bit(psLeaf->hash, uShift);
+    if (ulBitA == ulBitB){
+        psJoined = SymTable_newNode(BRANCH, 1);
+        if (psJoined == NULL){
+            *piFailed = 1;
+            return psNode;
+        }
+        psChild = SymTable_join(psNode, psLeaf, uShift + BITS_PER_LEVEL, piFailed);
+        if (*piFailed){
+            free(psJoined);
+            return psNode;
+        }
+        psJoined->bitmap = ulBitA;
+        psJoined->children[0] = psChild;
+        psJoined->numOfChildren = 1;
+        return psJoined;
+    }
+
+    psJoined = SymTable_newNode(BRANCH, 2);
+    if (psJoined == NULL){
+        *piFailed = 1;
+        return psNode;
+    }
+    psJoined->bitmap = ulBitA | ulBitB;
+    psJoined->children[ulBitA < ulBitB ? 0 : 1] = psNode;
+    psJoined->children[ulBitA < ulBitB ? 1 : 0] = psLeaf;
+    psJoined->numOfChildren = 2;
+    return psJoined;
+}
+
+/*Returns a node at depth uShift holding the bindings of psNode plus psLeaf,
+whose key is not below psNode. Takes over the caller's references to psNode
+and psLeaf. Sets *piFailed and returns a node equal to psNode, without
+psLeaf, if insufficient memory*/
+static struct HamtNode *SymTable_insert(struct HamtNode *psNode,
+    struct HamtNode *psLeaf, size_t uShift, int *piFailed){
+    struct HamtNode *psEdit;
+    unsigned long ulBit;
+    size_t uIndex;
+    size_t i;
+
+    if (psNode->kind == LEAF ||
+        (psNode->kind == COLLISION && psNode->hash != psLeaf->hash))
+        return SymTable_join(psNode, psLeaf, uShift, piFailed);
+
+    if (psNode->kind == COLLISION){
+        psEdit = SymTable_edit(psNode, psNode->numOfChildren + 1);
+        if (psEdit == NULL){
+            *piFailed = 1;
+            return psNode;
+        }
+        psEdit->children[psEdit->numOfChildren++] = psLeaf;
+        return psEdit;
+    }
+
+    ulBit = SymTable_bit(psLeaf->hash, uShift);
+    uIndex = SymTable_index(psNode, ulBit);
+    if ((psNode->bitmap & ulBit) == 0){
+        psEdit = SymTable_edit(psNode, psNode->numOfChildren + 1);
+        if (psEdit == NULL){
+            *piFailed = 1;
+            return psNode;
+        }
+        for (i = psEdit->numOfChildren; i > uIndex; i--)
+            psEdit->children[i] = psEdit->children[i - 1];
+        psEdit->children[uIndex] = psLeaf;
+        psEdit->numOfChildren++;
+        psEdit->bitmap |= ulBit;
+        return psEdit;
+    }
+
+    psEdit = SymTable_edit(psNode, psNode->numOfChildren);
+    if (psEdit == NULL){
+        *piFailed = 1;
+        return psNode;
+    }
+    psEdit->children[uIndex] = SymTable_insert(psEdit->children[uIndex], psLeaf,
+        uShift + BITS_PER_LEVEL, piFailed);
+    return psEdit;
+}
+
+/*Returns a node at depth uShift holding the bindings of psNode, a branch or
+collision node, without the binding with pcKey and hash code uHash, which is
+below psNode. The result is NULL if no binding is left, and a lone leaf is
+returned in place of a branch that is not the root. Takes over the caller's
+reference to psNode. Sets *piFailed and returns a node equal to psNode if
+insufficient memory*/
+static struct HamtNode *SymTable_delete(struct HamtNode *psNode, size_t uHash,
+    const char *pcKey, size_t uShift, int *piFailed){
+    struct HamtNode *psEdit;
+    struct HamtNode *psChild;
+    unsigned long ulBit = 0;
+    size_t uIndex = 0;
+    size_t i;
+
+    if (psNode->kind == COLLISION){
+        while (strcmp(psNode->children[uIndex]->key, pcKey) != 0)
+            uIndex++;
+    }
+    else{
+        ulBit = SymTable_bit(uHash, uShift);
+        uIndex = SymTable_index(psNode, ulBit);
+    }
+
+    psEdit = SymTable_edit(psNode, psNode->numOfChildren);
+    if (psEdit == NULL){
+        *piFailed = 1;
+        return psNode;
+    }
+
+    psChild = psEdit->children[uIndex];
+    if (psChild->kind != LEAF){
+        psEdit->children[uIndex] = SymTable_delete(psChild, uHash, pcKey,
+            uShift + BITS_PER_LEVEL, piFailed);
+        if (psEdit->children[uIndex] != NULL){
+            if (psEdit->numOfChildren == 1 && uShift > 0 &&
+                psEdit->children[uIndex]->kind == LEAF){
+                psChild = psEdit->children[uIndex];
+                free(psEdit);
+                return psChild;
+            }
+            return psEdit;
+        }
+    }
+    else
+        SymTable_release(psChild);
+
+    for (i = uIndex; i + 1 < psEdit->numOfChildren; i++)
+        psEdit->children[i] = psEdit->children[i + 1];
+    psEdit->numOfChildren--;
+    psEdit->bitmap &= ~ulBit;
+
+    /*a collision node or inner branch with one leaf left is replaced by it*/
+    if (uShift > 0 && psEdit->numOfChildren <= 1 &&
+        (psEdit->numOfChildren == 0 || psEdit->children[0]->kind == LEAF)){
+        psChild = (psEdit->numOfChildren == 0) ? NULL : psEdit->children[0];
+        free(psEdit);
+        return psChild;
+    }
+    return psEdit;
+}
+
+/*Returns a node at depth uShift holding the bindings of psNode with the leaf
+with pcKey and hash code uHash, which is below psNode, replaced by psLeaf, or
+if psLeaf is NULL with the value of that leaf set to pvValue, copied into the
+leaf if oSymTable is inline. Stores the old value in *ppvOld. Takes over the
+caller's references to psNode and psLeaf. Sets *piFailed and returns a node
+equal to psNode if insufficient memory, the caller then keeps its reference to
+psLeaf*/
+static struct HamtNode *SymTable_update(SymTable_T oSymTable,
+    struct HamtNode *psNode, size_t uHash, const char *pcKey, const void *pvValue,
+    struct HamtNode *psLeaf, size_t uShift, const void **ppvOld, int *piFailed){
+    struct HamtNode *psEdit;
+    struct HamtNode *psChild;
+    size_t uIndex = 0;
+
+    if (psNode->kind == LEAF){
+        *ppvOld = psNode->value;
+        if (psLeaf == NULL && psNode->refCount == 1){
+            if (oSymTable->valueSize != 0)
+                SymTable_storeValue(oSymTable->valueSize, (void *)psNode->value,
+                    pvValue);
+            else
+                psNode->value = pvValue;
+            return psNode;
+        }
+        if (psLeaf == NULL){
+            psLeaf = SymTable_newLeaf(oSymTable, uHash, psNode->key, pvValue,
+                SymTable_depth(psNode), SymTable_shadowed(psNode));
+            if (psLeaf == NULL){
+                *piFailed = 1;
+                return psNode;
+            }
+        }
+        SymTable_release(psNode);
+        return psLeaf;
+    }
+
+    if (psNode->kind == COLLISION){
+        while (strcmp(psNode->children[uIndex]->key, pcKey) != 0)
+            uIndex++;
+    }
+    else
+        uIndex = SymTable_index(psNode, SymTable_bit(uHash, uShift));
+
+    psEdit = SymTable_edit(psNode, psNode->numOfChildren);
+    if (psEdit == NULL){
+        *piFailed = 1;
+        return psNode;
+    }
+    psChild = psEdit->children[uIndex];
+    psEdit->children[uIndex] = SymTable_update(oSymTable, psChild, uHash, pcKey,
+        pvValue, psLeaf, uShift + BITS_PER_LEVEL, ppvOld, piFailed);
+    return psEdit;
+}
+
+/*Applies pfApply with pvExtra to every binding below psNode whose key starts
+with the uPrefixLength bytes at pcPrefix*/
+static void SymTable_mapNode(struct HamtNode *psNode, const char *pcPrefix,
+    size_t uPrefixLength,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+    size_t i;
+
+    if (psNode->kind == LEAF){
+        if (strncmp(psNode->key, pcPrefix, uPrefixLength) == 0)
+            (*pfApply)(psNode->key, (void *)psNode->value, (void *)pvExtra);
+        return;
+    }
+    for (i = 0; i < psNode->numOfChildren; i++)
+        SymTable_mapNode(psNode->children[i], pcPrefix, uPrefixLength, pfApply,
+            pvExtra);
+}
+
+/*Makes room in oSymTable for one more leaf in scopeLeaves. Returns 1 if
+successful, 0 if insufficient memory*/
+static int SymTable_reserveScopeLeaf(SymTable_T oSymTable){
+    struct HamtNode **psNewLeaves;
+    size_t uNewCapacity;
+
+    if (oSymTable->numOfScopeLeaves < oSymTable->scopeLeavesCapacity) return 1;
+    uNewCapacity = 2 * oSymTable->scopeLeavesCapacity + 16;
+    psNewLeaves = (struct HamtNode **)realloc(oSymTable->scopeLeaves,
+        sizeof(struct HamtNode *) * uNewCapacity);
+    if (psNewLeaves == NULL) return 0;
+    oSymTable->scopeLeaves = psNewLeaves;
+    oSymTable->scopeLeavesCapacity = uNewCapacity;
+    return 1;
+}
+
+/*Returns the value pvValue of a leaf of oSymTable that is being replaced or
+removed, saving a copy of it first if oSymTable is inline*/
+static void *SymTable_oldValue(SymTable_T oSymTable, const void *pvValue){
+    if (oSymTable->valueSize == 0) return (void *)pvValue;
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/*Removes the visible leaf psLeaf, with hash code uHash, from oSymTable,
+making the leaf it hides visible again. Returns 1 if successful, 0 if
+insufficient memory*/
+static int SymTable_removeLeaf(SymTable_T oSymTable, struct HamtNode *psLeaf,
+    size_t uHash){
+    struct HamtNode *psShadowed;
+    const void *pvOld;
+    int iFailed = 0;
+
+    psShadowed = SymTable_shadowed(psLeaf);
+    if (psShadowed == NULL){
+        oSymTable->root = SymTable_delete(oSymTable->root, uHash, psLeaf->key, 0,
+            &iFailed);
+        if (iFailed) return 0;
+        oSymTable->numOfBindings--;
+        return 1;
+    }
+
+    psShadowed->refCount++;
+    oSymTable->root = SymTable_update(oSymTable, oSymTable->root, uHash,
+        psShadowed->key, NULL, psShadowed, 0, &pvOld, &iFailed);
+    if (iFailed){
+        psShadowed->refCount--;
+        return 0;
+    }
+    return 1;
+}
+
+/*Brings the leaf psLeaf of a table being merged into oDest into the innermost
+scope of oDest, or if its key is already there sets the value of that key as
+ePolicy says. Returns 1 if successful, 0 if insufficient memory*/
+static int SymTable_mergeLeaf(SymTable_T oDest, struct HamtNode *psLeaf,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    struct HamtNode *psExisting;
+    const void *pvValue;
+    const void *pvOld;
+    int iFailed = 0;
+
+    psExisting = SymTable_locate(oDest->root, psLeaf->hash, psLeaf->key, 0);
+    if (psExisting != NULL && SymTable_depth(psExisting) == oDest->numOfScopes){
+        if (ePolicy == SYMTABLE_KEEP_EXISTING) return 1;
+        pvValue = psLeaf->value;
+        if (ePolicy == SYMTABLE_RESOLVE)
+            pvValue = (*pfResolve)(psLeaf->key, (void *)psExisting->value,
+                (void *)psLeaf->value, (void *)pvExtra);
+        if (pvValue == psExisting->value) return 1;
+        oDest->root = SymTable_update(oDest, oDest->root, psLeaf->hash,
+            psLeaf->key, pvValue, NULL, 0, &pvOld, &iFailed);
+        return !iFailed;
+    }
+
+    /*in the outermost scope the leaf is shared with the source, as a clone
+    would share it, so neither its key nor its value is copied*/
+    if (psExisting == NULL && oDest->numOfScopes == 0){
+        psLeaf->refCount++;
+        oDest->root = SymTable_insert(oDest->root, psLeaf, 0, &iFailed);
+        if (iFailed){
+            psLeaf->refCount--;
+            return 0;
+        }
+        oDest->numOfBindings++;
+        return 1;
+    }
+    return SymTable_put(oDest, psLeaf->key, psLeaf->value);
+}
+
+/*Brings every leaf below psNode, in a table being merged into oDest, into
+oDest with SymTable_mergeLeaf. Returns 1 if successful, 0 if insufficient
+memory*/
+static int SymTable_mergeNode(SymTable_T oDest, struct HamtNode *psNode,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    size_t i;
+
+    if (psNode->kind == LEAF)
+        return SymTable_mergeLeaf(oDest, psNode, ePolicy, pfResolve, pvExtra);
+    for (i = 0; i < psNode->numOfChildren; i++)
+        if (!SymTable_mergeNode(oDest, psNode->children[i], ePolicy, pfResolve,
+            pvExtra))
+            return 0;
+    return 1;
+}
+
+SymTable_T SymTable_new(void){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL) return NULL;
+    oSymTable->root = SymTable_newNode(BRANCH, 0);
+    if (oSymTable->root == NULL){
+        free(oSymTable);
+        return NULL;
+    }
+    oSymTable->numOfBindings = 0;
+    oSymTable->numOfScopes = 0;
+    oSymTable->scopeStarts = NULL;
+    oSymTable->scopeStartsCapacity = 0;
+    oSymTable->scopeLeaves = NULL;
+    oSymTable->numOfScopeLeaves = 0;
+    oSymTable->scopeLeavesCapacity = 0;
+    oSymTable->valueSize = 0;
+    oSymTable->oldValue = NULL;
+    oSymTable->borrowedKeys = 0;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newBorrowedKeys(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->borrowedKeys = 1;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newKeyHeap(void){
+    /*each key is already stored in the allocation of its leaf*/
+    return SymTable_new();
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize){
+    SymTable_T oSymTable;
+    assert(uValueSize > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->oldValue = malloc(uValueSize);
+    if (oSymTable->oldValue == NULL){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    oSymTable->valueSize = uValueSize;
+    return oSymTable;
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable){
+    SymTable_T oClone;
+    size_t i;
+    assert(oSymTable != NULL);
+
+    oClone = (SymTable_T)malloc(sizeof(struct SymTable));
+    if (oClone == NULL) return NULL;
+    oClone->root = oSymTable->root;
+    oClone->root->refCount++;
+    oClone->numOfBindings = oSymTable->numOfBindings;
+    oClone->numOfScopes = 0;
+    oClone->scopeStarts = NULL;
+    oClone->scopeStartsCapacity = 0;
+    oClone->scopeLeaves = NULL;
+    oClone->numOfScopeLeaves = 0;
+    oClone->scopeLeavesCapacity = 0;
+    oClone->valueSize = 0;
+    oClone->oldValue = NULL;
+    oClone->borrowedKeys = oSymTable->borrowedKeys;
+
+    /*the clone shares the leaves, so inline values are copied only on change*/
+    if (oSymTable->valueSize != 0){
+        oClone->oldValue = malloc(oSymTable->valueSize);
+        if (oClone->oldValue == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        oClone->valueSize = oSymTable->valueSize;
+    }
+    if (oSymTable->numOfScopes == 0) return oClone;
+
+    /*the clone shares the leaves of the open scopes too*/
+    oClone->scopeStarts = (size_t *)malloc(sizeof(size_t) * (oSymTable->numOfScopes + 1));
+    oClone->scopeLeaves = (struct HamtNode **)malloc(sizeof(struct HamtNode *)
+        * (oSymTable->numOfScopeLeaves + 1));
+    if (oClone->scopeStarts == NULL || oClone->scopeLeaves == NULL){
+        SymTable_free(oClone);
+        return NULL;
+    }
+    oClone->scopeStartsCapacity = oSymTable->numOfScopes + 1;
+    oClone->scopeLeavesCapacity = oSymTable->numOfScopeLeaves + 1;
+    oClone->numOfScopes = oSymTable->numOfScopes;
+    for (i = 0; i <= oSymTable->numOfScopes; i++)
+        oClone->scopeStarts[i] = oSymTable->scopeStarts[i];
+    for (i = 0; i < oSymTable->numOfScopeLeaves; i++){
+        oClone->scopeLeaves[i] = oSymTable->scopeLeaves[i];
+        oClone->scopeLeaves[i]->refCount++;
+    }
+    oClone->numOfScopeLeaves = oSymTable->numOfScopeLeaves;
+    return oClone;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates){
+    assert(ppcKeys != NULL && ppvValues != NULL && uThreadCount > 0);
+
+    /*every put copies the path from the root of the trie, so it is built on
+    the calling thread*/
+    (void)uThreadCount;
+    return SymTable_buildSerial(ppcKeys, ppvValues, uCount, puDuplicates);
+}
+
+void SymTable_free(SymTable_T oSymTable){
+    size_t i;
+    assert(oSymTable != NULL);
+    SymTable_release(oSymTable->root);
+    for (i = 0; i < oSymTable->numOfScopeLeaves; i++)
+        SymTable_release(oSymTable->scopeLeaves[i]);
+    free(oSymTable->scopeLeaves);
+    free(oSymTable->scopeStarts);
+    free(oSymTable->oldValue);
+    free(oSymTable);
+}
+
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue)){
+    struct HamtNode *psRoot;
+    size_t i;
+    assert(oSymTable != NULL);
+
+    /*the root may be shared with clones, so the table gets a new one*/
+    psRoot = SymTable_newNode(BRANCH, 0);
+    if (psRoot == NULL) return 0;
+    if (pfFreeValue != NULL)
+        SymTable_freeValues(oSymTable->root, pfFreeValue);
+    SymTable_release(oSymTable->root);
+    for (i = 0; i < oSymTable->numOfScopeLeaves; i++)
+        SymTable_release(oSymTable->scopeLeaves[i]);
+    oSymTable->root = psRoot;
+    oSymTable->numOfScopeLeaves = 0;
+    oSymTable->numOfBindings = 0;
+    oSymTable->numOfScopes = 0;
+    return 1;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+    return oSymTable->numOfBindings;
+}
+
+int SymTable_presize(SymTable_T oSymTable, size_t uCount){
+    assert(oSymTable != NULL);
+    /*a trie grows one node at a time as keys are put*/
+    (void)uCount;
+    return 1;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    struct HamtNode *psLeaf;
+    struct HamtNode *psShadowed;
+    const void *pvOld;
+    size_t uHash;
+    int iFailed = 0;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+    psShadowed = SymTable_locate(oSymTable->root, uHash, pcKey, 0);
+    if (psShadowed != NULL && SymTable_depth(psShadowed) == oSymTable->numOfScopes)
+        return 0;
+    if (oSymTable->numOfScopes > 0 && !SymTable_reserveScopeLeaf(oSymTable)) return 0;
+
+    psLeaf = SymTable_newLeaf(oSymTable, uHash, pcKey, pvValue,
+        oSymTable->numOfScopes, psShadowed);
+    if (psLeaf == NULL) return 0;
+
+    /*a leaf that hides another takes its place in the trie*/
+    if (psShadowed != NULL){
+        oSymTable->root = SymTable_update(oSymTable, oSymTable->root, uHash,
+            pcKey, NULL, psLeaf, 0, &pvOld, &iFailed);
+    }
+    else
+        oSymTable->root = SymTable_insert(oSymTable->root, psLeaf, 0, &iFailed);
+    if (iFailed){
+        SymTable_release(psLeaf);
+        return 0;
+    }
+    if (psShadowed == NULL)
+        oSymTable->numOfBindings++;
+
+    if (oSymTable->numOfScopes > 0){
+        psLeaf->refCount++;
+        oSymTable->scopeLeaves[oSymTable->numOfScopeLeaves++] = psLeaf;
+    }
+    return 1;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
+    struct HamtNode *psLeaf;
+    const void *pvOld;
+    void *pvSaved;
+    size_t uHash;
+    int iFailed = 0;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+    psLeaf = SymTable_locate(oSymTable->root, uHash, pcKey, 0);
+    if (psLeaf == NULL) return NULL;
+    pvSaved = SymTable_oldValue(oSymTable, psLeaf->value);
+
+    oSymTable->root = SymTable_update(oSymTable, oSymTable->root, uHash, pcKey,
+        pvValue, NULL, 0, &pvOld, &iFailed);
+    if (iFailed) return NULL;
+    return pvSaved;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(oSymTable != NULL && pcKey != NULL);
+    return SymTable_locate(oSymTable->root, SymTable_hash(pcKey), pcKey, 0) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    struct HamtNode *psLeaf;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    psLeaf = SymTable_locate(oSymTable->root, SymTable_hash(pcKey), pcKey, 0);
+    if (psLeaf == NULL) return NULL;
+    return (void *)psLeaf->value;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    struct HamtNode *psLeaf;
+    const void *pvValue;
+    size_t uHash;
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+    psLeaf = SymTable_locate(oSymTable->root, uHash, pcKey, 0);
+    if (psLeaf == NULL) return NULL;
+    pvValue = SymTable_oldValue(oSymTable, psLeaf->value);
+
+    if (!SymTable_removeLeaf(oSymTable, psLeaf, uHash)) return NULL;
+    return (void *)pvValue;
+}
+
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey){
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    /*the handle is the leaf, which keeps its hash code, so following calls
+    walk down to it again without hashing the key*/
+    return (SymTable_Handle)SymTable_locate(oSymTable->root, SymTable_hash(pcKey),
+        pcKey, 0);
+}
+
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return (void *)((struct HamtNode *)oHandle)->value;
+}
+
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue){
+    struct HamtNode *psLeaf = (struct HamtNode *)oHandle;
+    const void *pvOld;
+    void *pvSaved;
+    int iFailed = 0;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    /*a leaf shared with a clone is copied, not changed, so the handle ends*/
+    pvSaved = SymTable_oldValue(oSymTable, psLeaf->value);
+    oSymTable->root = SymTable_update(oSymTable, oSymTable->root, psLeaf->hash,
+        psLeaf->key, pvValue, NULL, 0, &pvOld, &iFailed);
+    if (iFailed) return NULL;
+    return pvSaved;
+}
+
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle){
+    struct HamtNode *psLeaf = (struct HamtNode *)oHandle;
+    const void *pvValue;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    pvValue = SymTable_oldValue(oSymTable, psLeaf->value);
+    if (!SymTable_removeLeaf(oSymTable, psLeaf, psLeaf->hash)) return NULL;
+    return (void *)pvValue;
+}
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        assert(oSymTable != NULL && pfApply != NULL);
+        SymTable_mapNode(oSymTable->root, "", 0, pfApply, pvExtra);
+}
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        assert(oSymTable != NULL && pcPrefix != NULL && pfApply != NULL);
+
+        /*the keys are spread by their hash codes, so every binding is checked*/
+        SymTable_mapNode(oSymTable->root, pcPrefix, strlen(pcPrefix), pfApply,
+            pvExtra);
+}
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    assert(oDest != NULL && oSource != NULL && oDest != oSource);
+    assert(oSource->numOfScopes == 0 && oSource->valueSize == oDest->valueSize &&
+        oSource->borrowedKeys == oDest->borrowedKeys);
+    assert(ePolicy != SYMTABLE_RESOLVE || pfResolve != NULL);
+
+    /*the trie has no buckets to size, and oSource is only read until it is freed*/
+    if (!SymTable_mergeNode(oDest, oSource->root, ePolicy, pfResolve, pvExtra))
+        return 0;
+    SymTable_free(oSource);
+    return 1;
+}
+
+int SymTable_pushScope(SymTable_T oSymTable){
+    size_t *puNewStarts;
+    size_t uNewCapacity;
+    assert(oSymTable != NULL);
+
+    if (oSymTable->numOfScopes + 1 >= oSymTable->scopeStartsCapacity){
+        uNewCapacity = 2 * oSymTable->scopeStartsCapacity + 2;
+        puNewStarts = (size_t *)realloc(oSymTable->scopeStarts,
+            sizeof(size_t) * uNewCapacity);
+        if (puNewStarts == NULL) return 0;
+        oSymTable->scopeStarts = puNewStarts;
+        oSymTable->scopeStartsCapacity = uNewCapacity;
+    }
+    oSymTable->numOfScopes++;
+    oSymTable->scopeStarts[oSymTable->numOfScopes] = oSymTable->numOfScopeLeaves;
+    return 1;
+}
+
+int SymTable_popScope(SymTable_T oSymTable){
+    struct HamtNode *psLogged;
+    struct HamtNode *psLeaf;
+    assert(oSymTable != NULL);
+
+    if (oSymTable->numOfScopes == 0) return 0;
+
+    /*removes the leaves of the scope newest first. A logged leaf may since have
+    been removed or replaced by a copy, so the visible leaf for its key is only
+    removed if it still belongs to this scope*/
+    while (oSymTable->numOfScopeLeaves > oSymTable->scopeStarts[oSymTable->numOfScopes]){
+        psLogged = oSymTable->scopeLeaves[oSymTable->numOfScopeLeaves - 1];
+        psLeaf = SymTable_locate(oSymTable->root, psLogged->hash, psLogged->key, 0);
+        if (psLeaf != NULL && SymTable_depth(psLeaf) == oSymTable->numOfScopes &&
+            !SymTable_removeLeaf(oSymTable, psLeaf, psLogged->hash))
+            return 0;
+        SymTable_release(psLogged);
+        oSymTable->numOfScopeLeaves--;
+    }
+    oSymTable->numOfScopes--;
+    return 1;
+}
+
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth){
+    struct HamtNode *psLeaf;
+    assert(oSymTable != NULL && pcKey != NULL && puDepth != NULL);
+
+    psLeaf = SymTable_locate(oSymTable->root, SymTable_hash(pcKey), pcKey, 0);
+    if (psLeaf == NULL) return NULL;
+    *puDepth = SymTable_depth(psLeaf);
+    return (void *)psLeaf->value;
+}
@@ -3,46 +3,298 @@
 /* Author: Milan Sastry                                               */
 /*--------------------------------------------------------------------*/
 
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <stddef.h>
 #include "symtable.h"
+#include "symtablebloom.h"
+#include "symtablehot.h"
+#include "symtablescope.h"
+
+/*building with -DSYMTABLE_HUGE_PAGES maps large bucket arrays, and the large
+blocks that bindings and heap keys are carved from, on huge pages where the
+system has them. Other builds allocate every binding on its own*/
+#if defined(__linux__) && defined(SYMTABLE_HUGE_PAGES)
+#include <sys/mman.h>
+#define SYMTABLE_MAPPED_MEMORY
+#endif
+
+/*bulk builds run on POSIX threads where the system has them, building with
+-DSYMTABLE_NO_THREADS builds on the calling thread*/
+#if defined(__unix__) && !defined(SYMTABLE_NO_THREADS)
+#include <pthread.h>
+#include <unistd.h>
+#define SYMTABLE_THREADS
+#endif
+
+/*building with -DSYMTABLE_EXPAND_THREADS=n rehashes large tables on n threads
+when they expand*/
+#if defined(SYMTABLE_THREADS) && defined(SYMTABLE_EXPAND_THREADS)
+#define SYMTABLE_PARALLEL_EXPAND
+#endif
 
 /* global variable that is the index of the last bucket count*/
-static const size_t LAST_BUCKET_COUNT_INDEX = 7;
+static const size_t LAST_BUCKET_COUNT_INDEX = 22;
 
 /*contains the specified bucket counts for expansion*/
-static const size_t auBucketCounts[] = {509, 1021, 2039, 4093, 8191, 16381, 32749, 65521};
+static const size_t auBucketCounts[] = {509, 1021, 2039, 4093, 8191, 16381,
+    32749, 65521, 131071, 262139, 524287, 1048573, 2097143, 4194301, 8388593,
+    16777213, 33554393, 67108859, 134217689, 268435399, 536870909, 1073741789,
+    2147483647};
+
+/*bytes in the first block of a key heap or binding pool, each later block is
+twice the size of the last up to MAX_CHUNK_SIZE*/
+static const size_t FIRST_CHUNK_SIZE = 4096;
+static const size_t MAX_CHUNK_SIZE = 1048576;
+
+#ifdef SYMTABLE_MAPPED_MEMORY
+/*size of a huge page, the unit mapped memory is rounded up to*/
+static const size_t HUGE_PAGE_SIZE = 2097152;
+
+/*bucket arrays and blocks of at least this many bytes are mapped instead of
+allocated, which bucket counts from 65521 up reach*/
+static const size_t MAPPED_THRESHOLD = 262144;
+#endif
+
+#ifdef SYMTABLE_PARALLEL_EXPAND
+/*number of threads that rehash a table as it expands*/
+enum {EXPAND_THREADS = SYMTABLE_EXPAND_THREADS};
+
+/*tables with fewer bindings than this expand on the calling thread, since
+starting threads would take longer than rehashing them*/
+static const size_t PARALLEL_EXPAND_THRESHOLD = 16384;
+#endif
+
+#ifdef SYMTABLE_BLOOM
+/*bytes in a block of the Bloom filter, one cache line*/
+enum {BLOOM_BLOCK_SIZE = 64};
+
+/*bits the filter is sized with per key it can hold*/
+static const size_t BLOOM_BITS_PER_KEY = 10;
+
+/*number of keys the first filter of a table is sized for*/
+static const size_t BLOOM_FIRST_CAPACITY = 512;
+
+/*odd multiplier close to 2^64 divided by the golden ratio, spreads the hash of
+a key over the bits that pick its block and its bits in the block*/
+static const unsigned long long BLOOM_MULTIPLIER = 11400714819323198485ULL;
+#endif
+
+#ifdef SYMTABLE_HOT_CACHE
+/*number of entries in the hot key cache of a table, a power of 2*/
+enum {HOT_CACHE_SIZE = 64};
+#endif
 
 /* Represents a binding in the symbol table*/
 struct Binding{
-    /*key of the binding that is a string */
+    /*key of the binding that is a string, owned by the table unless it
+    borrows keys*/
     const char *key;
 
-    /*value of the binding that is a void pointer*/
+    /*value of the binding that is a void pointer, or in an inline table a
+    pointer to the value stored after the binding*/
     const void *value;
     
     /*next binding in the bucket that the binding points to*/
     struct Binding *next;
 };
 
+/* Represents a block of the key heap or the binding pool of a symbol table.
+The keys or bindings carved from it are stored after it, one after another*/
+struct Chunk{
+    /*next block of the heap or pool*/
+    struct Chunk *next;
+
+    /*number of bytes for keys or bindings in the block*/
+    size_t size;
+
+    /*number of those bytes that hold keys or bindings*/
+    size_t used;
+
+#ifdef SYMTABLE_MAPPED_MEMORY
+    /*1 if the block was mapped on huge pages, 0 if it was allocated*/
+    int mapped;
+#endif
+};
+
+#ifdef SYMTABLE_HOT_CACHE
+/* Represents an entry of the hot key cache, a binding a lookup found*/
+struct HotEntry{
+    /*full hash code of the key of binding*/
+    size_t hash;
+
+    /*key of binding, compared without reading the binding*/
+    const char *key;
+
+    /*visible binding, NULL if the entry is empty*/
+    struct Binding *binding;
+};
+#endif
+
 /* Represents the symbol table */
 struct SymTable{
     /*number of buckets in the symbol table*/
     size_t numOfBuckets;
 
-    /*number of bindings, ranges from 0-8 corresponding with
+    /*number of bindings, ranges from 0-22 corresponding with
     index of auBucketCounts[]*/
     size_t numOfBindings;
 
     /*array of pointers to the first binding in each bucket*/
     struct Binding **buckets;
+
+    /*1 if buckets was mapped by SymTable_allocBuckets, 0 if it was allocated*/
+    int bucketsMapped;
+
+    /*open scopes, which know the depth of each binding put in an inner scope
+    and the binding it hides, which is in no bucket while it is hidden. NULL
+    until the first pushScope, so that bindings carry nothing for scopes*/
+    SymTableScopes_T scopes;
+
+    /*size of the values stored in the bindings, 0 if values are void pointers*/
+    size_t valueSize;
+
+    /*copy of the last value replaced or removed from an inline table*/
+    void *oldValue;
+
+    /*1 if the bindings point to the callers' keys instead of copies*/
+    int borrowedKeys;
+
+    /*1 if the keys are copied into keyChunks instead of allocated one by one*/
+    int keyHeap;
+
+    /*blocks of the key heap, the first being the one keys are copied into.
+    NULL if the table has no key heap or no key yet*/
+    struct Chunk *keyChunks;
+
+    /*emptied blocks of the key heap that SymTable_clear kept, which the heap
+    takes before allocating a block*/
+    struct Chunk *spareChunks;
+
+    /*bindings SymTable_clear took out, and in a build with binding pools
+    the bindings removed, linked through next, which put uses before
+    allocating. If the table copies its keys one by one each keeps the buffer
+    of its key, which still holds that key, so the buffer is at least as long
+    as the key*/
+    struct Binding *spareBindings;
+
+    /*blocks of the binding pool, the first being the one bindings are carved
+    from. NULL in a build without binding pools*/
+    struct Chunk *bindingChunks;
+
+#ifdef SYMTABLE_BLOOM
+    /*blocked Bloom filter of the visible keys, each key sets 4 bits in one
+    block, aligned to a cache line. NULL if it could not be allocated, in which
+    case every lookup walks its bucket*/
+    unsigned char *bloom;
+
+    /*memory allocated for bloom, which starts somewhere in it*/
+    void *bloomMemory;
+
+    /*base 2 logarithm of the number of blocks in bloom*/
+    unsigned bloomBits;
+
+    /*number of keys bloom was sized for, it is rebuilt larger beyond that*/
+    size_t bloomCapacity;
+
+    /*number of keys removed since bloom was built, whose bits are still set*/
+    size_t bloomStale;
+
+    /*lookups checked against bloom, lookups it rejected, and lookups it let
+    through whose key was not in the table*/
+    struct SymTableBloomStats bloomStats;
+#endif
+
+#ifdef SYMTABLE_HOT_CACHE
+    /*bindings found by recent lookups, each in the entry the low bits of its
+    hash code select. An entry is emptied when its binding is hidden or taken
+    out of its bucket, expansion moves no binding*/
+    struct HotEntry hot[HOT_CACHE_SIZE];
+
+    /*lookups that checked hot and lookups it answered*/
+    struct SymTableHotStats hotStats;
+#endif
 };
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-   inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+#ifdef SYMTABLE_PARALLEL_EXPAND
+/* Represents one thread of a parallel expansion. Each thread first takes a
+range of the old buckets, then a range of the new ones*/
+struct ExpandWorker{
+    /*table being expanded, which still has its old buckets*/
+    SymTable_T table;
+
+    /*new buckets and their number*/
+    struct Binding **newBuckets;
+    size_t newCount;
+
+    /*staged[t * EXPAND_THREADS + p] lists the bindings thread t took from its
+    old buckets that go to the new buckets of thread p, linked through next*/
+    struct Binding **staged;
+
+    /*index of the thread, which picks its ranges of buckets*/
+    size_t index;
+};
+#endif
+
+/* Represents a bulk build of a symbol table, shared by the threads doing it.
+The keys are split into as many partitions as there are threads, each a range
+of buckets, so that every thread links its own buckets*/
+struct Build{
+    /*table being built*/
+    SymTable_T table;
+
+    /*keys and values to bind, count of each*/
+    const char *const *keys;
+    const void *const *values;
+    size_t count;
+
+    /*number of threads, and of partitions*/
+    size_t threadCount;
+
+    /*keyBuckets[i] is the bucket of keys[i]*/
+    size_t *keyBuckets;
+
+    /*counts[t * threadCount + p] is the number of keys in the slice of thread
+    t that fall in partition p, then where the next of them goes in order*/
+    size_t *counts;
+
+    /*indices of the keys, grouped by partition and ascending in each*/
+    size_t *order;
+
+    /*partition p is order[partStarts[p]] up to order[partStarts[p + 1]]*/
+    size_t *partStarts;
+};
+
+/* Represents one thread of a bulk build*/
+struct BuildWorker{
+    /*build the thread works on*/
+    struct Build *build;
+
+    /*index of the thread, which is the slice of keys it hashes and the
+    partition it links*/
+    size_t index;
+
+    /*number of bindings the thread linked, and of keys it dropped because an
+    earlier index has the same key*/
+    size_t bound;
+    size_t duplicates;
+
+    /*1 if the thread ran out of memory*/
+    int failed;
+
+    /*blocks of the binding pool the thread carves its bindings from, which the
+    table takes once the threads are done. NULL in a build without binding
+    pools*/
+    struct Chunk *chunks;
+};
+
+/* Return a hash code for pcKey, before it is reduced to a bucket. */
+static size_t SymTable_fullHash(const char *pcKey)
 {
    const size_t HASH_MULTIPLIER = 65599;
    size_t u;
@@ -53,30 +305,282 @@ static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
    for (u = 0; pcKey[u] != '\0'; u++)
       uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
 
-   return uHash % uBucketCount;
+   return uHash;
+}
+
+/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
+   inclusive. */
+static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+{
+   return SymTable_fullHash(pcKey) % uBucketCount;
+}
+
+#ifdef SYMTABLE_MAPPED_MEMORY
+/*Returns uBytes rounded up to whole huge pages*/
+static size_t SymTable_hugeRound(size_t uBytes){
+    return (uBytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+/*Returns uBytes, a multiple of HUGE_PAGE_SIZE, of zero filled memory that
+starts on a huge page boundary and is advised to be on huge pages, or NULL if
+it could not be mapped*/
+static void *SymTable_mapHuge(size_t uBytes){
+    size_t uSkip;
+    char *pcMap;
+
+    /*maps an extra huge page so that the memory can start on a huge page
+    boundary, which transparent huge pages need, then unmaps the rest*/
+    pcMap = (char *)mmap(NULL, uBytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pcMap == (char *)MAP_FAILED) return NULL;
+    uSkip = (HUGE_PAGE_SIZE - (size_t)pcMap % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if (uSkip != 0)
+        munmap(pcMap, uSkip);
+    munmap(pcMap + uSkip + uBytes, HUGE_PAGE_SIZE - uSkip);
+#ifdef MADV_HUGEPAGE
+    madvise(pcMap + uSkip, uBytes, MADV_HUGEPAGE);
+#endif
+    return pcMap + uSkip;
+}
+#endif
+
+/*Returns an array of uCount NULL bucket pointers, and sets *piMapped to 1 if
+it was mapped on huge pages or to 0 if it was allocated. Returns NULL if
+insufficient memory*/
+static struct Binding **SymTable_allocBuckets(size_t uCount, int *piMapped){
+#ifdef SYMTABLE_MAPPED_MEMORY
+    size_t uBytes = uCount * sizeof(struct Binding *);
+    struct Binding **aBuckets;
+
+    if (uBytes >= MAPPED_THRESHOLD){
+        /*anonymous pages are zero filled, and NULL is all zero bits here*/
+        aBuckets = (struct Binding **)SymTable_mapHuge(SymTable_hugeRound(uBytes));
+        if (aBuckets != NULL){
+            *piMapped = 1;
+            return aBuckets;
+        }
+    }
+#endif
+    *piMapped = 0;
+    return (struct Binding **)calloc(uCount, sizeof(struct Binding *));
+}
+
+/*Frees the array of uCount bucket pointers aBuckets, which SymTable_allocBuckets
+returned with iMapped*/
+static void SymTable_freeBuckets(struct Binding **aBuckets, size_t uCount,
+    int iMapped){
+#ifdef SYMTABLE_MAPPED_MEMORY
+    if (iMapped){
+        munmap(aBuckets, SymTable_hugeRound(uCount * sizeof(struct Binding *)));
+        return;
+    }
+#else
+    (void)uCount;
+    (void)iMapped;
+#endif
+    free(aBuckets);
+}
+
+/*Returns an empty block of a key heap or binding pool with room for at least
+uSize bytes, mapped on huge pages if it is large. Returns NULL if insufficient
+memory*/
+static struct Chunk *SymTable_newChunk(size_t uSize){
+    struct Chunk *psChunk;
+#ifdef SYMTABLE_MAPPED_MEMORY
+    size_t uMapped;
+
+    if (sizeof(struct Chunk) + uSize >= MAPPED_THRESHOLD){
+        /*a mapped block takes all of its huge pages*/
+        uMapped = SymTable_hugeRound(sizeof(struct Chunk) + uSize);
+        psChunk = (struct Chunk *)SymTable_mapHuge(uMapped);
+        if (psChunk != NULL){
+            psChunk->size = uMapped - sizeof(struct Chunk);
+            psChunk->used = 0;
+            psChunk->mapped = 1;
+            return psChunk;
+        }
+    }
+#endif
+    psChunk = (struct Chunk *)malloc(sizeof(struct Chunk) + uSize);
+    if (psChunk == NULL) return NULL;
+    psChunk->size = uSize;
+    psChunk->used = 0;
+#ifdef SYMTABLE_MAPPED_MEMORY
+    psChunk->mapped = 0;
+#endif
+    return psChunk;
+}
+
+/*Frees psChunk, which SymTable_newChunk returned*/
+static void SymTable_freeChunk(struct Chunk *psChunk){
+#ifdef SYMTABLE_MAPPED_MEMORY
+    if (psChunk->mapped){
+        munmap(psChunk, sizeof(struct Chunk) + psChunk->size);
+        return;
+    }
+#endif
+    free(psChunk);
+}
+
+/*Returns uThreadCount, or the number of processors online if that is fewer,
+since more threads than processors would only take turns on them. Returns 1 if
+there are no threads*/
+static size_t SymTable_capThreads(size_t uThreadCount){
+#ifdef SYMTABLE_THREADS
+#ifdef _SC_NPROCESSORS_ONLN
+    long lOnline = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (lOnline > 0 && (unsigned long)lOnline < uThreadCount)
+        uThreadCount = (size_t)lOnline;
+#endif
+    return uThreadCount;
+#else
+    (void)uThreadCount;
+    return 1;
+#endif
+}
+
+/*Runs pfWork on each of the uCount workers of uWorkerSize bytes at pvWorkers
+at once, one of them on the calling thread, and returns once all are done. Runs
+a worker on the calling thread instead if its thread cannot be started*/
+static void SymTable_runWorkers(void *(*pfWork)(void *), void *pvWorkers,
+    size_t uWorkerSize, size_t uCount){
+    char *pcWorkers = (char *)pvWorkers;
+    size_t i;
+#ifdef SYMTABLE_THREADS
+    pthread_t *psThreads;
+    int *piStarted;
+
+    psThreads = (pthread_t *)malloc(sizeof(pthread_t) * uCount);
+    piStarted = (int *)calloc(uCount, sizeof(int));
+    if (psThreads != NULL && piStarted != NULL){
+        for (i = 1; i < uCount; i++)
+            piStarted[i] = pthread_create(&psThreads[i], NULL, pfWork,
+                pcWorkers + i * uWorkerSize) == 0;
+        for (i = 0; i < uCount; i++)
+            if (!piStarted[i])
+                (*pfWork)(pcWorkers + i * uWorkerSize);
+        for (i = 1; i < uCount; i++)
+            if (piStarted[i])
+                pthread_join(psThreads[i], NULL);
+        free(psThreads);
+        free(piStarted);
+        return;
+    }
+    free(psThreads);
+    free(piStarted);
+#endif
+    for (i = 0; i < uCount; i++)
+        (*pfWork)(pcWorkers + i * uWorkerSize);
 }
 
-/*Expands the oSymTable by increasing bucket number to next value in iteration and rehashing 
-all keys.*/
-static void SymTable_expand(SymTable_T oSymTable){
+#ifdef SYMTABLE_PARALLEL_EXPAND
+/*Moves every binding in the range of old buckets of the struct ExpandWorker
+pvWorker onto the staged list of the thread for the range of new buckets it
+hashes to. Returns NULL*/
+static void *SymTable_stageRange(void *pvWorker){
+    struct ExpandWorker *psWorker = (struct ExpandWorker *)pvWorker;
+    struct Binding **staged = psWorker->staged
+        + psWorker->index * EXPAND_THREADS;
+    size_t uOldCount = auBucketCounts[psWorker->table->numOfBuckets];
+    size_t uEnd = uOldCount * (psWorker->index + 1) / EXPAND_THREADS;
+    struct Binding *current;
+    struct Binding *next;
+    size_t hash;
+    size_t i;
+
+    for (i = uOldCount * psWorker->index / EXPAND_THREADS; i < uEnd; i++){
+        for (current = psWorker->table->buckets[i]; current != NULL; current = next){
+            next = current->next;
+            hash = SymTable_hash(current->key, psWorker->newCount);
+            current->next = staged[hash * EXPAND_THREADS / psWorker->newCount];
+            staged[hash * EXPAND_THREADS / psWorker->newCount] = current;
+        }
+    }
+    return NULL;
+}
+
+/*Links every binding that any thread staged for the range of new buckets of
+the struct ExpandWorker pvWorker into its bucket. No other thread touches
+these buckets, so no lock is taken. Returns NULL*/
+static void *SymTable_mergeRange(void *pvWorker){
+    struct ExpandWorker *psWorker = (struct ExpandWorker *)pvWorker;
+    struct Binding *current;
+    struct Binding *next;
+    size_t hash;
+    size_t t;
+
+    for (t = 0; t < EXPAND_THREADS; t++){
+        current = psWorker->staged[t * EXPAND_THREADS + psWorker->index];
+        for (; current != NULL; current = next){
+            next = current->next;
+            hash = SymTable_hash(current->key, psWorker->newCount);
+            current->next = psWorker->newBuckets[hash];
+            psWorker->newBuckets[hash] = current;
+        }
+    }
+    return NULL;
+}
+
+/*Rehashes every binding of oSymTable into the uNewCount buckets newBuckets on
+EXPAND_THREADS threads: each stages the bindings of a range of old buckets by
+the range of new buckets they go to, then each links the bindings staged for
+its range of new buckets. Returns 1 if successful, 0 if insufficient memory,
+in which case oSymTable is unchanged*/
+static int SymTable_rehashParallel(SymTable_T oSymTable,
+    struct Binding **newBuckets, size_t uNewCount){
+    struct ExpandWorker asWorkers[EXPAND_THREADS];
+    struct Binding **staged;
+    size_t t;
+
+    staged = (struct Binding **)calloc(EXPAND_THREADS * EXPAND_THREADS,
+        sizeof(struct Binding *));
+    if (staged == NULL) return 0;
+    for (t = 0; t < EXPAND_THREADS; t++){
+        asWorkers[t].table = oSymTable;
+        asWorkers[t].newBuckets = newBuckets;
+        asWorkers[t].newCount = uNewCount;
+        asWorkers[t].staged = staged;
+        asWorkers[t].index = t;
+    }
+    SymTable_runWorkers(SymTable_stageRange, asWorkers,
+        sizeof(struct ExpandWorker), EXPAND_THREADS);
+    SymTable_runWorkers(SymTable_mergeRange, asWorkers,
+        sizeof(struct ExpandWorker), EXPAND_THREADS);
+    free(staged);
+    return 1;
+}
+#endif
+
+/*Expands the oSymTable to auBucketCounts[uIndex] buckets, rehashing all keys.
+Leaves oSymTable unchanged if insufficient memory*/
+static void SymTable_expand(SymTable_T oSymTable, size_t uIndex){
     struct Binding* current;
     struct Binding* next;
     size_t i;
     size_t hash;
     struct Binding **newBuckets;
+    int newMapped;
+    int rehashed = 0;
     
-    newBuckets = (struct Binding **)calloc(auBucketCounts[oSymTable->numOfBuckets + 1],sizeof(struct Binding));
+    newBuckets = SymTable_allocBuckets(auBucketCounts[uIndex], &newMapped);
     /*checks whether to proceed with expansion, if memory was succesfully allocated for expanded array*/
     if (newBuckets == NULL)
         return;
     
+#ifdef SYMTABLE_PARALLEL_EXPAND
+    if (oSymTable->numOfBindings >= PARALLEL_EXPAND_THRESHOLD)
+        rehashed = SymTable_rehashParallel(oSymTable, newBuckets,
+            auBucketCounts[uIndex]);
+#endif
+
     /*Re hashes all bindings and puts them into new array*/
-    for (i = 0; i < auBucketCounts[oSymTable->numOfBuckets]; i++){
+    for (i = 0; !rehashed && i < auBucketCounts[oSymTable->numOfBuckets]; i++){
         
         current = oSymTable->buckets[i];
         while (current != NULL){
             struct Binding *temp;
-            hash = SymTable_hash(current->key,auBucketCounts[oSymTable->numOfBuckets + 1]);
+            hash = SymTable_hash(current->key,auBucketCounts[uIndex]);
             temp = newBuckets[hash];
             next = current->next;
             current->next = temp;
@@ -85,12 +589,755 @@ static void SymTable_expand(SymTable_T oSymTable){
         }
 
     } 
-    free(oSymTable->buckets);
+    SymTable_freeBuckets(oSymTable->buckets, auBucketCounts[oSymTable->numOfBuckets],
+        oSymTable->bucketsMapped);
     oSymTable->buckets = newBuckets;
-    oSymTable->numOfBuckets++;
+    oSymTable->bucketsMapped = newMapped;
+    oSymTable->numOfBuckets = uIndex;
     
 }
 
+#ifdef SYMTABLE_BLOOM
+/*Returns the block of the Bloom filter of oSymTable for the key with full hash
+uHash, and stores in auBits the 4 bits the key sets in it*/
+static unsigned char *SymTable_bloomBlock(SymTable_T oSymTable, size_t uHash,
+    size_t auBits[4]){
+    unsigned long long ullMixed = (unsigned long long)uHash * BLOOM_MULTIPLIER;
+    size_t uBlock = 0;
+    size_t i;
+
+    if (oSymTable->bloomBits != 0)
+        uBlock = (size_t)(ullMixed >> (64 - oSymTable->bloomBits));
+    ullMixed = (ullMixed ^ (ullMixed >> 29)) * BLOOM_MULTIPLIER;
+    for (i = 0; i < 4; i++)
+        auBits[i] = (size_t)(ullMixed >> (55 - 9 * i)) & (BLOOM_BLOCK_SIZE * 8 - 1);
+    return oSymTable->bloom + uBlock * BLOOM_BLOCK_SIZE;
+}
+
+/*Sets the bits of the key with full hash uHash in the Bloom filter of
+oSymTable*/
+static void SymTable_bloomAdd(SymTable_T oSymTable, size_t uHash){
+    unsigned char *pucBlock;
+    size_t auBits[4];
+    size_t i;
+
+    if (oSymTable->bloom == NULL) return;
+    pucBlock = SymTable_bloomBlock(oSymTable, uHash, auBits);
+    for (i = 0; i < 4; i++)
+        pucBlock[auBits[i] >> 3] |= (unsigned char)(1 << (auBits[i] & 7));
+}
+
+/*Replaces the Bloom filter of oSymTable with one sized for uCapacity keys that
+holds the visible keys of oSymTable, and returns 1. Returns 0 and keeps the old
+filter if insufficient memory*/
+static int SymTable_bloomRebuild(SymTable_T oSymTable, size_t uCapacity){
+    struct Binding *current;
+    void *pvMemory;
+    unsigned uBits = 0;
+    size_t uBytes;
+    size_t i;
+
+    while (((size_t)BLOOM_BLOCK_SIZE * 8 << uBits) < uCapacity * BLOOM_BITS_PER_KEY)
+        uBits++;
+    uBytes = (size_t)BLOOM_BLOCK_SIZE << uBits;
+    pvMemory = calloc(1, uBytes + BLOOM_BLOCK_SIZE - 1);
+    if (pvMemory == NULL) return 0;
+
+    free(oSymTable->bloomMemory);
+    oSymTable->bloomMemory = pvMemory;
+    oSymTable->bloom = (unsigned char *)pvMemory
+        + (BLOOM_BLOCK_SIZE - (size_t)pvMemory % BLOOM_BLOCK_SIZE) % BLOOM_BLOCK_SIZE;
+    oSymTable->bloomBits = uBits;
+    oSymTable->bloomCapacity = uCapacity;
+    oSymTable->bloomStale = 0;
+    for (i = 0; i < auBucketCounts[oSymTable->numOfBuckets]; i++)
+        for (current = oSymTable->buckets[i]; current != NULL; current = current->next)
+            SymTable_bloomAdd(oSymTable, SymTable_fullHash(current->key));
+    return 1;
+}
+
+/*Rebuilds the Bloom filter of oSymTable for uCapacity keys after bindings were
+linked into its buckets without being added to the filter. If that takes more
+memory than there is, the filter, which lacks those keys, is freed and the
+table goes without one*/
+static void SymTable_bloomRefill(SymTable_T oSymTable, size_t uCapacity){
+    if (SymTable_bloomRebuild(oSymTable, uCapacity)) return;
+    free(oSymTable->bloomMemory);
+    oSymTable->bloomMemory = NULL;
+    oSymTable->bloom = NULL;
+}
+
+/*Rebuilds the Bloom filter of oSymTable once it holds more keys than it was
+sized for, or once as many keys were removed from it as it was sized for. The
+old filter, which holds every key, is kept if insufficient memory*/
+static void SymTable_bloomCheck(SymTable_T oSymTable){
+    /*a table whose first filter could not be allocated goes without one*/
+    if (oSymTable->bloom == NULL) return;
+    if (oSymTable->numOfBindings > oSymTable->bloomCapacity)
+        SymTable_bloomRebuild(oSymTable, 2 * oSymTable->bloomCapacity);
+    else if (oSymTable->bloomStale > oSymTable->bloomCapacity / 2)
+        SymTable_bloomRebuild(oSymTable, oSymTable->bloomCapacity);
+}
+#endif
+
+/*Returns 0 if the key with full hash uHash is surely not in oSymTable, 1 if it
+may be. Without a Bloom filter every key may be*/
+static int SymTable_mayContain(SymTable_T oSymTable, size_t uHash){
+#ifdef SYMTABLE_BLOOM
+    unsigned char *pucBlock;
+    size_t auBits[4];
+    size_t i;
+
+    if (oSymTable->bloom == NULL) return 1;
+    oSymTable->bloomStats.lookups++;
+    pucBlock = SymTable_bloomBlock(oSymTable, uHash, auBits);
+    for (i = 0; i < 4; i++)
+        if ((pucBlock[auBits[i] >> 3] & (1 << (auBits[i] & 7))) == 0){
+            oSymTable->bloomStats.rejected++;
+            return 0;
+        }
+#else
+    (void)oSymTable;
+    (void)uHash;
+#endif
+    return 1;
+}
+
+/*Counts a lookup of oSymTable that the Bloom filter let through but that did
+not find its key*/
+static void SymTable_missed(SymTable_T oSymTable){
+#ifdef SYMTABLE_BLOOM
+    if (oSymTable->bloom != NULL)
+        oSymTable->bloomStats.falsePositives++;
+#else
+    (void)oSymTable;
+#endif
+}
+
+/*Returns the visible binding with pcKey, whose full hash is uHash, if the hot
+key cache of oSymTable holds it, or NULL. Without a cache it never does*/
+static struct Binding *SymTable_hotFind(SymTable_T oSymTable, const char *pcKey,
+    size_t uHash){
+#ifdef SYMTABLE_HOT_CACHE
+    struct HotEntry *psEntry = &oSymTable->hot[uHash & (HOT_CACHE_SIZE - 1)];
+
+    oSymTable->hotStats.lookups++;
+    if (psEntry->binding != NULL && psEntry->hash == uHash &&
+        strcmp(psEntry->key, pcKey) == 0){
+        oSymTable->hotStats.hits++;
+        return psEntry->binding;
+    }
+#else
+    (void)oSymTable;
+    (void)pcKey;
+    (void)uHash;
+#endif
+    return NULL;
+}
+
+/*Puts psBinding, a visible binding whose key has full hash uHash, in the hot
+key cache of oSymTable in place of the binding in its entry*/
+static void SymTable_hotKeep(SymTable_T oSymTable, struct Binding *psBinding,
+    size_t uHash){
+#ifdef SYMTABLE_HOT_CACHE
+    struct HotEntry *psEntry = &oSymTable->hot[uHash & (HOT_CACHE_SIZE - 1)];
+
+    psEntry->hash = uHash;
+    psEntry->key = psBinding->key;
+    psEntry->binding = psBinding;
+#else
+    (void)oSymTable;
+    (void)psBinding;
+    (void)uHash;
+#endif
+}
+
+/*Empties the entry of the hot key cache of oSymTable that holds psBinding,
+which is being hidden or taken out of its bucket, if there is one*/
+static void SymTable_hotForget(SymTable_T oSymTable, struct Binding *psBinding){
+#ifdef SYMTABLE_HOT_CACHE
+    struct HotEntry *psEntry;
+
+    psEntry = &oSymTable->hot[SymTable_fullHash(psBinding->key) &
+        (HOT_CACHE_SIZE - 1)];
+    if (psEntry->binding == psBinding)
+        psEntry->binding = NULL;
+#else
+    (void)oSymTable;
+    (void)psBinding;
+#endif
+}
+
+/*Empties every entry of the hot key cache of oSymTable*/
+static void SymTable_hotClear(SymTable_T oSymTable){
+#ifdef SYMTABLE_HOT_CACHE
+    size_t i;
+
+    for (i = 0; i < HOT_CACHE_SIZE; i++)
+        oSymTable->hot[i].binding = NULL;
+#else
+    (void)oSymTable;
+#endif
+}
+
+/*Copies the uValueSize bytes at pvValue, or zeros if pvValue is NULL, into
+the inline value pvDest*/
+static void SymTable_storeValue(size_t uValueSize, void *pvDest,
+    const void *pvValue){
+    if (pvValue != NULL)
+        memcpy(pvDest, pvValue, uValueSize);
+    else
+        memset(pvDest, 0, uValueSize);
+}
+
+/*Sets the value of psBinding, a binding of oSymTable being made, to pvValue,
+which an inline table stores after the binding*/
+static void SymTable_fillValue(SymTable_T oSymTable, struct Binding *psBinding,
+    const void *pvValue){
+    psBinding->value = pvValue;
+    if (oSymTable->valueSize != 0){
+        psBinding->value = psBinding + 1;
+        SymTable_storeValue(oSymTable->valueSize, psBinding + 1, pvValue);
+    }
+}
+
+#ifdef SYMTABLE_MAPPED_MEMORY
+/*Returns uBytes carved from the current block of the binding pool *ppsPool,
+rounded up so that what is carved next is aligned like a pointer, and adds a
+block to the pool if that one is too full. Returns NULL if insufficient memory*/
+static char *SymTable_carve(struct Chunk **ppsPool, size_t uBytes){
+    struct Chunk *psChunk = *ppsPool;
+    size_t uSize;
+    char *pcRoom;
+
+    uBytes = (uBytes + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+    if (psChunk == NULL || psChunk->size - psChunk->used < uBytes){
+        uSize = FIRST_CHUNK_SIZE;
+        if (psChunk != NULL && psChunk->size < MAX_CHUNK_SIZE)
+            uSize = 2 * psChunk->size;
+        else if (psChunk != NULL)
+            uSize = MAX_CHUNK_SIZE;
+        if (uSize < uBytes) uSize = uBytes;
+        psChunk = SymTable_newChunk(uSize);
+        if (psChunk == NULL) return NULL;
+        psChunk->next = *ppsPool;
+        *ppsPool = psChunk;
+    }
+    pcRoom = (char *)(psChunk + 1) + psChunk->used;
+    psChunk->used += uBytes;
+    return pcRoom;
+}
+#endif
+
+/*Takes out of the spare blocks of the key heap of oSymTable the first with
+room for uLength bytes and returns it, or NULL if there is none*/
+static struct Chunk *SymTable_takeChunk(SymTable_T oSymTable,
+    size_t uLength){
+    struct Chunk **link = &oSymTable->spareChunks;
+    struct Chunk *psChunk;
+
+    while (*link != NULL && (*link)->size < uLength)
+        link = &(*link)->next;
+    psChunk = *link;
+    if (psChunk != NULL)
+        *link = psChunk->next;
+    return psChunk;
+}
+
+/*Returns a copy of pcKey in the key heap of oSymTable, adding a block to the
+heap if the current one is full, a spare block if one has room. Returns NULL if
+insufficient memory*/
+static const char *SymTable_heapKey(SymTable_T oSymTable, const char *pcKey){
+    struct Chunk *psCurrent = oSymTable->keyChunks;
+    struct Chunk *psChunk = psCurrent;
+    size_t uLength = strlen(pcKey) + 1;
+    size_t uSize;
+    char *pcCopy;
+
+    if (psChunk == NULL || psChunk->size - psChunk->used < uLength){
+        psChunk = SymTable_takeChunk(oSymTable, uLength);
+        if (psChunk != NULL){
+            psChunk->next = oSymTable->keyChunks;
+            oSymTable->keyChunks = psChunk;
+            pcCopy = (char *)(psChunk + 1);
+            psChunk->used = uLength;
+            return strcpy(pcCopy, pcKey);
+        }
+
+        /*the new block is twice the size of the current one*/
+        uSize = FIRST_CHUNK_SIZE;
+        if (psCurrent != NULL && psCurrent->size < MAX_CHUNK_SIZE)
+            uSize = 2 * psCurrent->size;
+        else if (psCurrent != NULL)
+            uSize = MAX_CHUNK_SIZE;
+        if (uSize < uLength) uSize = uLength;
+        psChunk = SymTable_newChunk(uSize);
+        if (psChunk == NULL) return NULL;
+
+        /*a block made for one long key goes behind the current block, which
+        keeps filling up*/
+        if (uSize == uLength && oSymTable->keyChunks != NULL){
+            psChunk->next = oSymTable->keyChunks->next;
+            oSymTable->keyChunks->next = psChunk;
+        }
+        else{
+            psChunk->next = oSymTable->keyChunks;
+            oSymTable->keyChunks = psChunk;
+        }
+    }
+    pcCopy = (char *)(psChunk + 1) + psChunk->used;
+    psChunk->used += uLength;
+    return strcpy(pcCopy, pcKey);
+}
+
+/*Empties every block of the key heap of oSymTable and keeps it as a spare
+block*/
+static void SymTable_emptyKeyHeap(SymTable_T oSymTable){
+    struct Chunk *psChunk;
+
+    while (oSymTable->keyChunks != NULL){
+        psChunk = oSymTable->keyChunks;
+        oSymTable->keyChunks = psChunk->next;
+        psChunk->used = 0;
+        psChunk->next = oSymTable->spareChunks;
+        oSymTable->spareChunks = psChunk;
+    }
+}
+
+/*Moves the blocks *ppsSource of a key heap or binding pool behind the current
+block of *ppsDest, so that the current block keeps filling up*/
+static void SymTable_adoptChunks(struct Chunk **ppsDest,
+    struct Chunk **ppsSource){
+    struct Chunk *last;
+
+    if (*ppsSource == NULL) return;
+    if (*ppsDest == NULL)
+        *ppsDest = *ppsSource;
+    else{
+        last = *ppsSource;
+        while (last->next != NULL)
+            last = last->next;
+        last->next = (*ppsDest)->next;
+        (*ppsDest)->next = *ppsSource;
+    }
+    *ppsSource = NULL;
+}
+
+/*Frees every block of the key heap of oSymTable, spare or not*/
+static void SymTable_freeKeyHeap(SymTable_T oSymTable){
+    struct Chunk *psChunk;
+    struct Chunk *psNext;
+
+    SymTable_emptyKeyHeap(oSymTable);
+    for (psChunk = oSymTable->spareChunks; psChunk != NULL; psChunk = psNext){
+        psNext = psChunk->next;
+        SymTable_freeChunk(psChunk);
+    }
+    oSymTable->spareChunks = NULL;
+}
+
+/*Returns the key to store for pcKey in oSymTable, which is pcKey itself if
+oSymTable borrows keys and a copy of it otherwise, in its key heap if it has
+one. Returns NULL if insufficient
+memory*/
+static const char *SymTable_keepKey(SymTable_T oSymTable, const char *pcKey){
+    char *pcCopy;
+
+    if (oSymTable->borrowedKeys) return pcKey;
+    if (oSymTable->keyHeap) return SymTable_heapKey(oSymTable, pcKey);
+    pcCopy = (char *)malloc(strlen(pcKey) + 1);
+    if (pcCopy == NULL) return NULL;
+    return strcpy(pcCopy, pcKey);
+}
+
+/*Frees the key pcKey of a binding of oSymTable unless oSymTable borrows keys or
+keeps them in its key heap, which frees them all at once. In a build with
+binding pools a key copied on its own is in the pool, which frees it*/
+static void SymTable_dropKey(SymTable_T oSymTable, const char *pcKey){
+#ifdef SYMTABLE_MAPPED_MEMORY
+    (void)oSymTable;
+    (void)pcKey;
+#else
+    if (!oSymTable->borrowedKeys && !oSymTable->keyHeap)
+        free((void *)pcKey);
+#endif
+}
+
+/*Keeps psBinding of oSymTable, which is in no bucket or scope, as a spare
+binding with its key buffer if the key was allocated for it*/
+static void SymTable_spare(SymTable_T oSymTable, struct Binding *psBinding){
+    psBinding->next = oSymTable->spareBindings;
+    oSymTable->spareBindings = psBinding;
+}
+
+/*Returns a binding of oSymTable that is in no bucket, with the key to store
+for pcKey and pvValue as its value. In a build with binding pools it is carved
+from the pool *ppsPool, with right after it the copy of its key if the table
+copies keys one by one, so that a lookup reads both from one page. Otherwise it
+is allocated and ppsPool is unused. Returns NULL if insufficient memory*/
+static struct Binding *SymTable_newBinding(SymTable_T oSymTable,
+    struct Chunk **ppsPool, const char *pcKey, const void *pvValue){
+    struct Binding *newBinding;
+#ifdef SYMTABLE_MAPPED_MEMORY
+    size_t uSize = sizeof(struct Binding) + oSymTable->valueSize;
+    size_t uLength = 0;
+
+    if (!oSymTable->borrowedKeys && !oSymTable->keyHeap)
+        uLength = strlen(pcKey) + 1;
+    newBinding = (struct Binding *)SymTable_carve(ppsPool, uSize + uLength);
+    if (newBinding == NULL) return NULL;
+    if (uLength != 0)
+        newBinding->key = strcpy((char *)newBinding + uSize, pcKey);
+    else{
+        newBinding->key = SymTable_keepKey(oSymTable, pcKey);
+        if (newBinding->key == NULL) return NULL;
+    }
+#else
+    (void)ppsPool;
+    newBinding = (struct Binding*)malloc(sizeof(struct Binding)
+        + oSymTable->valueSize);
+    if (newBinding == NULL) return NULL;
+    newBinding->key = SymTable_keepKey(oSymTable, pcKey);
+    if (newBinding->key == NULL){
+        free(newBinding);
+        return NULL;
+    }
+#endif
+    SymTable_fillValue(oSymTable, newBinding, pvValue);
+    return newBinding;
+}
+
+/*Frees psBinding of oSymTable, which is in no bucket or scope and whose key
+was dropped. In a build with binding pools it is kept as a spare binding
+instead, with the buffer of its key*/
+static void SymTable_freeBinding(SymTable_T oSymTable,
+    struct Binding *psBinding){
+#ifdef SYMTABLE_MAPPED_MEMORY
+    SymTable_spare(oSymTable, psBinding);
+#else
+    (void)oSymTable;
+    free(psBinding);
+#endif
+}
+
+/*Returns a binding of oSymTable with pcKey and pvValue that is in no bucket,
+taking a spare binding and its key buffer if there is one. Returns NULL if
+insufficient memory*/
+static struct Binding *SymTable_takeBinding(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue){
+    struct Binding *newBinding = oSymTable->spareBindings;
+    size_t uLength;
+    char *pcCopy;
+
+    if (newBinding == NULL)
+        return SymTable_newBinding(oSymTable, &oSymTable->bindingChunks, pcKey,
+            pvValue);
+
+    if (oSymTable->borrowedKeys || oSymTable->keyHeap){
+        newBinding->key = SymTable_keepKey(oSymTable, pcKey);
+        if (newBinding->key == NULL) return NULL;
+    }
+    else{
+        /*the buffer still holds the key it was allocated for, so it has room
+        for a key as long*/
+        uLength = strlen(pcKey) + 1;
+        if (strlen(newBinding->key) + 1 < uLength){
+#ifdef SYMTABLE_MAPPED_MEMORY
+            /*the buffer outgrown stays in the binding pool*/
+            pcCopy = SymTable_carve(&oSymTable->bindingChunks, uLength);
+            if (pcCopy == NULL) return NULL;
+#else
+            pcCopy = (char *)malloc(uLength);
+            if (pcCopy == NULL) return NULL;
+            free((void *)newBinding->key);
+#endif
+            newBinding->key = pcCopy;
+        }
+        strcpy((char *)newBinding->key, pcKey);
+    }
+    oSymTable->spareBindings = newBinding->next;
+    SymTable_fillValue(oSymTable, newBinding, pvValue);
+    return newBinding;
+}
+
+/*Returns the value pvValue of a binding of oSymTable that is being replaced or
+removed, saving a copy of it first if oSymTable is inline*/
+static void *SymTable_oldValue(SymTable_T oSymTable, const void *pvValue){
+    if (oSymTable->valueSize == 0) return (void *)pvValue;
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/*Returns the address of the pointer to the visible binding with pcKey in
+bucket hash of oSymTable, or of the NULL pointer that ends the bucket if there
+is none*/
+static struct Binding **SymTable_link(SymTable_T oSymTable, const char *pcKey,
+    size_t hash){
+    struct Binding **link;
+
+    link = &oSymTable->buckets[hash];
+    while (*link != NULL && strcmp((*link)->key, pcKey) != 0)
+        link = &(*link)->next;
+    return link;
+}
+
+/*Returns the visible binding with pcKey in oSymTable, or NULL if there is
+none, asking the hot key cache and the Bloom filter first where the table has
+them*/
+static struct Binding *SymTable_lookup(SymTable_T oSymTable, const char *pcKey){
+    struct Binding *current;
+    size_t hash;
+
+    hash = SymTable_fullHash(pcKey);
+    current = SymTable_hotFind(oSymTable, pcKey, hash);
+    if (current != NULL) return current;
+    if (!SymTable_mayContain(oSymTable, hash)) return NULL;
+    current = *SymTable_link(oSymTable, pcKey,
+        hash % auBucketCounts[oSymTable->numOfBuckets]);
+    if (current == NULL){
+        SymTable_missed(oSymTable);
+        return NULL;
+    }
+    SymTable_hotKeep(oSymTable, current, hash);
+    return current;
+}
+
+/*Takes the visible binding *link out of its bucket and its scope in
+oSymTable, putting the binding it shadows back in its place*/
+static void SymTable_unlink(SymTable_T oSymTable, struct Binding **link){
+    struct Binding *current = *link;
+    struct Binding *shadowed;
+
+    SymTable_hotForget(oSymTable, current);
+
+    shadowed = (struct Binding *)SymTableScopes_remove(oSymTable->scopes,
+        current);
+    if (shadowed != NULL){
+        shadowed->next = current->next;
+        *link = shadowed;
+    }
+    else{
+        *link = current->next;
+        oSymTable->numOfBindings--;
+#ifdef SYMTABLE_BLOOM
+        oSymTable->bloomStale++;
+#endif
+    }
+}
+
+/*Removes the visible binding *link from oSymTable and returns its value*/
+static void *SymTable_removeLink(SymTable_T oSymTable, struct Binding **link){
+    struct Binding *current = *link;
+    const void *temp;
+
+    SymTable_unlink(oSymTable, link);
+    temp = SymTable_oldValue(oSymTable, current->value);
+    SymTable_dropKey(oSymTable, current->key);
+    SymTable_freeBinding(oSymTable, current);
+    return (void *)temp;
+}
+
+/*Sets the value of psBinding of oSymTable to pvValue and returns the old one*/
+static void *SymTable_setValue(SymTable_T oSymTable, struct Binding *psBinding,
+    const void *pvValue){
+    const void *temp;
+
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, psBinding->value);
+        SymTable_storeValue(oSymTable->valueSize, (void *)psBinding->value, pvValue);
+        return (void *)temp;
+    }
+    temp = psBinding->value;
+    psBinding->value = pvValue;
+    return (void *)temp;
+}
+
+/*Adds newBinding, whose key has the full hash code uFullHash, to the innermost
+scope of oSymTable. link is the address of the pointer to the visible binding
+with its key, which newBinding hides, or NULL if there is none. Unless the
+innermost scope is the outermost, room for newBinding must have been reserved
+in the scopes of oSymTable*/
+static void SymTable_bind(SymTable_T oSymTable, struct Binding *newBinding,
+    struct Binding **link, size_t uFullHash){
+    struct Binding *shadowed = (link != NULL) ? *link : NULL;
+    size_t uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    size_t hash;
+
+    /*a binding that shadows another takes its place in the bucket*/
+    if (shadowed != NULL){
+        SymTable_hotForget(oSymTable, shadowed);
+        newBinding->next = shadowed->next;
+        *link = newBinding;
+    }
+    else{
+        hash = uFullHash % auBucketCounts[oSymTable->numOfBuckets];
+        newBinding->next = oSymTable->buckets[hash];
+        oSymTable->buckets[hash] = newBinding;
+        oSymTable->numOfBindings++;
+#ifdef SYMTABLE_BLOOM
+        SymTable_bloomAdd(oSymTable, uFullHash);
+        SymTable_bloomCheck(oSymTable);
+#endif
+    }
+
+    if (uDepth > 0)
+        SymTableScopes_add(oSymTable->scopes, newBinding, uDepth, shadowed);
+}
+
+/*Sets the value *ppvValue of the binding of oSymTable with pcKey, which a merge
+also brings the value pvIncoming for, as ePolicy says*/
+static void SymTable_resolve(SymTable_T oSymTable, const char *pcKey,
+    const void **ppvValue, const void *pvIncoming,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    const void *pvValue = pvIncoming;
+
+    if (ePolicy == SYMTABLE_KEEP_EXISTING) return;
+    if (ePolicy == SYMTABLE_RESOLVE)
+        pvValue = (*pfResolve)(pcKey, (void *)*ppvValue, (void *)pvIncoming,
+            (void *)pvExtra);
+    if (oSymTable->valueSize == 0)
+        *ppvValue = pvValue;
+    else if (pvValue != *ppvValue)
+        SymTable_storeValue(oSymTable->valueSize, (void *)*ppvValue, pvValue);
+}
+
+/*Frees psBinding of oSymTable and every binding it shadows, taking them out of
+their scopes*/
+static void SymTable_freeStack(SymTable_T oSymTable, struct Binding *psBinding){
+    struct Binding *shadowed;
+
+    while (psBinding != NULL){
+        shadowed = (struct Binding *)SymTableScopes_remove(oSymTable->scopes,
+            psBinding);
+        SymTable_dropKey(oSymTable, psBinding->key);
+        SymTable_freeBinding(oSymTable, psBinding);
+        psBinding = shadowed;
+    }
+}
+
+/*Returns a copy for oClone of psBinding of oSymTable, putting the copy and a
+copy of every binding psBinding shadows in the same scopes of oClone, which
+are open. Returns NULL if insufficient memory*/
+static struct Binding *SymTable_copyStack(SymTable_T oClone,
+    SymTable_T oSymTable, const struct Binding *psBinding){
+    struct Binding *shadowed = NULL;
+    struct Binding *newBinding;
+    const struct Binding *psShadowed;
+    size_t uDepth;
+
+    /*the bindings it shadows are copied first, so the copy can hide theirs*/
+    psShadowed = (const struct Binding *)SymTableScopes_shadowed(
+        oSymTable->scopes, psBinding);
+    if (psShadowed != NULL){
+        shadowed = SymTable_copyStack(oClone, oSymTable, psShadowed);
+        if (shadowed == NULL) return NULL;
+    }
+
+    uDepth = SymTableScopes_depthOf(oSymTable->scopes, psBinding);
+    if (uDepth > 0 && !SymTableScopes_reserve(oClone->scopes, 1)){
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    newBinding = SymTable_newBinding(oClone, &oClone->bindingChunks,
+        psBinding->key, psBinding->value);
+    if (newBinding == NULL){
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    newBinding->next = NULL;
+    if (uDepth > 0)
+        SymTableScopes_add(oClone->scopes, newBinding, uDepth, shadowed);
+    return newBinding;
+}
+
+/*Returns the partition of psBuild that holds bucket uBucket*/
+static size_t SymTable_partition(const struct Build *psBuild, size_t uBucket){
+    return uBucket * psBuild->threadCount
+        / auBucketCounts[psBuild->table->numOfBuckets];
+}
+
+/*Returns the first index of the slice of keys of thread uThread in psBuild,
+which ends where the slice of the next thread starts*/
+static size_t SymTable_sliceStart(const struct Build *psBuild, size_t uThread){
+    return psBuild->count / psBuild->threadCount * uThread
+        + psBuild->count % psBuild->threadCount * uThread / psBuild->threadCount;
+}
+
+/*Finds the bucket of every key in the slice of the struct BuildWorker
+pvWorker and counts the keys of each partition. Returns NULL*/
+static void *SymTable_hashSlice(void *pvWorker){
+    struct BuildWorker *psWorker = (struct BuildWorker *)pvWorker;
+    struct Build *psBuild = psWorker->build;
+    size_t *puCounts = psBuild->counts + psWorker->index * psBuild->threadCount;
+    size_t uEnd = SymTable_sliceStart(psBuild, psWorker->index + 1);
+    size_t uBucketCount = auBucketCounts[psBuild->table->numOfBuckets];
+    size_t i;
+
+    for (i = SymTable_sliceStart(psBuild, psWorker->index); i < uEnd; i++){
+        psBuild->keyBuckets[i] = SymTable_hash(psBuild->keys[i], uBucketCount);
+        puCounts[SymTable_partition(psBuild, psBuild->keyBuckets[i])]++;
+    }
+    return NULL;
+}
+
+/*Writes the index of every key in the slice of the struct BuildWorker
+pvWorker into the order of the build, at the place its partition has for the
+slice. Returns NULL*/
+static void *SymTable_scatterSlice(void *pvWorker){
+    struct BuildWorker *psWorker = (struct BuildWorker *)pvWorker;
+    struct Build *psBuild = psWorker->build;
+    size_t *puNext = psBuild->counts + psWorker->index * psBuild->threadCount;
+    size_t uEnd = SymTable_sliceStart(psBuild, psWorker->index + 1);
+    size_t i;
+
+    for (i = SymTable_sliceStart(psBuild, psWorker->index); i < uEnd; i++)
+        psBuild->order[puNext[SymTable_partition(psBuild, psBuild->keyBuckets[i])]++] = i;
+    return NULL;
+}
+
+/*Links a binding for every key in the partition of the struct BuildWorker
+pvWorker into its bucket, taking the keys in the order given and dropping
+those already in their bucket. No other thread touches these buckets, so no
+lock is taken. Returns NULL*/
+static void *SymTable_linkPartition(void *pvWorker){
+    struct BuildWorker *psWorker = (struct BuildWorker *)pvWorker;
+    struct Build *psBuild = psWorker->build;
+    SymTable_T oSymTable = psBuild->table;
+    struct Binding *newBinding;
+    size_t uEnd = psBuild->partStarts[psWorker->index + 1];
+    size_t uBound = 0;
+    size_t uDuplicates = 0;
+    size_t i;
+    size_t k;
+    size_t hash;
+
+    for (k = psBuild->partStarts[psWorker->index]; k < uEnd; k++){
+        i = psBuild->order[k];
+        hash = psBuild->keyBuckets[i];
+        if (*SymTable_link(oSymTable, psBuild->keys[i], hash) != NULL){
+            uDuplicates++;
+            continue;
+        }
+        newBinding = SymTable_newBinding(oSymTable, &psWorker->chunks,
+            psBuild->keys[i], psBuild->values[i]);
+        if (newBinding == NULL){
+            psWorker->failed = 1;
+            break;
+        }
+        newBinding->next = oSymTable->buckets[hash];
+        oSymTable->buckets[hash] = newBinding;
+        uBound++;
+    }
+
+    /*counted locally, since the workers of all threads share cache lines*/
+    psWorker->bound = uBound;
+    psWorker->duplicates = uDuplicates;
+    return NULL;
+}
+
 SymTable_T SymTable_new(void){
     SymTable_T oSymTable;
     size_t i;
@@ -104,14 +1351,248 @@ SymTable_T SymTable_new(void){
         oSymTable->buckets[i] = NULL;
     }
 
+    oSymTable->bucketsMapped = 0;
     oSymTable->numOfBindings = 0;
     oSymTable->numOfBuckets = 0;
+    oSymTable->scopes = NULL;
+    oSymTable->valueSize = 0;
+    oSymTable->oldValue = NULL;
+    oSymTable->borrowedKeys = 0;
+    oSymTable->keyHeap = 0;
+    oSymTable->keyChunks = NULL;
+    oSymTable->spareChunks = NULL;
+    oSymTable->spareBindings = NULL;
+    oSymTable->bindingChunks = NULL;
+#ifdef SYMTABLE_BLOOM
+    oSymTable->bloom = NULL;
+    oSymTable->bloomMemory = NULL;
+    oSymTable->bloomBits = 0;
+    oSymTable->bloomCapacity = 0;
+    oSymTable->bloomStale = 0;
+    oSymTable->bloomStats.lookups = 0;
+    oSymTable->bloomStats.rejected = 0;
+    oSymTable->bloomStats.falsePositives = 0;
+    SymTable_bloomRebuild(oSymTable, BLOOM_FIRST_CAPACITY);
+#endif
+#ifdef SYMTABLE_HOT_CACHE
+    oSymTable->hotStats.lookups = 0;
+    oSymTable->hotStats.hits = 0;
+#endif
+    SymTable_hotClear(oSymTable);
+    return oSymTable;
+}
+
+SymTable_T SymTable_newBorrowedKeys(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->borrowedKeys = 1;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newKeyHeap(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->keyHeap = 1;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize){
+    SymTable_T oSymTable;
+    assert(uValueSize > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->oldValue = malloc(uValueSize);
+    if (oSymTable->oldValue == NULL){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    oSymTable->valueSize = uValueSize;
+    return oSymTable;
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable){
+    SymTable_T oClone;
+    struct Binding *current;
+    struct Binding *copy;
+    struct Binding **last;
+    size_t uDepth;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize != 0)
+        oClone = SymTable_newInline(oSymTable->valueSize);
+    else
+        oClone = SymTable_new();
+    if (oClone == NULL) return NULL;
+    oClone->borrowedKeys = oSymTable->borrowedKeys;
+    oClone->keyHeap = oSymTable->keyHeap;
+
+    /*gives the clone the same bucket count so that no binding is rehashed*/
+    if (oSymTable->numOfBuckets != 0){
+        free(oClone->buckets);
+        oClone->buckets = SymTable_allocBuckets(auBucketCounts[oSymTable->numOfBuckets],
+            &oClone->bucketsMapped);
+        if (oClone->buckets == NULL){
+            free(oClone->oldValue);
+#ifdef SYMTABLE_BLOOM
+            free(oClone->bloomMemory);
+#endif
+            free(oClone);
+            return NULL;
+        }
+        oClone->numOfBuckets = oSymTable->numOfBuckets;
+    }
+
+    /*gives the clone the same open scopes*/
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (uDepth != 0){
+        oClone->scopes = SymTableScopes_new();
+        if (oClone->scopes == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        for (i = 0; i < uDepth; i++){
+            if (!SymTableScopes_push(oClone->scopes)){
+                SymTable_free(oClone);
+                return NULL;
+            }
+        }
+    }
+
+    /*copies every chain in order, with the bindings each binding shadows*/
+    for (i = 0; i < auBucketCounts[oSymTable->numOfBuckets]; i++){
+        last = &oClone->buckets[i];
+        for (current = oSymTable->buckets[i]; current != NULL; current = current->next){
+            copy = SymTable_copyStack(oClone, oSymTable, current);
+            if (copy == NULL){
+                SymTable_free(oClone);
+                return NULL;
+            }
+            *last = copy;
+            last = &copy->next;
+            oClone->numOfBindings++;
+        }
+    }
+#ifdef SYMTABLE_BLOOM
+    SymTable_bloomRefill(oClone, oSymTable->bloomCapacity);
+#endif
+    return oClone;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates){
+    SymTable_T oSymTable;
+    struct Build sBuild;
+    struct BuildWorker *asWorkers;
+    size_t uNext = 0;
+    size_t uDuplicates = 0;
+    size_t uCountInPart;
+    size_t t;
+    size_t p;
+    int iFailed = 0;
+#ifdef SYMTABLE_BLOOM
+    size_t uCapacity;
+#endif
+    assert(ppcKeys != NULL && ppvValues != NULL && uThreadCount > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+
+    /*sizes the buckets for every key up front so that none is rehashed*/
+    if (!SymTable_presize(oSymTable, uCount)){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    uThreadCount = SymTable_capThreads(uThreadCount);
+    if (uThreadCount > uCount)
+        uThreadCount = (uCount == 0) ? 1 : uCount;
+    sBuild.table = oSymTable;
+    sBuild.keys = ppcKeys;
+    sBuild.values = ppvValues;
+    sBuild.count = uCount;
+    sBuild.threadCount = uThreadCount;
+    sBuild.keyBuckets = (size_t *)malloc(sizeof(size_t) * (uCount + 1));
+    sBuild.order = (size_t *)malloc(sizeof(size_t) * (uCount + 1));
+    sBuild.counts = (size_t *)calloc(uThreadCount * uThreadCount, sizeof(size_t));
+    sBuild.partStarts = (size_t *)malloc(sizeof(size_t) * (uThreadCount + 1));
+    asWorkers = (struct BuildWorker *)malloc(sizeof(struct BuildWorker)
+        * uThreadCount);
+    if (sBuild.keyBuckets == NULL || sBuild.order == NULL || sBuild.counts == NULL
+        || sBuild.partStarts == NULL || asWorkers == NULL)
+        iFailed = 1;
+
+    if (!iFailed){
+        for (t = 0; t < uThreadCount; t++){
+            asWorkers[t].build = &sBuild;
+            asWorkers[t].index = t;
+            asWorkers[t].bound = 0;
+            asWorkers[t].duplicates = 0;
+            asWorkers[t].failed = 0;
+            asWorkers[t].chunks = NULL;
+        }
+        SymTable_runWorkers(SymTable_hashSlice, asWorkers,
+            sizeof(struct BuildWorker), uThreadCount);
+
+        /*lays the partitions out one after another, and in each the slices
+        of the threads in order, so that every partition lists its keys in
+        the order they were given and the first of equal keys is kept*/
+        for (p = 0; p < uThreadCount; p++){
+            sBuild.partStarts[p] = uNext;
+            for (t = 0; t < uThreadCount; t++){
+                uCountInPart = sBuild.counts[t * uThreadCount + p];
+                sBuild.counts[t * uThreadCount + p] = uNext;
+                uNext += uCountInPart;
+            }
+        }
+        sBuild.partStarts[uThreadCount] = uNext;
+        SymTable_runWorkers(SymTable_scatterSlice, asWorkers,
+            sizeof(struct BuildWorker), uThreadCount);
+        SymTable_runWorkers(SymTable_linkPartition, asWorkers,
+            sizeof(struct BuildWorker), uThreadCount);
+
+        for (t = 0; t < uThreadCount; t++){
+            oSymTable->numOfBindings += asWorkers[t].bound;
+            uDuplicates += asWorkers[t].duplicates;
+            if (asWorkers[t].failed) iFailed = 1;
+            SymTable_adoptChunks(&oSymTable->bindingChunks,
+                &asWorkers[t].chunks);
+        }
+    }
+
+    free(sBuild.keyBuckets);
+    free(sBuild.order);
+    free(sBuild.counts);
+    free(sBuild.partStarts);
+    free(asWorkers);
+    if (iFailed){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+#ifdef SYMTABLE_BLOOM
+    uCapacity = oSymTable->bloomCapacity;
+    while (uCapacity < oSymTable->numOfBindings)
+        uCapacity *= 2;
+    SymTable_bloomRefill(oSymTable, uCapacity);
+#endif
+    if (puDuplicates != NULL)
+        *puDuplicates = uDuplicates;
     return oSymTable;
 }
 
 void SymTable_free(SymTable_T oSymTable){
     struct Binding *current;
     struct Binding *next;
+#ifdef SYMTABLE_MAPPED_MEMORY
+    struct Chunk *psChunk;
+    struct Chunk *psNext;
+#endif
     size_t i;
     assert(oSymTable != NULL);
     for (i = 0; i < auBucketCounts[oSymTable->numOfBuckets]; i++){
@@ -119,129 +1600,313 @@ void SymTable_free(SymTable_T oSymTable){
             current = oSymTable->buckets[i];
             while (current != NULL){
                 next = current->next;
-                free((void *)current->key);
-                free(current);
+                SymTable_freeStack(oSymTable, current);
                 current = next;
             }
         }
     }
-    free(oSymTable->buckets);
+#ifdef SYMTABLE_MAPPED_MEMORY
+    /*the binding pool frees its bindings, spare or not, with its blocks*/
+    for (psChunk = oSymTable->bindingChunks; psChunk != NULL; psChunk = psNext){
+        psNext = psChunk->next;
+        SymTable_freeChunk(psChunk);
+    }
+#else
+    for (current = oSymTable->spareBindings; current != NULL; current = next){
+        next = current->next;
+        SymTable_dropKey(oSymTable, current->key);
+        free(current);
+    }
+#endif
+    SymTable_freeKeyHeap(oSymTable);
+    SymTable_freeBuckets(oSymTable->buckets, auBucketCounts[oSymTable->numOfBuckets],
+        oSymTable->bucketsMapped);
+    SymTableScopes_free(oSymTable->scopes);
+    free(oSymTable->oldValue);
+#ifdef SYMTABLE_BLOOM
+    free(oSymTable->bloomMemory);
+#endif
     free(oSymTable);
 }
 
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue)){
+    struct Binding *current;
+    struct Binding *next;
+    struct Binding *shadowed;
+    size_t i;
+    assert(oSymTable != NULL);
+
+    /*keeps the buckets at their size, so that the next fill does not expand*/
+    for (i = 0; i < auBucketCounts[oSymTable->numOfBuckets]; i++){
+        current = oSymTable->buckets[i];
+        while (current != NULL){
+            next = current->next;
+            for (; current != NULL; current = shadowed){
+                shadowed = (struct Binding *)SymTableScopes_shadowed(
+                    oSymTable->scopes, current);
+                if (pfFreeValue != NULL)
+                    (*pfFreeValue)((void *)current->value);
+                SymTable_spare(oSymTable, current);
+            }
+            current = next;
+        }
+        oSymTable->buckets[i] = NULL;
+    }
+    oSymTable->numOfBindings = 0;
+    SymTableScopes_clear(oSymTable->scopes);
+    SymTable_emptyKeyHeap(oSymTable);
+    SymTable_hotClear(oSymTable);
+#ifdef SYMTABLE_BLOOM
+    if (oSymTable->bloom != NULL)
+        memset(oSymTable->bloom, 0, (size_t)BLOOM_BLOCK_SIZE << oSymTable->bloomBits);
+    oSymTable->bloomStale = 0;
+#endif
+    return 1;
+}
+
 size_t SymTable_getLength(SymTable_T oSymTable){
     assert(oSymTable != NULL);
     return (oSymTable->numOfBindings);
 }
 
+int SymTable_presize(SymTable_T oSymTable, size_t uCount){
+    size_t uIndex;
+    assert(oSymTable != NULL);
+
+    uIndex = oSymTable->numOfBuckets;
+    while (uIndex < LAST_BUCKET_COUNT_INDEX && auBucketCounts[uIndex] < uCount)
+        uIndex++;
+    if (uIndex != oSymTable->numOfBuckets){
+        SymTable_expand(oSymTable, uIndex);
+        if (oSymTable->numOfBuckets != uIndex) return 0;
+    }
+#ifdef SYMTABLE_BLOOM
+    if (oSymTable->bloom != NULL && oSymTable->bloomCapacity < uCount){
+        if (!SymTable_bloomRebuild(oSymTable, uCount)) return 0;
+    }
+#endif
+    return 1;
+}
+
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){    
     struct Binding *newBinding;
-    struct Binding *temp;
-    size_t hash;
+    struct Binding *shadowed;
+    struct Binding **link;
+    size_t fullHash;
+    size_t uDepth;
     assert(oSymTable != NULL && pcKey != NULL);
-    if (SymTable_contains(oSymTable, pcKey)) return 0;
+
+    /*the key is hashed once, for the lookup, the bucket and the Bloom filter*/
+    fullHash = SymTable_fullHash(pcKey);
+    link = SymTable_link(oSymTable, pcKey,
+        fullHash % auBucketCounts[oSymTable->numOfBuckets]);
+    shadowed = *link;
+
+    /*only the outermost scope being open, every binding is in it*/
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (shadowed != NULL && (uDepth == 0 ||
+        SymTableScopes_depthOf(oSymTable->scopes, shadowed) == uDepth))
+        return 0;
+    if (uDepth > 0 && !SymTableScopes_reserve(oSymTable->scopes, 1)) return 0;
     
     /*handles expansion*/
-    if (oSymTable->numOfBindings == auBucketCounts[oSymTable->numOfBuckets] && oSymTable->numOfBindings != auBucketCounts[LAST_BUCKET_COUNT_INDEX]){
-        SymTable_expand(oSymTable);
-    }
+    if (shadowed == NULL && oSymTable->numOfBindings == auBucketCounts[oSymTable->numOfBuckets] && oSymTable->numOfBindings != auBucketCounts[LAST_BUCKET_COUNT_INDEX])
+        SymTable_expand(oSymTable, oSymTable->numOfBuckets + 1);
     
-    newBinding = (struct Binding*)malloc(sizeof(struct Binding));
+    newBinding = SymTable_takeBinding(oSymTable, pcKey, pvValue);
     if (newBinding == NULL) return 0;
-    newBinding->key = (const char*)malloc(strlen(pcKey)+1);
-    if (newBinding->key == NULL) {
-        free(newBinding);
-        return 0;
-    }
     
-    strcpy((char *)newBinding->key,pcKey);
-    hash = SymTable_hash(pcKey,auBucketCounts[oSymTable->numOfBuckets]);
-
-    temp = oSymTable->buckets[hash];
-    newBinding->next = temp;
-    newBinding->value = pvValue;
-    oSymTable->buckets[hash] = newBinding;
-    oSymTable->numOfBindings++;
+    SymTable_bind(oSymTable, newBinding, (shadowed != NULL) ? link : NULL,
+        fullHash);
     return 1;
 }
 
 void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
     struct Binding *current;
-    const void *temp;
-    size_t hash;
     assert(oSymTable != NULL && pcKey != NULL);
 
-    if (!SymTable_contains(oSymTable,pcKey))
-        return NULL;
-
-    hash = SymTable_hash(pcKey,auBucketCounts[oSymTable->numOfBuckets]);
-    current = oSymTable->buckets[hash];
-    while (strcmp((char *)current->key,pcKey) != 0)
-        current = current->next;
-    temp = current->value;
-    current->value = pvValue;
-    return (void *)temp;
+    current = SymTable_lookup(oSymTable, pcKey);
+    if (current == NULL) return NULL;
+    return SymTable_setValue(oSymTable, current, pvValue);
 }
 
 int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
-    struct Binding* current;
-    size_t hash;
     assert(oSymTable != NULL && pcKey != NULL);
+    return SymTable_lookup(oSymTable, pcKey) != NULL;
+}
 
-    hash = SymTable_hash(pcKey,auBucketCounts[oSymTable->numOfBuckets]);
-    current = oSymTable->buckets[hash];
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    struct Binding *current;
+    assert(oSymTable != NULL && pcKey != NULL);
 
-    while (current != NULL){
-        if (strcmp((const char*)current->key,pcKey) == 0) return 1;
-        current = current->next;
-    }
-    return 0;
+    current = SymTable_lookup(oSymTable, pcKey);
+    if (current == NULL) return NULL;
+    return (void *)current->value;
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
-    struct Binding* current;
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    struct Binding **link;
     size_t hash;
     assert(oSymTable != NULL && pcKey != NULL);
 
-    hash = SymTable_hash(pcKey,auBucketCounts[oSymTable->numOfBuckets]);
-    current = oSymTable->buckets[hash];
-    
-    while (current != NULL){
-        if (strcmp((const char*)current->key,pcKey) == 0) return (void *)current->value;
-        current = current->next;
+    hash = SymTable_fullHash(pcKey);
+    if (!SymTable_mayContain(oSymTable, hash)) return NULL;
+    link = SymTable_link(oSymTable, pcKey,
+        hash % auBucketCounts[oSymTable->numOfBuckets]);
+    if (*link == NULL){
+        SymTable_missed(oSymTable);
+        return NULL;
     }
-    return NULL;
+    return SymTable_removeLink(oSymTable, link);
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey){
+    assert(oSymTable != NULL && pcKey != NULL);
+
+    /*the handle is the binding itself, which an expansion only relinks*/
+    return (SymTable_Handle)SymTable_lookup(oSymTable, pcKey);
+}
+
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return (void *)((struct Binding *)oHandle)->value;
+}
+
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return SymTable_setValue(oSymTable, (struct Binding *)oHandle, pvValue);
+}
+
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle){
+    struct Binding *current = (struct Binding *)oHandle;
+    struct Binding **link;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    /*walks the chain of the binding again to the pointer to it*/
+    link = &oSymTable->buckets[SymTable_fullHash(current->key)
+        % auBucketCounts[oSymTable->numOfBuckets]];
+    while (*link != current){
+        assert(*link != NULL);
+        link = &(*link)->next;
+    }
+    return SymTable_removeLink(oSymTable, link);
+}
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
     struct Binding *current;
-    struct Binding *prev;
+    struct Binding *existing;
+    struct Binding **link;
+    size_t uIndex;
+    size_t uDepth;
+    size_t fullHash;
+    size_t i;
+
+    assert(oDest != NULL && oSource != NULL && oDest != oSource);
+    assert(SymTableScopes_getDepth(oSource->scopes) == 0 &&
+        oSource->valueSize == oDest->valueSize &&
+        oSource->borrowedKeys == oDest->borrowedKeys &&
+        oSource->keyHeap == oDest->keyHeap);
+    assert(ePolicy != SYMTABLE_RESOLVE || pfResolve != NULL);
+
+    /*makes room in an inner scope of oDest for every binding before any moves*/
+    uDepth = SymTableScopes_getDepth(oDest->scopes);
+    if (uDepth > 0 && !SymTableScopes_reserve(oDest->scopes,
+        oSource->numOfBindings))
+        return 0;
+
+    /*bindings leave oSource, which may be left with some of them if memory
+    runs out*/
+    SymTable_hotClear(oSource);
+
+    /*expands oDest once, straight to the bucket count that both tables need*/
+    uIndex = oDest->numOfBuckets;
+    while (uIndex < LAST_BUCKET_COUNT_INDEX &&
+        auBucketCounts[uIndex] < oDest->numOfBindings + oSource->numOfBindings)
+        uIndex++;
+    if (uIndex != oDest->numOfBuckets)
+        SymTable_expand(oDest, uIndex);
+
+    /*moves each binding of oSource, with its key, into oDest. Its key is
+    hashed once, for the bucket and the Bloom filter of oDest*/
+    for (i = 0; i < auBucketCounts[oSource->numOfBuckets]; i++){
+        while (oSource->buckets[i] != NULL){
+            current = oSource->buckets[i];
+            oSource->buckets[i] = current->next;
+            oSource->numOfBindings--;
+
+            fullHash = SymTable_fullHash(current->key);
+            link = SymTable_link(oDest, current->key,
+                fullHash % auBucketCounts[oDest->numOfBuckets]);
+            existing = *link;
+            if (existing != NULL && (uDepth == 0 ||
+                SymTableScopes_depthOf(oDest->scopes, existing) == uDepth)){
+                SymTable_resolve(oDest, existing->key, &existing->value,
+                    current->value, ePolicy, pfResolve, pvExtra);
+                SymTable_dropKey(oSource, current->key);
+                SymTable_freeBinding(oSource, current);
+                continue;
+            }
+            SymTable_bind(oDest, current, (existing != NULL) ? link : NULL,
+                fullHash);
+        }
+    }
+
+    /*the keys and bindings moved stay in the blocks of oSource, which oDest
+    takes*/
+    SymTable_adoptChunks(&oDest->keyChunks, &oSource->keyChunks);
+    SymTable_adoptChunks(&oDest->bindingChunks, &oSource->bindingChunks);
+    SymTable_free(oSource);
+    return 1;
+}
+
+int SymTable_pushScope(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    if (oSymTable->scopes == NULL){
+        oSymTable->scopes = SymTableScopes_new();
+        if (oSymTable->scopes == NULL) return 0;
+    }
+    return SymTableScopes_push(oSymTable->scopes);
+}
+
+int SymTable_popScope(SymTable_T oSymTable){
+    struct Binding *current;
+    struct Binding **link;
     size_t hash;
-    const void *temp;
-    assert(oSymTable != NULL && pcKey != NULL);
+    assert(oSymTable != NULL);
 
-    hash = SymTable_hash(pcKey,auBucketCounts[oSymTable->numOfBuckets]);
-    current = oSymTable->buckets[hash];
-    prev = NULL;
+    if (SymTableScopes_getDepth(oSymTable->scopes) == 0) return 0;
 
-    while (current != NULL){
-        if(strcmp((const char *)current->key,pcKey) == 0)
-            break;
-        prev = current;
-        current = current->next;
+    /*bindings of the innermost scope are always visible, so each is in its
+    bucket, and unlinking one takes it out of the scope*/
+    while ((current = (struct Binding *)SymTableScopes_last(oSymTable->scopes))
+        != NULL){
+        hash = SymTable_hash(current->key,auBucketCounts[oSymTable->numOfBuckets]);
+        link = &oSymTable->buckets[hash];
+        while (*link != current)
+            link = &(*link)->next;
+        SymTable_unlink(oSymTable, link);
+        SymTable_dropKey(oSymTable, current->key);
+        SymTable_freeBinding(oSymTable, current);
     }
+    SymTableScopes_pop(oSymTable->scopes);
+    return 1;
+}
 
-    if (current == NULL) return NULL;
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth){
+    struct Binding *current;
+    assert(oSymTable != NULL && pcKey != NULL && puDepth != NULL);
 
-    if (prev == NULL) oSymTable->buckets[hash] = current->next;
-    else
-        prev->next = current->next;
-    
-    temp = current->value;
-    oSymTable->numOfBindings--;
-    free((void *)current->key);
-    free(current);
-    return (void *)temp;
+    current = SymTable_lookup(oSymTable, pcKey);
+    if (current == NULL) return NULL;
+    *puDepth = SymTableScopes_depthOf(oSymTable->scopes, current);
+    return (void *)current->value;
 }
 
 void SymTable_map(SymTable_T oSymTable,
@@ -260,4 +1925,49 @@ void SymTable_map(SymTable_T oSymTable,
         }
 }
 
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Binding *current;
+        size_t uPrefixLength;
+        size_t i;
+        assert(oSymTable != NULL && pcPrefix != NULL && pfApply != NULL);
+
+        /*the keys are spread over the buckets, so every binding is checked*/
+        uPrefixLength = strlen(pcPrefix);
+        for (i = 0; i < auBucketCounts[oSymTable->numOfBuckets]; i++){
+            current = oSymTable->buckets[i];
+            while (current != NULL){
+                if (strncmp(current->key, pcPrefix, uPrefixLength) == 0)
+                    (*pfApply)(current->key, (void *)current->value,(void *)pvExtra);
+                current = current->next;
+            }
+        }
+}
+
+void SymTable_getBloomStats(SymTable_T oSymTable,
+    struct SymTableBloomStats *psStats){
+    assert(oSymTable != NULL && psStats != NULL);
 
+#ifdef SYMTABLE_BLOOM
+    *psStats = oSymTable->bloomStats;
+#else
+    (void)oSymTable;
+    psStats->lookups = 0;
+    psStats->rejected = 0;
+    psStats->falsePositives = 0;
+#endif
+}
+
+void SymTable_getHotStats(SymTable_T oSymTable,
+    struct SymTableHotStats *psStats){
+    assert(oSymTable != NULL && psStats != NULL);
+
+#ifdef SYMTABLE_HOT_CACHE
+    *psStats = oSymTable->hotStats;
+#else
+    (void)oSymTable;
+    psStats->lookups = 0;
+    psStats->hits = 0;
+#endif
+}
@@ -0,0 +1,29 @@
+/*--------------------------------------------------------------------*/
+/* symtablehot.h                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEHOT_INCLUDED
+#define SYMTABLEHOT_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Counters of the hot key cache that symtablehash.c keeps in front of its
+buckets when built with -DSYMTABLE_HOT_CACHE, a small direct-mapped cache of
+the bindings recent lookups found. The hit rate is hits / lookups*/
+struct SymTableHotStats{
+    /*lookups by contains, get, getInnermost, replace and find checked against
+    the cache*/
+    size_t lookups;
+
+    /*lookups the cache answered without reading a bucket*/
+    size_t hits;
+};
+
+/*Stores the counters of the hot key cache of oSymTable in *psStats, all 0 if
+oSymTable has no cache*/
+void SymTable_getHotStats(SymTable_T oSymTable,
+    struct SymTableHotStats *psStats);
+
+#endif
@@ -0,0 +1,207 @@
+/*--------------------------------------------------------------------*/
+/* symtableint.c                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtableint.h"
+
+/*number of buckets of a new table, a power of 2*/
+static const size_t FIRST_BUCKET_COUNT = 512;
+
+/* Represents a binding in the integer keyed table*/
+struct Binding{
+    /*key of the binding*/
+    uint64_t key;
+
+    /*value of the binding that is a void pointer*/
+    const void *value;
+
+    /*next binding in the bucket*/
+    struct Binding *next;
+};
+
+/* Represents the integer keyed table*/
+struct SymTableInt{
+    /*number of buckets, a power of 2*/
+    size_t numOfBuckets;
+
+    /*number of bindings*/
+    size_t numOfBindings;
+
+    /*array of pointers to the first binding in each bucket*/
+    struct Binding **buckets;
+};
+
+/*Returns the bucket of uKey in a table of uBucketCount buckets, a power of 2.
+The key is mixed first so that keys that differ only in their high bits, or
+that count up in steps of a power of 2, still spread over all buckets*/
+static size_t SymTableInt_hash(uint64_t uKey, size_t uBucketCount){
+    uKey ^= uKey >> 30;
+    uKey *= UINT64_C(0xbf58476d1ce4e5b9);
+    uKey ^= uKey >> 27;
+    uKey *= UINT64_C(0x94d049bb133111eb);
+    uKey ^= uKey >> 31;
+    return (size_t)uKey & (uBucketCount - 1);
+}
+
+/*Doubles the number of buckets of oSymTableInt, rehashing all keys. Leaves
+oSymTableInt unchanged if insufficient memory*/
+static void SymTableInt_expand(SymTableInt_T oSymTableInt){
+    struct Binding **newBuckets;
+    struct Binding *current;
+    struct Binding *next;
+    size_t uNewCount = 2 * oSymTableInt->numOfBuckets;
+    size_t hash;
+    size_t i;
+
+    newBuckets = (struct Binding **)calloc(uNewCount, sizeof(struct Binding *));
+    if (newBuckets == NULL) return;
+    for (i = 0; i < oSymTableInt->numOfBuckets; i++){
+        for (current = oSymTableInt->buckets[i]; current != NULL; current = next){
+            next = current->next;
+            hash = SymTableInt_hash(current->key, uNewCount);
+            current->next = newBuckets[hash];
+            newBuckets[hash] = current;
+        }
+    }
+    free(oSymTableInt->buckets);
+    oSymTableInt->buckets = newBuckets;
+    oSymTableInt->numOfBuckets = uNewCount;
+}
+
+/*Returns the address of the pointer to the binding with uKey in oSymTableInt,
+or of the NULL pointer that ends its bucket if there is none*/
+static struct Binding **SymTableInt_link(SymTableInt_T oSymTableInt,
+    uint64_t uKey){
+    struct Binding **link;
+
+    link = &oSymTableInt->buckets[SymTableInt_hash(uKey, oSymTableInt->numOfBuckets)];
+    while (*link != NULL && (*link)->key != uKey)
+        link = &(*link)->next;
+    return link;
+}
+
+SymTableInt_T SymTableInt_new(void){
+    SymTableInt_T oSymTableInt;
+
+    oSymTableInt = (SymTableInt_T)malloc(sizeof(struct SymTableInt));
+    if (oSymTableInt == NULL) return NULL;
+    oSymTableInt->buckets =
+        (struct Binding **)calloc(FIRST_BUCKET_COUNT, sizeof(struct Binding *));
+    if (oSymTableInt->buckets == NULL){
+        free(oSymTableInt);
+        return NULL;
+    }
+    oSymTableInt->numOfBuckets = FIRST_BUCKET_COUNT;
+    oSymTableInt->numOfBindings = 0;
+    return oSymTableInt;
+}
+
+void SymTableInt_free(SymTableInt_T oSymTableInt){
+    struct Binding *current;
+    struct Binding *next;
+    size_t i;
+    assert(oSymTableInt != NULL);
+
+    for (i = 0; i < oSymTableInt->numOfBuckets; i++){
+        for (current = oSymTableInt->buckets[i]; current != NULL; current = next){
+            next = current->next;
+            free(current);
+        }
+    }
+    free(oSymTableInt->buckets);
+    free(oSymTableInt);
+}
+
+size_t SymTableInt_getLength(SymTableInt_T oSymTableInt){
+    assert(oSymTableInt != NULL);
+    return oSymTableInt->numOfBindings;
+}
+
+int SymTableInt_put(SymTableInt_T oSymTableInt, uint64_t uKey,
+    const void *pvValue){
+    struct Binding *newBinding;
+    struct Binding **link;
+    assert(oSymTableInt != NULL);
+
+    link = SymTableInt_link(oSymTableInt, uKey);
+    if (*link != NULL) return 0;
+
+    /*keeps at most one binding per bucket on average*/
+    if (oSymTableInt->numOfBindings == oSymTableInt->numOfBuckets){
+        SymTableInt_expand(oSymTableInt);
+        link = &oSymTableInt->buckets[SymTableInt_hash(uKey,
+            oSymTableInt->numOfBuckets)];
+    }
+
+    newBinding = (struct Binding *)malloc(sizeof(struct Binding));
+    if (newBinding == NULL) return 0;
+    newBinding->key = uKey;
+    newBinding->value = pvValue;
+    newBinding->next = *link;
+    *link = newBinding;
+    oSymTableInt->numOfBindings++;
+    return 1;
+}
+
+void *SymTableInt_replace(SymTableInt_T oSymTableInt, uint64_t uKey,
+    const void *pvValue){
+    struct Binding *current;
+    const void *pvOld;
+    assert(oSymTableInt != NULL);
+
+    current = *SymTableInt_link(oSymTableInt, uKey);
+    if (current == NULL) return NULL;
+    pvOld = current->value;
+    current->value = pvValue;
+    return (void *)pvOld;
+}
+
+int SymTableInt_contains(SymTableInt_T oSymTableInt, uint64_t uKey){
+    assert(oSymTableInt != NULL);
+    return *SymTableInt_link(oSymTableInt, uKey) != NULL;
+}
+
+void *SymTableInt_get(SymTableInt_T oSymTableInt, uint64_t uKey){
+    struct Binding *current;
+    assert(oSymTableInt != NULL);
+
+    current = *SymTableInt_link(oSymTableInt, uKey);
+    if (current == NULL) return NULL;
+    return (void *)current->value;
+}
+
+void *SymTableInt_remove(SymTableInt_T oSymTableInt, uint64_t uKey){
+    struct Binding *current;
+    struct Binding **link;
+    const void *pvOld;
+    assert(oSymTableInt != NULL);
+
+    link = SymTableInt_link(oSymTableInt, uKey);
+    current = *link;
+    if (current == NULL) return NULL;
+    *link = current->next;
+    oSymTableInt->numOfBindings--;
+    pvOld = current->value;
+    free(current);
+    return (void *)pvOld;
+}
+
+void SymTableInt_map(SymTableInt_T oSymTableInt,
+    void (*pfApply)(uint64_t uKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Binding *current;
+        size_t i;
+        assert(oSymTableInt != NULL && pfApply != NULL);
+
+        for (i = 0; i < oSymTableInt->numOfBuckets; i++){
+            current = oSymTableInt->buckets[i];
+            while (current != NULL){
+                (*pfApply)(current->key, (void *)current->value, (void *)pvExtra);
+                current = current->next;
+            }
+        }
+}
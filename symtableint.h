@@ -0,0 +1,55 @@
+/*--------------------------------------------------------------------*/
+/* symtableint.h                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEINT_INCLUDED
+#define SYMTABLEINT_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*Creates an alias SymTableInt_T as an opaque pointer to an integer keyed
+symbol table. It works like a SymTable whose keys are 64 bit integers instead
+of strings, stored in the bindings themselves, so that no key is formatted,
+copied or compared as a string*/
+typedef struct SymTableInt *SymTableInt_T;
+
+/*Creates and returns an empty integer keyed table. Returns NULL if
+insufficient memory*/
+SymTableInt_T SymTableInt_new(void);
+
+/*Frees all the memory associated with oSymTableInt*/
+void SymTableInt_free(SymTableInt_T oSymTableInt);
+
+/*Returns number of bindings in oSymTableInt*/
+size_t SymTableInt_getLength(SymTableInt_T oSymTableInt);
+
+/*Inserts new binding with uKey and pvValue into oSymTableInt. Returns 0 if
+uKey is already in oSymTableInt or if insufficient memory, 1 if succesful*/
+int SymTableInt_put(SymTableInt_T oSymTableInt, uint64_t uKey,
+    const void *pvValue);
+
+/*Replaces the value in oSymTableInt associated with uKey with pvValue
+and returns old value. Returns NULL if uKey is not in oSymTableInt*/
+void *SymTableInt_replace(SymTableInt_T oSymTableInt, uint64_t uKey,
+    const void *pvValue);
+
+/*Returns 1 if there is a binding with uKey in oSymTableInt,
+returns 0 if there is not*/
+int SymTableInt_contains(SymTableInt_T oSymTableInt, uint64_t uKey);
+
+/*Returns the value associated with uKey in oSymTableInt*/
+void *SymTableInt_get(SymTableInt_T oSymTableInt, uint64_t uKey);
+
+/*Removes the binding with uKey if it exists in oSymTableInt, returns value
+of binding. Returns NULL if uKey is not in oSymTableInt*/
+void *SymTableInt_remove(SymTableInt_T oSymTableInt, uint64_t uKey);
+
+/*Applies the function pfApply to all bindings in oSymTableInt, passes pvExtra
+as an argument of pfApply*/
+void SymTableInt_map(SymTableInt_T oSymTableInt,
+    void (*pfApply)(uint64_t uKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+#endif
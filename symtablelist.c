@@ -8,18 +8,21 @@
 #include <assert.h>
 #include <stddef.h>
 #include "symtable.h"
+#include "symtablebuild.h"
+#include "symtablescope.h"
 
 /*Defines a linked list node for a symbol table entry with a key, a value, and next node.*/
 struct Node {
-     /*key of the binding that is a string */
+     /*key of the binding that is a string, owned by the table unless it
+    borrows keys*/
     const char *key;
 
-    /*value of the binding that is a void pointer*/
+    /*value of the binding that is a void pointer, or in an inline table a
+    pointer to the value stored after the node*/
     const void *value;
 
     /*next binding in the bucket that the binding points to*/
     struct Node *next;
-
 };
 
 /*Represents the symbol table*/
@@ -27,9 +30,222 @@ struct SymTable{
     /*Number of bindings in table*/
     size_t length;
 
-    /*First node in the linked list*/
+    /*First node in the linked list, which holds the visible bindings*/
     struct Node *first;
+
+    /*open scopes, which know the depth of each node put in an inner scope and
+    the node it hides, which is in no list while it is hidden. NULL until the
+    first pushScope, so that nodes carry nothing for scopes*/
+    SymTableScopes_T scopes;
+
+    /*size of the values stored in the nodes, 0 if values are void pointers*/
+    size_t valueSize;
+
+    /*copy of the last value replaced or removed from an inline table*/
+    void *oldValue;
+
+    /*1 if the nodes point to the callers' keys instead of copies*/
+    int borrowedKeys;
 };
+
+/*Copies the valueSize bytes at pvValue, or zeros if pvValue is NULL, into the
+inline value pvDest of oSymTable*/
+static void SymTable_storeValue(SymTable_T oSymTable, void *pvDest,
+    const void *pvValue){
+    if (pvValue != NULL)
+        memcpy(pvDest, pvValue, oSymTable->valueSize);
+    else
+        memset(pvDest, 0, oSymTable->valueSize);
+}
+
+/*Allocates a node of oSymTable with room for an inline value, and sets its
+value to pvValue. Returns NULL if insufficient memory*/
+static struct Node *SymTable_newNode(SymTable_T oSymTable, const void *pvValue){
+    struct Node *newNode;
+
+    newNode = (struct Node*)malloc(sizeof(struct Node) + oSymTable->valueSize);
+    if (newNode == NULL) return NULL;
+    newNode->value = pvValue;
+    if (oSymTable->valueSize != 0){
+        newNode->value = newNode + 1;
+        SymTable_storeValue(oSymTable, newNode + 1, pvValue);
+    }
+    return newNode;
+}
+
+/*Returns the key to store for pcKey in oSymTable, which is pcKey itself if
+oSymTable borrows keys and a copy of it otherwise. Returns NULL if insufficient
+memory*/
+static const char *SymTable_keepKey(SymTable_T oSymTable, const char *pcKey){
+    char *pcCopy;
+
+    if (oSymTable->borrowedKeys) return pcKey;
+    pcCopy = (char *)malloc(strlen(pcKey) + 1);
+    if (pcCopy == NULL) return NULL;
+    return strcpy(pcCopy, pcKey);
+}
+
+/*Frees the key pcKey of a node of oSymTable unless oSymTable borrows keys*/
+static void SymTable_dropKey(SymTable_T oSymTable, const char *pcKey){
+    if (!oSymTable->borrowedKeys)
+        free((void *)pcKey);
+}
+
+/*Returns the value pvValue of a node of oSymTable that is being replaced or
+removed, saving a copy of it first if oSymTable is inline*/
+static void *SymTable_oldValue(SymTable_T oSymTable, const void *pvValue){
+    if (oSymTable->valueSize == 0) return (void *)pvValue;
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/*Returns the address of the pointer to the visible node with pcKey in
+oSymTable, or of the NULL pointer that ends the list if there is none*/
+static struct Node **SymTable_link(SymTable_T oSymTable, const char *pcKey){
+    struct Node **link = &oSymTable->first;
+
+    while (*link != NULL && strcmp((*link)->key, pcKey) != 0)
+        link = &(*link)->next;
+    return link;
+}
+
+/*Takes the visible node *link out of the list and its scope in oSymTable,
+putting the node it shadows back in its place*/
+static void SymTable_unlink(SymTable_T oSymTable, struct Node **link){
+    struct Node *current = *link;
+    struct Node *shadowed;
+
+    shadowed = (struct Node *)SymTableScopes_remove(oSymTable->scopes, current);
+    if (shadowed != NULL){
+        shadowed->next = current->next;
+        *link = shadowed;
+    }
+    else{
+        *link = current->next;
+        oSymTable->length--;
+    }
+}
+
+/*Removes the visible node *link from oSymTable and returns its value*/
+static void *SymTable_removeLink(SymTable_T oSymTable, struct Node **link){
+    struct Node *current = *link;
+    const void *temp;
+
+    SymTable_unlink(oSymTable, link);
+    temp = SymTable_oldValue(oSymTable, current->value);
+    SymTable_dropKey(oSymTable, current->key);
+    free(current);
+    return (void *)temp;
+}
+
+/*Adds newNode to the innermost scope of oSymTable. shadowed is the visible
+node with its key, which newNode hides and whose place it takes in the list,
+and link the address of the pointer to it, or both are NULL if there is none,
+in which case newNode goes at the front. Unless the innermost scope is the
+outermost, room for newNode must have been reserved in the scopes of
+oSymTable*/
+static void SymTable_bind(SymTable_T oSymTable, struct Node *newNode,
+    struct Node **link){
+    struct Node *shadowed = (link != NULL) ? *link : NULL;
+    size_t uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+
+    if (shadowed != NULL){
+        newNode->next = shadowed->next;
+        *link = newNode;
+    }
+    else{
+        newNode->next = oSymTable->first;
+        oSymTable->first = newNode;
+        oSymTable->length++;
+    }
+    if (uDepth > 0)
+        SymTableScopes_add(oSymTable->scopes, newNode, uDepth, shadowed);
+}
+
+/*Returns 1 if the visible node psNode of oSymTable is in the innermost scope,
+0 if it is in an outer one*/
+static int SymTable_inInnermost(SymTable_T oSymTable, struct Node *psNode){
+    size_t uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+
+    /*only the outermost scope being open, every node is in it*/
+    if (uDepth == 0) return 1;
+    return SymTableScopes_depthOf(oSymTable->scopes, psNode) == uDepth;
+}
+
+/*Frees psNode of oSymTable and every node it shadows, taking them out of
+their scopes*/
+static void SymTable_freeStack(SymTable_T oSymTable, struct Node *psNode){
+    struct Node *shadowed;
+
+    while (psNode != NULL){
+        shadowed = (struct Node *)SymTableScopes_remove(oSymTable->scopes,
+            psNode);
+        SymTable_dropKey(oSymTable, psNode->key);
+        free(psNode);
+        psNode = shadowed;
+    }
+}
+
+/*Returns a copy for oClone of psNode of oSymTable, putting the copy and a copy
+of every node psNode shadows in the same scopes of oClone, which are open.
+Returns NULL if insufficient memory*/
+static struct Node *SymTable_copyStack(SymTable_T oClone, SymTable_T oSymTable,
+    const struct Node *psNode){
+    struct Node *shadowed = NULL;
+    struct Node *newNode;
+    const struct Node *psShadowed;
+    size_t uDepth;
+
+    /*the nodes it shadows are copied first, so the copy can hide theirs*/
+    psShadowed = (const struct Node *)SymTableScopes_shadowed(oSymTable->scopes,
+        psNode);
+    if (psShadowed != NULL){
+        shadowed = SymTable_copyStack(oClone, oSymTable, psShadowed);
+        if (shadowed == NULL) return NULL;
+    }
+
+    uDepth = SymTableScopes_depthOf(oSymTable->scopes, psNode);
+    if (uDepth > 0 && !SymTableScopes_reserve(oClone->scopes, 1)){
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    newNode = SymTable_newNode(oClone, psNode->value);
+    if (newNode == NULL){
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    newNode->key = SymTable_keepKey(oClone, psNode->key);
+    if (newNode->key == NULL){
+        free(newNode);
+        SymTable_freeStack(oClone, shadowed);
+        return NULL;
+    }
+    newNode->next = NULL;
+    if (uDepth > 0)
+        SymTableScopes_add(oClone->scopes, newNode, uDepth, shadowed);
+    return newNode;
+}
+
+/*Sets the value *ppvValue of the binding of oSymTable with pcKey, which a merge
+also brings the value pvIncoming for, as ePolicy says*/
+static void SymTable_resolve(SymTable_T oSymTable, const char *pcKey,
+    const void **ppvValue, const void *pvIncoming,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    const void *pvValue = pvIncoming;
+
+    if (ePolicy == SYMTABLE_KEEP_EXISTING) return;
+    if (ePolicy == SYMTABLE_RESOLVE)
+        pvValue = (*pfResolve)(pcKey, (void *)*ppvValue, (void *)pvIncoming,
+            (void *)pvExtra);
+    if (oSymTable->valueSize == 0)
+        *ppvValue = pvValue;
+    else if (pvValue != *ppvValue)
+        SymTable_storeValue(oSymTable, (void *)*ppvValue, pvValue);
+}
+
 SymTable_T SymTable_new(void){
     SymTable_T oSymTable;
     oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
@@ -39,9 +255,101 @@ SymTable_T SymTable_new(void){
 
     oSymTable->first = NULL;
     oSymTable->length = 0;
+    oSymTable->scopes = NULL;
+    oSymTable->valueSize = 0;
+    oSymTable->oldValue = NULL;
+    oSymTable->borrowedKeys = 0;
+    return oSymTable;
+}
+
+SymTable_T SymTable_newBorrowedKeys(void){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->borrowedKeys = 1;
     return oSymTable;
 }
 
+SymTable_T SymTable_newKeyHeap(void){
+    /*the nodes of a list are small, so its keys stay allocated one by one*/
+    return SymTable_new();
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize){
+    SymTable_T oSymTable;
+    assert(uValueSize > 0);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) return NULL;
+    oSymTable->oldValue = malloc(uValueSize);
+    if (oSymTable->oldValue == NULL){
+        free(oSymTable);
+        return NULL;
+    }
+    oSymTable->valueSize = uValueSize;
+    return oSymTable;
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable){
+    SymTable_T oClone;
+    struct Node *current;
+    struct Node *newNode;
+    struct Node **last;
+    size_t uDepth;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize != 0)
+        oClone = SymTable_newInline(oSymTable->valueSize);
+    else
+        oClone = SymTable_new();
+    if (oClone == NULL) return NULL;
+    oClone->borrowedKeys = oSymTable->borrowedKeys;
+
+    /*gives the clone the same open scopes*/
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (uDepth != 0){
+        oClone->scopes = SymTableScopes_new();
+        if (oClone->scopes == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        for (i = 0; i < uDepth; i++){
+            if (!SymTableScopes_push(oClone->scopes)){
+                SymTable_free(oClone);
+                return NULL;
+            }
+        }
+    }
+
+    /*copies the nodes in order, appending each copy after the previous one,
+    with the nodes each node shadows*/
+    last = &oClone->first;
+    for (current = oSymTable->first; current != NULL; current = current->next){
+        newNode = SymTable_copyStack(oClone, oSymTable, current);
+        if (newNode == NULL){
+            SymTable_free(oClone);
+            return NULL;
+        }
+        *last = newNode;
+        last = &newNode->next;
+        oClone->length++;
+    }
+    return oClone;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount,
+    size_t *puDuplicates){
+    assert(ppcKeys != NULL && ppvValues != NULL && uThreadCount > 0);
+
+    /*a list has nothing to split between threads, so it is built on the
+    calling thread*/
+    (void)uThreadCount;
+    return SymTable_buildSerial(ppcKeys, ppvValues, uCount, puDuplicates);
+}
+
 void SymTable_free(SymTable_T oSymTable){
     struct Node *current;
     struct Node *next;
@@ -51,42 +359,75 @@ void SymTable_free(SymTable_T oSymTable){
 
     while(current != NULL){
         next = current->next;
-        free((void *)current->key);
-        free(current);
+        SymTable_freeStack(oSymTable, current);
         current = next;
     }
     oSymTable->length = 0;
+    SymTableScopes_free(oSymTable->scopes);
+    free(oSymTable->oldValue);
     free(oSymTable);
 }
 
+int SymTable_clear(SymTable_T oSymTable, void (*pfFreeValue)(void *pvValue)){
+    struct Node *current;
+    struct Node *next;
+    struct Node *shadowed;
+
+    assert(oSymTable != NULL);
+    current = oSymTable->first;
+
+    /*the nodes have no storage in common, so there is nothing to keep*/
+    while(current != NULL){
+        next = current->next;
+        for (; current != NULL; current = shadowed){
+            shadowed = (struct Node *)SymTableScopes_shadowed(oSymTable->scopes,
+                current);
+            if (pfFreeValue != NULL)
+                (*pfFreeValue)((void *)current->value);
+            SymTable_dropKey(oSymTable, current->key);
+            free(current);
+        }
+        current = next;
+    }
+    oSymTable->first = NULL;
+    oSymTable->length = 0;
+    SymTableScopes_clear(oSymTable->scopes);
+    return 1;
+}
+
 size_t SymTable_getLength(SymTable_T oSymTable){
     assert(oSymTable != NULL);
     return (oSymTable->length);
 }
 
+int SymTable_presize(SymTable_T oSymTable, size_t uCount){
+    assert(oSymTable != NULL);
+    /*a list has nothing to grow, each binding is allocated as it is put*/
+    (void)uCount;
+    return 1;
+}
+
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
     struct Node *newNode;
-    struct Node *temp;
+    struct Node **link;
 
     assert(oSymTable != NULL && pcKey != NULL);
-    if (SymTable_contains(oSymTable, pcKey))
+    link = SymTable_link(oSymTable, pcKey);
+    if (*link != NULL && SymTable_inInnermost(oSymTable, *link))
+        return 0;
+    if (SymTableScopes_getDepth(oSymTable->scopes) > 0 &&
+        !SymTableScopes_reserve(oSymTable->scopes, 1))
         return 0;
 
-    temp = oSymTable->first;
-    newNode = (struct Node*)malloc(sizeof(struct Node));
+    newNode = SymTable_newNode(oSymTable, pvValue);
     if (newNode == NULL) return 0;
-    newNode->key = (const char*)malloc(strlen(pcKey) + 1);
+    newNode->key = SymTable_keepKey(oSymTable, pcKey);
     if (newNode->key == NULL) {
         free(newNode);
         return 0;
     }
 
-    strcpy((char *)newNode->key,pcKey);
-    newNode->value = pvValue;
-    newNode->next = temp;
-    oSymTable->first = newNode;
-    oSymTable->length++;
-
+    SymTable_bind(oSymTable, newNode, (*link != NULL) ? link : NULL);
     return 1;
 }
 
@@ -102,6 +443,11 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
     current = oSymTable->first;
     while(strcmp((const char *)current->key,pcKey)!=0)
         current = current->next;
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, current->value);
+        SymTable_storeValue(oSymTable, (void *)current->value, pvValue);
+        return (void *)temp;
+    }
     temp = current->value;
     current->value = pvValue;
     return (void *)temp;
@@ -135,38 +481,56 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
 }
 
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
-    struct Node *current;
-    struct Node *prev;
-    const void *temp;
+    struct Node **link;
     assert(oSymTable != NULL && pcKey != NULL);
 
-    current = oSymTable->first;
-    prev = NULL;
+    link = SymTable_link(oSymTable, pcKey);
+    if (*link == NULL)
+        return NULL;
+    return SymTable_removeLink(oSymTable, link);
+}
 
-    while (current != NULL){
-        if(strcmp((const char *)current->key,pcKey) == 0)
-            break;
-        prev = current;
-        current = current->next;
-    }
+SymTable_Handle SymTable_find(SymTable_T oSymTable, const char *pcKey){
+    assert(oSymTable != NULL && pcKey != NULL);
 
-    if (current == NULL)
-        return NULL;
+    /*the handle is the visible node itself*/
+    return (SymTable_Handle)*SymTable_link(oSymTable, pcKey);
+}
 
-    if (prev == NULL){
-        oSymTable->first = current->next;
-    }
-    else{
-        prev->next = current->next;
+void *SymTable_handleValue(SymTable_T oSymTable, SymTable_Handle oHandle){
+    assert(oSymTable != NULL && oHandle != NULL);
+    return (void *)((struct Node *)oHandle)->value;
+}
+
+void *SymTable_handleSetValue(SymTable_T oSymTable, SymTable_Handle oHandle,
+    const void *pvValue){
+    struct Node *current = (struct Node *)oHandle;
+    const void *temp;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    if (oSymTable->valueSize != 0){
+        temp = SymTable_oldValue(oSymTable, current->value);
+        SymTable_storeValue(oSymTable, (void *)current->value, pvValue);
+        return (void *)temp;
     }
     temp = current->value;
-    oSymTable->length--;
-    free((void *)current->key);
-    free(current);
-    
+    current->value = pvValue;
     return (void *)temp;
 }
 
+void *SymTable_handleRemove(SymTable_T oSymTable, SymTable_Handle oHandle){
+    struct Node **link;
+    assert(oSymTable != NULL && oHandle != NULL);
+
+    /*walks the list again to the pointer to the node*/
+    link = &oSymTable->first;
+    while (*link != (struct Node *)oHandle){
+        assert(*link != NULL);
+        link = &(*link)->next;
+    }
+    return SymTable_removeLink(oSymTable, link);
+}
+
 void SymTable_map(SymTable_T oSymTable,
     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
     const void *pvExtra){
@@ -181,3 +545,114 @@ void SymTable_map(SymTable_T oSymTable,
 
     }
 
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Node *current;
+        size_t uPrefixLength;
+
+        assert(oSymTable != NULL && pcPrefix != NULL && pfApply != NULL);
+        uPrefixLength = strlen(pcPrefix);
+        current = oSymTable->first;
+        while (current != NULL){
+            if (strncmp(current->key, pcPrefix, uPrefixLength) == 0)
+                (*pfApply)(current->key, (void *)current->value,(void *)pvExtra);
+            current = current->next;
+        }
+    }
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    enum SymTable_MergePolicy ePolicy,
+    void *(*pfResolve)(const char *pcKey, void *pvExisting, void *pvIncoming,
+        void *pvExtra),
+    const void *pvExtra){
+    struct Node *current;
+    struct Node *existing;
+    struct Node **link;
+
+    assert(oDest != NULL && oSource != NULL && oDest != oSource);
+    assert(SymTableScopes_getDepth(oSource->scopes) == 0 &&
+        oSource->valueSize == oDest->valueSize &&
+        oSource->borrowedKeys == oDest->borrowedKeys);
+    assert(ePolicy != SYMTABLE_RESOLVE || pfResolve != NULL);
+
+    /*makes room in an inner scope of oDest for every node before any moves*/
+    if (SymTableScopes_getDepth(oDest->scopes) > 0 &&
+        !SymTableScopes_reserve(oDest->scopes, oSource->length))
+        return 0;
+
+    /*moves the nodes of oSource, with their keys, to the front of oDest*/
+    while (oSource->first != NULL){
+        current = oSource->first;
+        oSource->first = current->next;
+        oSource->length--;
+
+        link = SymTable_link(oDest, current->key);
+        existing = *link;
+        if (existing != NULL && SymTable_inInnermost(oDest, existing)){
+            SymTable_resolve(oDest, existing->key, &existing->value,
+                current->value, ePolicy, pfResolve, pvExtra);
+            SymTable_dropKey(oSource, current->key);
+            free(current);
+            continue;
+        }
+
+        SymTable_bind(oDest, current, (existing != NULL) ? link : NULL);
+    }
+    SymTable_free(oSource);
+    return 1;
+}
+
+int SymTable_pushScope(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    if (oSymTable->scopes == NULL){
+        oSymTable->scopes = SymTableScopes_new();
+        if (oSymTable->scopes == NULL) return 0;
+    }
+    return SymTableScopes_push(oSymTable->scopes);
+}
+
+int SymTable_popScope(SymTable_T oSymTable){
+    struct Node *current;
+    struct Node **link;
+    size_t uDepth;
+    assert(oSymTable != NULL);
+
+    uDepth = SymTableScopes_getDepth(oSymTable->scopes);
+    if (uDepth == 0)
+        return 0;
+
+    /*the nodes of the innermost scope are all visible, so one walk over the
+    list finds them, and it stops once the scope has none left*/
+    link = &oSymTable->first;
+    while (*link != NULL && SymTableScopes_last(oSymTable->scopes) != NULL){
+        current = *link;
+        if (SymTableScopes_depthOf(oSymTable->scopes, current) != uDepth){
+            link = &current->next;
+            continue;
+        }
+        SymTable_unlink(oSymTable, link);
+        SymTable_dropKey(oSymTable, current->key);
+        free(current);
+    }
+    SymTableScopes_pop(oSymTable->scopes);
+    return 1;
+}
+
+void *SymTable_getInnermost(SymTable_T oSymTable, const char *pcKey,
+    size_t *puDepth){
+    struct Node *current;
+    assert(oSymTable != NULL && pcKey != NULL && puDepth != NULL);
+    current = oSymTable->first;
+
+    while (current != NULL){
+        if (strcmp((const char *)current->key,pcKey) == 0){
+            *puDepth = SymTableScopes_depthOf(oSymTable->scopes, current);
+            return (void *)current->value;
+        }
+        current = current->next;
+    }
+    return NULL;
+}
+
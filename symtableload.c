@@ -0,0 +1,298 @@
+/*--------------------------------------------------------------------*/
+/* symtableload.c                                                     */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtableload.h"
+
+/*files are mapped into memory where the system has mmap, building with
+-DSYMTABLE_NO_MMAP reads them into an allocated buffer*/
+#if defined(__unix__) && !defined(SYMTABLE_NO_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define SYMTABLE_MMAP
+#endif
+
+/*length of the first buffer keys are copied into to end them with '\0'*/
+static const size_t FIRST_KEY_BUFFER_SIZE = 256;
+
+/* Represents a file in memory*/
+struct SymTableFile{
+    /*bytes of the file, followed by a '\0' that can be overwritten*/
+    char *text;
+
+    /*number of bytes of the file*/
+    size_t length;
+
+    /*number of bytes mapped at text, or 0 if text was allocated*/
+    size_t mapped;
+};
+
+/* How the values of a file are made and freed*/
+struct Load{
+    /*function making a value from its text, or NULL for NULL values*/
+    void *(*parseValue)(const char *pcValue, size_t uLength, void *pvExtra);
+
+    /*function freeing a value that is dropped, or NULL*/
+    void (*freeValue)(void *pvValue);
+
+    /*argument passed to parseValue*/
+    const void *extra;
+};
+
+/*Returns the file at pcPath in memory, followed by a '\0', in pages that can
+be written without changing the file if iWritable is 1. Returns NULL if the
+file cannot be read or if insufficient memory*/
+static SymTableFile_T SymTable_openFile(const char *pcPath, int iWritable){
+    SymTableFile_T oFile;
+#ifdef SYMTABLE_MMAP
+    struct stat sStat;
+    size_t uPageSize;
+    char *pcMap;
+    int iFd;
+#else
+    FILE *psFile;
+    long lSize;
+#endif
+
+    oFile = (SymTableFile_T)malloc(sizeof(struct SymTableFile));
+    if (oFile == NULL) return NULL;
+
+#ifdef SYMTABLE_MMAP
+    iFd = open(pcPath, O_RDONLY);
+    if (iFd < 0){
+        free(oFile);
+        return NULL;
+    }
+    if (fstat(iFd, &sStat) != 0){
+        close(iFd);
+        free(oFile);
+        return NULL;
+    }
+    oFile->length = (size_t)sStat.st_size;
+
+    /*maps zero pages one byte past the file, then maps the file over them, so
+    that the '\0' after the file is there even when the file ends on a page
+    boundary*/
+    uPageSize = (size_t)sysconf(_SC_PAGESIZE);
+    oFile->mapped = (oFile->length / uPageSize + 1) * uPageSize;
+    pcMap = (char *)mmap(NULL, oFile->mapped, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pcMap == (char *)MAP_FAILED){
+        close(iFd);
+        free(oFile);
+        return NULL;
+    }
+    if (oFile->length != 0 && mmap(pcMap, oFile->length,
+        iWritable ? PROT_READ | PROT_WRITE : PROT_READ,
+        MAP_PRIVATE | MAP_FIXED, iFd, 0) == MAP_FAILED){
+        munmap(pcMap, oFile->mapped);
+        close(iFd);
+        free(oFile);
+        return NULL;
+    }
+    close(iFd);
+    /*the file is read from start to end, twice*/
+    posix_madvise(pcMap, oFile->length, POSIX_MADV_WILLNEED);
+    oFile->text = pcMap;
+#else
+    (void)iWritable;
+    psFile = fopen(pcPath, "rb");
+    if (psFile == NULL){
+        free(oFile);
+        return NULL;
+    }
+    if (fseek(psFile, 0, SEEK_END) != 0 || (lSize = ftell(psFile)) < 0 ||
+        fseek(psFile, 0, SEEK_SET) != 0){
+        fclose(psFile);
+        free(oFile);
+        return NULL;
+    }
+    oFile->length = (size_t)lSize;
+    oFile->mapped = 0;
+    oFile->text = (char *)malloc(oFile->length + 1);
+    if (oFile->text == NULL ||
+        fread(oFile->text, 1, oFile->length, psFile) != oFile->length){
+        free(oFile->text);
+        fclose(psFile);
+        free(oFile);
+        return NULL;
+    }
+    fclose(psFile);
+    oFile->text[oFile->length] = '\0';
+#endif
+    return oFile;
+}
+
+/*Returns the number of lines of the uLength bytes at pcText, counting a last
+line without a '\n'*/
+static size_t SymTable_countLines(const char *pcText, size_t uLength){
+    const char *pcEnd = pcText + uLength;
+    const char *pcNewline;
+    size_t uCount = 0;
+
+    while ((pcNewline = (const char *)memchr(pcText, '\n',
+        (size_t)(pcEnd - pcText))) != NULL){
+        uCount++;
+        pcText = pcNewline + 1;
+    }
+    if (pcText != pcEnd)
+        uCount++;
+    return uCount;
+}
+
+/*Binds pcKey in oSymTable to the value psLoad makes from the uLength bytes
+at pcValue, unless pcKey is already bound, in which case the value is freed.
+Returns 1 if successful, 0 if insufficient memory*/
+static int SymTable_loadBinding(SymTable_T oSymTable, const char *pcKey,
+    const char *pcValue, size_t uLength, const struct Load *psLoad){
+    void *pvValue = NULL;
+
+    if (psLoad->parseValue != NULL)
+        pvValue = (*psLoad->parseValue)(pcValue, uLength, (void *)psLoad->extra);
+    if (SymTable_put(oSymTable, pcKey, pvValue))
+        return 1;
+    if (psLoad->freeValue != NULL)
+        (*psLoad->freeValue)(pvValue);
+    return SymTable_contains(oSymTable, pcKey);
+}
+
+/*Frees pvValue with the freeValue of the struct Load pvExtra points to*/
+static void SymTable_freeLoaded(const char *pcKey, void *pvValue, void *pvExtra){
+    const struct Load *psLoad = (const struct Load *)pvExtra;
+    (void)pcKey;
+    (*psLoad->freeValue)(pvValue);
+}
+
+/*Binds the key of each line of oFile in oSymTable as SymTable_loadFile does,
+ending the keys with '\0' in the text of oFile if iBorrow is 1 and copying
+them otherwise. Returns 1 if successful, 0 if insufficient memory*/
+static int SymTable_loadLines(SymTable_T oSymTable, SymTableFile_T oFile,
+    enum SymTable_FileFormat eFormat, int iBorrow, const struct Load *psLoad){
+    char *pcLine = oFile->text;
+    char *pcEnd = oFile->text + oFile->length;
+    char *pcLineEnd;
+    char *pcKeyEnd;
+    char *pcContentEnd;
+    const char *pcKey;
+    char *pcBuffer = NULL;
+    char *pcNewBuffer;
+    size_t uBufferSize = 0;
+    size_t uKeyLength;
+    int iSuccessful = 1;
+
+    while (pcLine < pcEnd && iSuccessful){
+        pcLineEnd = (char *)memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        if (pcLineEnd == NULL)
+            pcLineEnd = pcEnd;
+        pcContentEnd = pcLineEnd;
+        if (pcLineEnd != pcLine && pcLineEnd[-1] == '\r')
+            pcContentEnd--;
+        pcKeyEnd = pcContentEnd;
+        if (eFormat == SYMTABLE_FILE_TSV){
+            pcKeyEnd = (char *)memchr(pcLine, '\t',
+                (size_t)(pcContentEnd - pcLine));
+            if (pcKeyEnd == NULL)
+                pcKeyEnd = pcContentEnd;
+        }
+
+        if (pcContentEnd != pcLine){
+            uKeyLength = (size_t)(pcKeyEnd - pcLine);
+            if (iBorrow){
+                /*the text of the file is a private copy, and the byte after
+                the key is a tab, the end of the line or the '\0' after the
+                file*/
+                *pcKeyEnd = '\0';
+                pcKey = pcLine;
+            }
+            else{
+                if (uKeyLength >= uBufferSize){
+                    if (uBufferSize == 0)
+                        uBufferSize = FIRST_KEY_BUFFER_SIZE;
+                    while (uKeyLength >= uBufferSize)
+                        uBufferSize *= 2;
+                    pcNewBuffer = (char *)realloc(pcBuffer, uBufferSize);
+                    if (pcNewBuffer == NULL){
+                        free(pcBuffer);
+                        return 0;
+                    }
+                    pcBuffer = pcNewBuffer;
+                }
+                memcpy(pcBuffer, pcLine, uKeyLength);
+                pcBuffer[uKeyLength] = '\0';
+                pcKey = pcBuffer;
+            }
+            if (pcKeyEnd == pcContentEnd)
+                iSuccessful = SymTable_loadBinding(oSymTable, pcKey,
+                    pcContentEnd, 0, psLoad);
+            else
+                iSuccessful = SymTable_loadBinding(oSymTable, pcKey,
+                    pcKeyEnd + 1, (size_t)(pcContentEnd - pcKeyEnd - 1), psLoad);
+        }
+        pcLine = pcLineEnd + 1;
+    }
+    free(pcBuffer);
+    return iSuccessful;
+}
+
+SymTable_T SymTable_loadFile(const char *pcPath,
+    enum SymTable_FileFormat eFormat,
+    void *(*pfParseValue)(const char *pcValue, size_t uLength, void *pvExtra),
+    void (*pfFreeValue)(void *pvValue), const void *pvExtra,
+    SymTableFile_T *poFile){
+    SymTable_T oSymTable;
+    SymTableFile_T oFile;
+    struct Load sLoad;
+    int iBorrow = (poFile != NULL);
+    assert(pcPath != NULL);
+
+    oFile = SymTable_openFile(pcPath, iBorrow);
+    if (oFile == NULL) return NULL;
+    oSymTable = iBorrow ? SymTable_newBorrowedKeys() : SymTable_newKeyHeap();
+    if (oSymTable == NULL){
+        SymTableFile_close(oFile);
+        return NULL;
+    }
+
+    /*a line holds at most one binding, so a table sized for every line never
+    grows during the load. A table that cannot be sized still grows*/
+    SymTable_presize(oSymTable, SymTable_countLines(oFile->text, oFile->length));
+
+    sLoad.parseValue = pfParseValue;
+    sLoad.freeValue = pfFreeValue;
+    sLoad.extra = pvExtra;
+    if (!SymTable_loadLines(oSymTable, oFile, eFormat, iBorrow, &sLoad)){
+        if (pfFreeValue != NULL)
+            SymTable_map(oSymTable, SymTable_freeLoaded, &sLoad);
+        SymTable_free(oSymTable);
+        SymTableFile_close(oFile);
+        return NULL;
+    }
+
+    if (iBorrow)
+        *poFile = oFile;
+    else
+        SymTableFile_close(oFile);
+    return oSymTable;
+}
+
+void SymTableFile_close(SymTableFile_T oFile){
+    assert(oFile != NULL);
+#ifdef SYMTABLE_MMAP
+    munmap(oFile->text, oFile->mapped);
+#else
+    free(oFile->text);
+#endif
+    free(oFile);
+}
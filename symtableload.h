@@ -0,0 +1,45 @@
+/*--------------------------------------------------------------------*/
+/* symtableload.h                                                     */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLELOAD_INCLUDED
+#define SYMTABLELOAD_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Layouts of the text files SymTable_loadFile reads. Each line holds one binding
+and ends with "\n" or "\r\n", except perhaps the last. With SYMTABLE_FILE_TSV
+the key is the text before the first tab of the line and the value the text
+after it, a line without a tab having an empty value. With SYMTABLE_FILE_KEYS
+the key is the whole line and the value is empty. Empty lines are skipped*/
+enum SymTable_FileFormat {SYMTABLE_FILE_TSV, SYMTABLE_FILE_KEYS};
+
+/*Creates an alias SymTableFile_T as an opaque pointer to a file loaded into
+memory, which holds the keys of a table that SymTable_loadFile made with
+borrowed keys*/
+typedef struct SymTableFile *SymTableFile_T;
+
+/*Creates and returns a Symbol Table with a binding for each line of the file at
+pcPath, laid out as eFormat says. The value of a binding is what pfParseValue
+returns when given the uLength bytes of the value text at pcValue, which need
+not be followed by a '\0', and pvExtra, or NULL if pfParseValue is NULL. A key
+on more than one line is bound to the value of its first line, and the value
+of each later line is passed to pfFreeValue unless pfFreeValue is NULL. If
+poFile is NULL the table is made like SymTable_newKeyHeap. Otherwise it is made
+like SymTable_newBorrowedKeys, with keys that point into a private copy of the
+file in memory that is stored in *poFile, and that must be closed by
+SymTableFile_close once the table and all its clones are freed. Returns NULL if
+the file cannot be read or if insufficient memory, in which case every value
+parsed has been passed to pfFreeValue*/
+SymTable_T SymTable_loadFile(const char *pcPath,
+    enum SymTable_FileFormat eFormat,
+    void *(*pfParseValue)(const char *pcValue, size_t uLength, void *pvExtra),
+    void (*pfFreeValue)(void *pvValue), const void *pvExtra,
+    SymTableFile_T *poFile);
+
+/*Frees all the memory associated with oFile*/
+void SymTableFile_close(SymTableFile_T oFile);
+
+#endif
@@ -0,0 +1,204 @@
+/*--------------------------------------------------------------------*/
+/* symtablelru.c                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtablelru.h"
+
+/* Represents a binding of an LRU cache. It is the value of its key in the
+table of the cache, and its key is stored after it, where the table borrows
+it from*/
+struct Entry{
+    /*value of the binding that is a void pointer*/
+    const void *value;
+
+    /*next more recently used entry, NULL for the most recently used*/
+    struct Entry *newer;
+
+    /*next less recently used entry, NULL for the least recently used*/
+    struct Entry *older;
+};
+
+/* Represents an LRU cache*/
+struct SymTableLRU{
+    /*table from each key to its entry, borrowing the keys of the entries*/
+    SymTable_T table;
+
+    /*largest number of bindings*/
+    size_t maxBindings;
+
+    /*most and least recently used entries, NULL if the cache is empty*/
+    struct Entry *newest;
+    struct Entry *oldest;
+
+    /*function called with each binding that is evicted, or NULL*/
+    void (*evict)(const char *pcKey, void *pvValue);
+};
+
+/*Returns the key of psEntry*/
+static const char *SymTableLRU_key(struct Entry *psEntry){
+    return (const char *)(psEntry + 1);
+}
+
+/*Takes psEntry out of the recency list of oSymTableLRU*/
+static void SymTableLRU_unlink(SymTableLRU_T oSymTableLRU,
+    struct Entry *psEntry){
+    if (psEntry->newer != NULL)
+        psEntry->newer->older = psEntry->older;
+    else
+        oSymTableLRU->newest = psEntry->older;
+    if (psEntry->older != NULL)
+        psEntry->older->newer = psEntry->newer;
+    else
+        oSymTableLRU->oldest = psEntry->newer;
+}
+
+/*Puts psEntry at the front of the recency list of oSymTableLRU, as the most
+recently used*/
+static void SymTableLRU_pushFront(SymTableLRU_T oSymTableLRU,
+    struct Entry *psEntry){
+    psEntry->newer = NULL;
+    psEntry->older = oSymTableLRU->newest;
+    if (oSymTableLRU->newest != NULL)
+        oSymTableLRU->newest->newer = psEntry;
+    else
+        oSymTableLRU->oldest = psEntry;
+    oSymTableLRU->newest = psEntry;
+}
+
+/*Makes psEntry the most recently used entry of oSymTableLRU*/
+static void SymTableLRU_touch(SymTableLRU_T oSymTableLRU,
+    struct Entry *psEntry){
+    if (psEntry == oSymTableLRU->newest) return;
+    SymTableLRU_unlink(oSymTableLRU, psEntry);
+    SymTableLRU_pushFront(oSymTableLRU, psEntry);
+}
+
+SymTableLRU_T SymTable_newLRU(size_t uMaxBindings,
+    void (*pfEvict)(const char *pcKey, void *pvValue)){
+    SymTableLRU_T oSymTableLRU;
+    assert(uMaxBindings > 0);
+
+    oSymTableLRU = (SymTableLRU_T)malloc(sizeof(struct SymTableLRU));
+    if (oSymTableLRU == NULL) return NULL;
+    oSymTableLRU->table = SymTable_newBorrowedKeys();
+    if (oSymTableLRU->table == NULL){
+        free(oSymTableLRU);
+        return NULL;
+    }
+    oSymTableLRU->maxBindings = uMaxBindings;
+    oSymTableLRU->newest = NULL;
+    oSymTableLRU->oldest = NULL;
+    oSymTableLRU->evict = pfEvict;
+    return oSymTableLRU;
+}
+
+void SymTableLRU_free(SymTableLRU_T oSymTableLRU){
+    struct Entry *psEntry;
+    struct Entry *psOlder;
+    assert(oSymTableLRU != NULL);
+
+    /*the table borrows the keys of the entries, so it goes first*/
+    SymTable_free(oSymTableLRU->table);
+    for (psEntry = oSymTableLRU->newest; psEntry != NULL; psEntry = psOlder){
+        psOlder = psEntry->older;
+        free(psEntry);
+    }
+    free(oSymTableLRU);
+}
+
+size_t SymTableLRU_getLength(SymTableLRU_T oSymTableLRU){
+    assert(oSymTableLRU != NULL);
+    return SymTable_getLength(oSymTableLRU->table);
+}
+
+int SymTableLRU_put(SymTableLRU_T oSymTableLRU,
+    const char *pcKey, const void *pvValue){
+    struct Entry *psEntry;
+    struct Entry *psOldest;
+    assert(oSymTableLRU != NULL && pcKey != NULL);
+
+    /*the table borrows the key of the entry, so the entry is made before the
+    put, which is the only lookup of pcKey and fails if it is a duplicate*/
+    psEntry = (struct Entry *)malloc(sizeof(struct Entry) + strlen(pcKey) + 1);
+    if (psEntry == NULL) return 0;
+    strcpy((char *)(psEntry + 1), pcKey);
+    psEntry->value = pvValue;
+
+    if (!SymTable_put(oSymTableLRU->table, SymTableLRU_key(psEntry), psEntry)){
+        free(psEntry);
+        return 0;
+    }
+
+    /*evicts only once the put has succeeded, so that a put that fails leaves
+    the cache unchanged*/
+    if (SymTable_getLength(oSymTableLRU->table) > oSymTableLRU->maxBindings){
+        psOldest = oSymTableLRU->oldest;
+        SymTableLRU_unlink(oSymTableLRU, psOldest);
+        SymTable_remove(oSymTableLRU->table, SymTableLRU_key(psOldest));
+        if (oSymTableLRU->evict != NULL)
+            (*oSymTableLRU->evict)(SymTableLRU_key(psOldest),
+                (void *)psOldest->value);
+        free(psOldest);
+    }
+
+    SymTableLRU_pushFront(oSymTableLRU, psEntry);
+    return 1;
+}
+
+void *SymTableLRU_replace(SymTableLRU_T oSymTableLRU,
+    const char *pcKey, const void *pvValue){
+    struct Entry *psEntry;
+    const void *pvOld;
+    assert(oSymTableLRU != NULL && pcKey != NULL);
+
+    psEntry = (struct Entry *)SymTable_get(oSymTableLRU->table, pcKey);
+    if (psEntry == NULL) return NULL;
+    SymTableLRU_touch(oSymTableLRU, psEntry);
+    pvOld = psEntry->value;
+    psEntry->value = pvValue;
+    return (void *)pvOld;
+}
+
+int SymTableLRU_contains(SymTableLRU_T oSymTableLRU, const char *pcKey){
+    assert(oSymTableLRU != NULL && pcKey != NULL);
+    return SymTable_contains(oSymTableLRU->table, pcKey);
+}
+
+void *SymTableLRU_get(SymTableLRU_T oSymTableLRU, const char *pcKey){
+    struct Entry *psEntry;
+    assert(oSymTableLRU != NULL && pcKey != NULL);
+
+    psEntry = (struct Entry *)SymTable_get(oSymTableLRU->table, pcKey);
+    if (psEntry == NULL) return NULL;
+    SymTableLRU_touch(oSymTableLRU, psEntry);
+    return (void *)psEntry->value;
+}
+
+void *SymTableLRU_remove(SymTableLRU_T oSymTableLRU, const char *pcKey){
+    struct Entry *psEntry;
+    const void *pvOld;
+    assert(oSymTableLRU != NULL && pcKey != NULL);
+
+    psEntry = (struct Entry *)SymTable_remove(oSymTableLRU->table, pcKey);
+    if (psEntry == NULL) return NULL;
+    SymTableLRU_unlink(oSymTableLRU, psEntry);
+    pvOld = psEntry->value;
+    free(psEntry);
+    return (void *)pvOld;
+}
+
+void SymTableLRU_map(SymTableLRU_T oSymTableLRU,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        struct Entry *psEntry;
+        assert(oSymTableLRU != NULL && pfApply != NULL);
+
+        for (psEntry = oSymTableLRU->newest; psEntry != NULL; psEntry = psEntry->older)
+            (*pfApply)(SymTableLRU_key(psEntry), (void *)psEntry->value,
+                (void *)pvExtra);
+}
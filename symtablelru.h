@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------*/
+/* symtablelru.h                                                      */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLELRU_INCLUDED
+#define SYMTABLELRU_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Creates an alias SymTableLRU_T as an opaque pointer to an LRU cache. An LRU
+cache is a symbol table of bounded size that keeps its bindings in order of
+use. Once it is full, putting a binding evicts the binding used least recently*/
+typedef struct SymTableLRU *SymTableLRU_T;
+
+/*Creates and returns an empty LRU cache that holds at most uMaxBindings
+bindings. pfEvict, unless it is NULL, is called with the key and value of each
+binding that is evicted, after the binding has left the cache, so that it can
+free the value. uMaxBindings must be positive. Returns NULL if insufficient
+memory*/
+SymTableLRU_T SymTable_newLRU(size_t uMaxBindings,
+    void (*pfEvict)(const char *pcKey, void *pvValue));
+
+/*Frees all the memory associated with oSymTableLRU. pfEvict is not called,
+the values can be freed by a map first*/
+void SymTableLRU_free(SymTableLRU_T oSymTableLRU);
+
+/*Returns number of bindings in oSymTableLRU*/
+size_t SymTableLRU_getLength(SymTableLRU_T oSymTableLRU);
+
+/*Inserts new binding with pcKey and pvValue into oSymTableLRU as the most
+recently used, then evicts the least recently used binding if oSymTableLRU
+holds more than its maximum. Returns 0 if pcKey is already in oSymTableLRU or
+if insufficient memory, in which case nothing is evicted, 1 if succesful*/
+int SymTableLRU_put(SymTableLRU_T oSymTableLRU,
+    const char *pcKey, const void *pvValue);
+
+/*Replaces the value in oSymTableLRU associated with pcKey with pvValue, makes
+the binding the most recently used and returns old value. Returns NULL if pcKey
+is not in oSymTableLRU*/
+void *SymTableLRU_replace(SymTableLRU_T oSymTableLRU,
+    const char *pcKey, const void *pvValue);
+
+/*Returns 1 if there is a binding with pcKey in oSymTableLRU, returns 0 if
+there is not. Does not count as a use of the binding*/
+int SymTableLRU_contains(SymTableLRU_T oSymTableLRU, const char *pcKey);
+
+/*Returns the value associated with pcKey in oSymTableLRU, and makes the
+binding the most recently used. Returns NULL if pcKey is not in oSymTableLRU*/
+void *SymTableLRU_get(SymTableLRU_T oSymTableLRU, const char *pcKey);
+
+/*Removes the binding with pcKey if it exists in oSymTableLRU, returns value
+of binding without calling pfEvict. Returns NULL if pcKey is not in
+oSymTableLRU*/
+void *SymTableLRU_remove(SymTableLRU_T oSymTableLRU, const char *pcKey);
+
+/*Applies the function pfApply to all bindings in oSymTableLRU from the most
+to the least recently used, passes pvExtra as an argument of pfApply.
+pfApply must not change oSymTableLRU*/
+void SymTableLRU_map(SymTableLRU_T oSymTableLRU,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+#endif
@@ -0,0 +1,307 @@
+/*--------------------------------------------------------------------*/
+/* symtablescope.c                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "symtablescope.h"
+
+/*base 2 logarithm of the number of buckets of the index of new scopes*/
+static const size_t INITIAL_BUCKET_BITS = 4;
+
+/*odd multiplier close to 2^64 divided by the golden ratio, spreads the address
+of a binding over the high bits, which pick its bucket*/
+static const unsigned long long ADDRESS_MULTIPLIER = 11400714819323198485ULL;
+
+/* Represents a binding put in a scope other than the outermost*/
+struct Record{
+    /*the binding, which the record is found by*/
+    const void *binding;
+
+    /*binding with the same key in an outer scope that the binding hides, or
+    NULL*/
+    void *shadowed;
+
+    /*depth of the scope the binding is in, at least 1*/
+    size_t depth;
+
+    /*records added to the same scope just before and just after this one,
+    NULL for the first and the last*/
+    struct Record *older;
+    struct Record *newer;
+
+    /*next record in the same bucket of the index, or next spare record*/
+    struct Record *indexNext;
+};
+
+/* Represents the open scopes of a symbol table*/
+struct SymTableScopes{
+    /*depth of the innermost scope, 0 when only the outermost scope is open*/
+    size_t depth;
+
+    /*number of entries allocated in lasts*/
+    size_t lastsCapacity;
+
+    /*lasts[d] is the record added last to open scope d, for 1 <= d <= depth*/
+    struct Record **lasts;
+
+    /*index of the records by the address of their binding, a hash table of
+    2 to the bucketBits buckets that holds at most one record per bucket on
+    average*/
+    struct Record **buckets;
+    size_t bucketBits;
+
+    /*number of records in the index*/
+    size_t numOfRecords;
+
+    /*records that are in no scope, which add uses instead of allocating,
+    linked through indexNext*/
+    struct Record *spares;
+
+    /*number of records in spares*/
+    size_t numOfSpares;
+};
+
+/*Returns the bucket of pvBinding in an index of 2 to the uBits buckets*/
+static size_t SymTableScopes_bucket(const void *pvBinding, size_t uBits){
+    unsigned long long ullMixed;
+
+    ullMixed = (unsigned long long)(uintptr_t)pvBinding * ADDRESS_MULTIPLIER;
+    return (size_t)(ullMixed >> (64 - uBits));
+}
+
+/*Returns the address of the pointer to the record of pvBinding in the index
+of oScopes, or of the NULL pointer that ends its bucket if there is none*/
+static struct Record **SymTableScopes_find(SymTableScopes_T oScopes,
+    const void *pvBinding){
+    struct Record **link;
+
+    link = &oScopes->buckets[SymTableScopes_bucket(pvBinding,
+        oScopes->bucketBits)];
+    while (*link != NULL && (*link)->binding != pvBinding)
+        link = &(*link)->indexNext;
+    return link;
+}
+
+/*Takes the record *link out of the index and its scope of oScopes and makes
+it a spare*/
+static void SymTableScopes_forget(SymTableScopes_T oScopes,
+    struct Record **link){
+    struct Record *psRecord = *link;
+
+    *link = psRecord->indexNext;
+    oScopes->numOfRecords--;
+    if (psRecord->newer != NULL)
+        psRecord->newer->older = psRecord->older;
+    else
+        oScopes->lasts[psRecord->depth] = psRecord->older;
+    if (psRecord->older != NULL)
+        psRecord->older->newer = psRecord->newer;
+    psRecord->indexNext = oScopes->spares;
+    oScopes->spares = psRecord;
+    oScopes->numOfSpares++;
+}
+
+/*Moves the records of oScopes into a new index of 2 to the uBits buckets.
+Returns 1 if successful, 0 if insufficient memory, leaving the index alone*/
+static int SymTableScopes_rehash(SymTableScopes_T oScopes, size_t uBits){
+    struct Record **newBuckets;
+    struct Record *psRecord;
+    struct Record *psNext;
+    size_t uBucket;
+    size_t i;
+
+    newBuckets = (struct Record **)calloc((size_t)1 << uBits,
+        sizeof(struct Record *));
+    if (newBuckets == NULL) return 0;
+    for (i = 0; i < (size_t)1 << oScopes->bucketBits; i++){
+        for (psRecord = oScopes->buckets[i]; psRecord != NULL;
+            psRecord = psNext){
+            psNext = psRecord->indexNext;
+            uBucket = SymTableScopes_bucket(psRecord->binding, uBits);
+            psRecord->indexNext = newBuckets[uBucket];
+            newBuckets[uBucket] = psRecord;
+        }
+    }
+    free(oScopes->buckets);
+    oScopes->buckets = newBuckets;
+    oScopes->bucketBits = uBits;
+    return 1;
+}
+
+SymTableScopes_T SymTableScopes_new(void){
+    SymTableScopes_T oScopes;
+
+    oScopes = (SymTableScopes_T)malloc(sizeof(struct SymTableScopes));
+    if (oScopes == NULL) return NULL;
+    oScopes->buckets = (struct Record **)calloc(
+        (size_t)1 << INITIAL_BUCKET_BITS, sizeof(struct Record *));
+    if (oScopes->buckets == NULL){
+        free(oScopes);
+        return NULL;
+    }
+    oScopes->bucketBits = INITIAL_BUCKET_BITS;
+    oScopes->depth = 0;
+    oScopes->lastsCapacity = 0;
+    oScopes->lasts = NULL;
+    oScopes->numOfRecords = 0;
+    oScopes->spares = NULL;
+    oScopes->numOfSpares = 0;
+    return oScopes;
+}
+
+void SymTableScopes_free(SymTableScopes_T oScopes){
+    struct Record *psRecord;
+    struct Record *psNext;
+
+    if (oScopes == NULL) return;
+    SymTableScopes_clear(oScopes);
+    for (psRecord = oScopes->spares; psRecord != NULL; psRecord = psNext){
+        psNext = psRecord->indexNext;
+        free(psRecord);
+    }
+    free(oScopes->buckets);
+    free(oScopes->lasts);
+    free(oScopes);
+}
+
+size_t SymTableScopes_getDepth(SymTableScopes_T oScopes){
+    if (oScopes == NULL) return 0;
+    return oScopes->depth;
+}
+
+int SymTableScopes_push(SymTableScopes_T oScopes){
+    struct Record **newLasts;
+    size_t newCapacity;
+    assert(oScopes != NULL);
+
+    if (oScopes->depth + 1 >= oScopes->lastsCapacity){
+        newCapacity = 2 * oScopes->lastsCapacity + 2;
+        newLasts = (struct Record **)realloc(oScopes->lasts,
+            sizeof(struct Record *) * newCapacity);
+        if (newLasts == NULL) return 0;
+        oScopes->lasts = newLasts;
+        oScopes->lastsCapacity = newCapacity;
+    }
+    oScopes->depth++;
+    oScopes->lasts[oScopes->depth] = NULL;
+    return 1;
+}
+
+void *SymTableScopes_last(SymTableScopes_T oScopes){
+    if (oScopes == NULL || oScopes->depth == 0) return NULL;
+    if (oScopes->lasts[oScopes->depth] == NULL) return NULL;
+    return (void *)oScopes->lasts[oScopes->depth]->binding;
+}
+
+void SymTableScopes_pop(SymTableScopes_T oScopes){
+    assert(oScopes != NULL && oScopes->depth > 0);
+
+    while (oScopes->lasts[oScopes->depth] != NULL)
+        SymTableScopes_forget(oScopes, SymTableScopes_find(oScopes,
+            oScopes->lasts[oScopes->depth]->binding));
+    oScopes->depth--;
+}
+
+int SymTableScopes_reserve(SymTableScopes_T oScopes, size_t uCount){
+    struct Record *psRecord;
+    size_t uBits;
+    assert(oScopes != NULL);
+
+    /*the index grows before add could make it hold more than one record per
+    bucket on average*/
+    uBits = oScopes->bucketBits;
+    while (((size_t)1 << uBits) < oScopes->numOfRecords + uCount)
+        uBits++;
+    if (uBits != oScopes->bucketBits &&
+        !SymTableScopes_rehash(oScopes, uBits))
+        return 0;
+
+    while (oScopes->numOfSpares < uCount){
+        psRecord = (struct Record *)malloc(sizeof(struct Record));
+        if (psRecord == NULL) return 0;
+        psRecord->indexNext = oScopes->spares;
+        oScopes->spares = psRecord;
+        oScopes->numOfSpares++;
+    }
+    return 1;
+}
+
+void SymTableScopes_add(SymTableScopes_T oScopes, const void *pvBinding,
+    size_t uDepth, void *pvShadowed){
+    struct Record *psRecord;
+    size_t uBucket;
+    assert(oScopes != NULL && oScopes->numOfSpares > 0);
+    assert(uDepth > 0 && uDepth <= oScopes->depth);
+
+    psRecord = oScopes->spares;
+    oScopes->spares = psRecord->indexNext;
+    oScopes->numOfSpares--;
+
+    psRecord->binding = pvBinding;
+    psRecord->shadowed = pvShadowed;
+    psRecord->depth = uDepth;
+    uBucket = SymTableScopes_bucket(pvBinding, oScopes->bucketBits);
+    psRecord->indexNext = oScopes->buckets[uBucket];
+    oScopes->buckets[uBucket] = psRecord;
+    oScopes->numOfRecords++;
+
+    psRecord->older = oScopes->lasts[uDepth];
+    psRecord->newer = NULL;
+    if (psRecord->older != NULL)
+        psRecord->older->newer = psRecord;
+    oScopes->lasts[uDepth] = psRecord;
+}
+
+size_t SymTableScopes_depthOf(SymTableScopes_T oScopes, const void *pvBinding){
+    struct Record *psRecord;
+
+    if (oScopes == NULL || oScopes->numOfRecords == 0) return 0;
+    psRecord = *SymTableScopes_find(oScopes, pvBinding);
+    if (psRecord == NULL) return 0;
+    return psRecord->depth;
+}
+
+void *SymTableScopes_shadowed(SymTableScopes_T oScopes, const void *pvBinding){
+    struct Record *psRecord;
+
+    if (oScopes == NULL || oScopes->numOfRecords == 0) return NULL;
+    psRecord = *SymTableScopes_find(oScopes, pvBinding);
+    if (psRecord == NULL) return NULL;
+    return psRecord->shadowed;
+}
+
+void *SymTableScopes_remove(SymTableScopes_T oScopes, const void *pvBinding){
+    struct Record **link;
+    void *pvShadowed;
+
+    if (oScopes == NULL || oScopes->numOfRecords == 0) return NULL;
+    link = SymTableScopes_find(oScopes, pvBinding);
+    if (*link == NULL) return NULL;
+    pvShadowed = (*link)->shadowed;
+    SymTableScopes_forget(oScopes, link);
+    return pvShadowed;
+}
+
+void SymTableScopes_clear(SymTableScopes_T oScopes){
+    struct Record *psRecord;
+    struct Record *psNext;
+    size_t i;
+
+    if (oScopes == NULL) return;
+    for (i = 0; i < (size_t)1 << oScopes->bucketBits; i++){
+        for (psRecord = oScopes->buckets[i]; psRecord != NULL;
+            psRecord = psNext){
+            psNext = psRecord->indexNext;
+            psRecord->indexNext = oScopes->spares;
+            oScopes->spares = psRecord;
+            oScopes->numOfSpares++;
+        }
+        oScopes->buckets[i] = NULL;
+    }
+    oScopes->numOfRecords = 0;
+    oScopes->depth = 0;
+}
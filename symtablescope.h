@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------*/
+/* symtablescope.h                                                    */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESCOPE_INCLUDED
+#define SYMTABLESCOPE_INCLUDED
+
+#include <stddef.h>
+
+/*Creates an alias SymTableScopes_T as an opaque pointer to the open scopes of
+a symbol table: for each binding put in a scope other than the outermost, the
+depth of that scope and the binding it hides. An implementation of SymTable
+makes one on its first pushScope, so that the bindings of a table that never
+opens a scope carry nothing for scopes. Bindings are known by their address,
+and a binding that the scopes do not know is in the outermost scope and hides
+nothing. Every function below that takes a SymTableScopes_T accepts NULL, for
+the scopes of a table that has never opened one, unless it says otherwise*/
+typedef struct SymTableScopes *SymTableScopes_T;
+
+/*Creates and returns scopes with only the outermost scope open. Returns NULL if
+insufficient memory*/
+SymTableScopes_T SymTableScopes_new(void);
+
+/*Frees all the memory associated with oScopes, but none of its bindings*/
+void SymTableScopes_free(SymTableScopes_T oScopes);
+
+/*Returns the depth of the innermost scope of oScopes, 0 when only the
+outermost scope is open*/
+size_t SymTableScopes_getDepth(SymTableScopes_T oScopes);
+
+/*Opens a new innermost scope in oScopes, which must not be NULL. Returns 1 if
+successful, 0 if insufficient memory*/
+int SymTableScopes_push(SymTableScopes_T oScopes);
+
+/*Returns the binding of the innermost scope of oScopes added last, NULL if
+the scope has none left or is the outermost*/
+void *SymTableScopes_last(SymTableScopes_T oScopes);
+
+/*Closes the innermost scope of oScopes, which must not be the outermost, and
+forgets the bindings still in it*/
+void SymTableScopes_pop(SymTableScopes_T oScopes);
+
+/*Makes room in oScopes for uCount more bindings, so that the next uCount
+calls of SymTableScopes_add do not allocate. Returns 1 if successful, 0 if
+insufficient memory*/
+int SymTableScopes_reserve(SymTableScopes_T oScopes, size_t uCount);
+
+/*Records that pvBinding, which oScopes does not know, is in the open scope at
+depth uDepth and hides pvShadowed, or nothing if pvShadowed is NULL. oScopes
+must not be NULL, uDepth must be positive, and room must have been reserved*/
+void SymTableScopes_add(SymTableScopes_T oScopes, const void *pvBinding,
+    size_t uDepth, void *pvShadowed);
+
+/*Returns the depth of the scope pvBinding is in, 0 if oScopes does not know
+it*/
+size_t SymTableScopes_depthOf(SymTableScopes_T oScopes, const void *pvBinding);
+
+/*Returns the binding pvBinding hides, NULL if it hides none*/
+void *SymTableScopes_shadowed(SymTableScopes_T oScopes, const void *pvBinding);
+
+/*Forgets pvBinding, which is being removed from its table, and returns the
+binding it hid, NULL if it hid none*/
+void *SymTableScopes_remove(SymTableScopes_T oScopes, const void *pvBinding);
+
+/*Forgets every binding of oScopes and closes every scope but the outermost,
+keeping the memory for scopes opened later*/
+void SymTableScopes_clear(SymTableScopes_T oScopes);
+
+#endif
@@ -0,0 +1,399 @@
+/*--------------------------------------------------------------------*/
+/* symtablesharded.c                                                  */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stddef.h>
+#include <limits.h>
+#include "symtablesharded.h"
+
+/*shards are locked with POSIX mutexes where the system has them, building
+with -DSYMTABLE_NO_THREADS makes a table for one thread only*/
+#if defined(__unix__) && !defined(SYMTABLE_NO_THREADS)
+#include <pthread.h>
+#include <unistd.h>
+#define SYMTABLE_THREADS
+#endif
+
+/*bytes in a cache line, shards are padded so that two locks never share one*/
+enum {CACHE_LINE_SIZE = 64};
+
+/*odd multiplier close to 2^64 divided by the golden ratio, spreads the hash
+of a key into the high bits that pick its shard*/
+static const size_t SHARD_MULTIPLIER = (size_t)11400714819323198485UL;
+
+/* Represents one shard of a sharded table*/
+struct Shard{
+#ifdef SYMTABLE_THREADS
+    /*held by the thread using table*/
+    pthread_mutex_t lock;
+#endif
+
+    /*bindings whose key hashes to this shard*/
+    SymTable_T table;
+
+    /*keeps the next shard out of the cache lines of this one*/
+    char padding[CACHE_LINE_SIZE];
+};
+
+/* Represents a sharded symbol table*/
+struct SymTableSharded{
+    /*number of shards, a power of 2*/
+    size_t numOfShards;
+
+    /*base 2 logarithm of numOfShards*/
+    unsigned shardBits;
+
+    /*array of numOfShards shards*/
+    struct Shard *shards;
+};
+
+/* Represents the work of one thread of SymTableSharded_mapParallel*/
+struct ShardMap{
+    /*first of the shards to map*/
+    struct Shard *shards;
+
+    /*number of shards to map, one after another*/
+    size_t count;
+
+    /*function applied to each binding of the shards*/
+    void (*apply)(const char *pcKey, void *pvValue, void *pvExtra);
+
+    /*extra argument of apply*/
+    const void *extra;
+};
+
+/*Locks psShard for the calling thread*/
+static void SymTable_lock(struct Shard *psShard){
+#ifdef SYMTABLE_THREADS
+    pthread_mutex_lock(&psShard->lock);
+#else
+    (void)psShard;
+#endif
+}
+
+/*Unlocks psShard, which the calling thread locked*/
+static void SymTable_unlock(struct Shard *psShard){
+#ifdef SYMTABLE_THREADS
+    pthread_mutex_unlock(&psShard->lock);
+#else
+    (void)psShard;
+#endif
+}
+
+/*Returns the shard of oSymTableSharded that holds pcKey, picked by the high
+bits of a hash of pcKey so that it does not depend on the low bits the table
+of the shard picks its buckets with*/
+static struct Shard *SymTable_shard(SymTableSharded_T oSymTableSharded,
+    const char *pcKey){
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t uHash = 0;
+    size_t u;
+
+    if (oSymTableSharded->shardBits == 0) return oSymTableSharded->shards;
+    for (u = 0; pcKey[u] != '\0'; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+    uHash *= SHARD_MULTIPLIER;
+    return &oSymTableSharded->shards[uHash >>
+        (sizeof(size_t) * CHAR_BIT - oSymTableSharded->shardBits)];
+}
+
+#ifdef SYMTABLE_THREADS
+/*Returns uThreadCount, or the number of processors online if that is fewer,
+since more threads than processors would only take turns on them*/
+static size_t SymTable_capThreads(size_t uThreadCount){
+#ifdef _SC_NPROCESSORS_ONLN
+    long lOnline = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (lOnline > 0 && (unsigned long)lOnline < uThreadCount)
+        uThreadCount = (size_t)lOnline;
+#endif
+    return uThreadCount;
+}
+
+/*Maps the shards of the struct ShardMap pvShardMap. Runs on its own thread for
+SymTableSharded_mapParallel, and returns NULL*/
+static void *SymTable_mapShards(void *pvShardMap){
+    struct ShardMap *psShardMap = (struct ShardMap *)pvShardMap;
+    size_t i;
+
+    for (i = 0; i < psShardMap->count; i++){
+        SymTable_lock(&psShardMap->shards[i]);
+        SymTable_map(psShardMap->shards[i].table, psShardMap->apply,
+            psShardMap->extra);
+        SymTable_unlock(&psShardMap->shards[i]);
+    }
+    return NULL;
+}
+#endif
+
+SymTableSharded_T SymTableSharded_new(size_t uShardCount){
+    SymTableSharded_T oSymTableSharded;
+    size_t i;
+    assert(uShardCount > 0 && (uShardCount & (uShardCount - 1)) == 0);
+
+    oSymTableSharded = (SymTableSharded_T)malloc(sizeof(struct SymTableSharded));
+    if (oSymTableSharded == NULL) return NULL;
+    oSymTableSharded->shards =
+        (struct Shard *)malloc(sizeof(struct Shard) * uShardCount);
+    if (oSymTableSharded->shards == NULL){
+        free(oSymTableSharded);
+        return NULL;
+    }
+    oSymTableSharded->numOfShards = uShardCount;
+    oSymTableSharded->shardBits = 0;
+    while (((size_t)1 << oSymTableSharded->shardBits) < uShardCount)
+        oSymTableSharded->shardBits++;
+
+    for (i = 0; i < uShardCount; i++){
+        oSymTableSharded->shards[i].table = SymTable_new();
+        if (oSymTableSharded->shards[i].table == NULL){
+            while (i-- > 0){
+                SymTable_free(oSymTableSharded->shards[i].table);
+#ifdef SYMTABLE_THREADS
+                pthread_mutex_destroy(&oSymTableSharded->shards[i].lock);
+#endif
+            }
+            free(oSymTableSharded->shards);
+            free(oSymTableSharded);
+            return NULL;
+        }
+#ifdef SYMTABLE_THREADS
+        pthread_mutex_init(&oSymTableSharded->shards[i].lock, NULL);
+#endif
+    }
+    return oSymTableSharded;
+}
+
+void SymTableSharded_free(SymTableSharded_T oSymTableSharded){
+    size_t i;
+
+    if (oSymTableSharded == NULL) return;
+    for (i = 0; i < oSymTableSharded->numOfShards; i++){
+        SymTable_free(oSymTableSharded->shards[i].table);
+#ifdef SYMTABLE_THREADS
+        pthread_mutex_destroy(&oSymTableSharded->shards[i].lock);
+#endif
+    }
+    free(oSymTableSharded->shards);
+    free(oSymTableSharded);
+}
+
+size_t SymTableSharded_getLength(SymTableSharded_T oSymTableSharded){
+    size_t uLength = 0;
+    size_t i;
+    assert(oSymTableSharded != NULL);
+
+    for (i = 0; i < oSymTableSharded->numOfShards; i++){
+        SymTable_lock(&oSymTableSharded->shards[i]);
+        uLength += SymTable_getLength(oSymTableSharded->shards[i].table);
+        SymTable_unlock(&oSymTableSharded->shards[i]);
+    }
+    return uLength;
+}
+
+int SymTableSharded_put(SymTableSharded_T oSymTableSharded,
+    const char *pcKey, const void *pvValue){
+    struct Shard *psShard;
+    int iSuccessful;
+    assert(oSymTableSharded != NULL && pcKey != NULL);
+
+    psShard = SymTable_shard(oSymTableSharded, pcKey);
+    SymTable_lock(psShard);
+    iSuccessful = SymTable_put(psShard->table, pcKey, pvValue);
+    SymTable_unlock(psShard);
+    return iSuccessful;
+}
+
+void *SymTableSharded_replace(SymTableSharded_T oSymTableSharded,
+    const char *pcKey, const void *pvValue){
+    struct Shard *psShard;
+    void *pvOld;
+    assert(oSymTableSharded != NULL && pcKey != NULL);
+
+    psShard = SymTable_shard(oSymTableSharded, pcKey);
+    SymTable_lock(psShard);
+    pvOld = SymTable_replace(psShard->table, pcKey, pvValue);
+    SymTable_unlock(psShard);
+    return pvOld;
+}
+
+int SymTableSharded_contains(SymTableSharded_T oSymTableSharded,
+    const char *pcKey){
+    struct Shard *psShard;
+    int iFound;
+    assert(oSymTableSharded != NULL && pcKey != NULL);
+
+    psShard = SymTable_shard(oSymTableSharded, pcKey);
+    SymTable_lock(psShard);
+    iFound = SymTable_contains(psShard->table, pcKey);
+    SymTable_unlock(psShard);
+    return iFound;
+}
+
+void *SymTableSharded_get(SymTableSharded_T oSymTableSharded,
+    const char *pcKey){
+    struct Shard *psShard;
+    void *pvValue;
+    assert(oSymTableSharded != NULL && pcKey != NULL);
+
+    psShard = SymTable_shard(oSymTableSharded, pcKey);
+    SymTable_lock(psShard);
+    pvValue = SymTable_get(psShard->table, pcKey);
+    SymTable_unlock(psShard);
+    return pvValue;
+}
+
+void *SymTableSharded_remove(SymTableSharded_T oSymTableSharded,
+    const char *pcKey){
+    struct Shard *psShard;
+    void *pvValue;
+    assert(oSymTableSharded != NULL && pcKey != NULL);
+
+    psShard = SymTable_shard(oSymTableSharded, pcKey);
+    SymTable_lock(psShard);
+    pvValue = SymTable_remove(psShard->table, pcKey);
+    SymTable_unlock(psShard);
+    return pvValue;
+}
+
+void SymTableSharded_map(SymTableSharded_T oSymTableSharded,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        size_t i;
+        assert(oSymTableSharded != NULL && pfApply != NULL);
+
+        for (i = 0; i < oSymTableSharded->numOfShards; i++){
+            SymTable_lock(&oSymTableSharded->shards[i]);
+            SymTable_map(oSymTableSharded->shards[i].table, pfApply, pvExtra);
+            SymTable_unlock(&oSymTableSharded->shards[i]);
+        }
+}
+
+void SymTableSharded_mapPrefix(SymTableSharded_T oSymTableSharded,
+    const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        size_t i;
+        assert(oSymTableSharded != NULL && pcPrefix != NULL && pfApply != NULL);
+
+        for (i = 0; i < oSymTableSharded->numOfShards; i++){
+            SymTable_lock(&oSymTableSharded->shards[i]);
+            SymTable_mapPrefix(oSymTableSharded->shards[i].table, pcPrefix,
+                pfApply, pvExtra);
+            SymTable_unlock(&oSymTableSharded->shards[i]);
+        }
+}
+
+void SymTableSharded_mapParallel(SymTableSharded_T oSymTableSharded,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+#ifdef SYMTABLE_THREADS
+        struct ShardMap *psShardMaps;
+        pthread_t *psThreads;
+        int *piStarted;
+        size_t uThreadCount;
+        size_t uFirst;
+        size_t i;
+        assert(oSymTableSharded != NULL && pfApply != NULL);
+
+        /*one thread for each processor maps a range of shards, the calling
+        thread being one of them*/
+        uThreadCount = SymTable_capThreads(oSymTableSharded->numOfShards);
+        if (uThreadCount == 1){
+            SymTableSharded_map(oSymTableSharded, pfApply, pvExtra);
+            return;
+        }
+        psShardMaps = (struct ShardMap *)malloc(sizeof(struct ShardMap)
+            * uThreadCount);
+        psThreads = (pthread_t *)malloc(sizeof(pthread_t) * uThreadCount);
+        piStarted = (int *)calloc(uThreadCount, sizeof(int));
+        if (psShardMaps == NULL || psThreads == NULL || piStarted == NULL){
+            free(psShardMaps);
+            free(psThreads);
+            free(piStarted);
+            SymTableSharded_map(oSymTableSharded, pfApply, pvExtra);
+            return;
+        }
+
+        for (i = 0; i < uThreadCount; i++){
+            uFirst = i * oSymTableSharded->numOfShards / uThreadCount;
+            psShardMaps[i].shards = &oSymTableSharded->shards[uFirst];
+            psShardMaps[i].count = (i + 1) * oSymTableSharded->numOfShards
+                / uThreadCount - uFirst;
+            psShardMaps[i].apply = pfApply;
+            psShardMaps[i].extra = pvExtra;
+        }
+        for (i = 1; i < uThreadCount; i++)
+            piStarted[i] = pthread_create(&psThreads[i], NULL,
+                SymTable_mapShards, &psShardMaps[i]) == 0;
+        for (i = 0; i < uThreadCount; i++)
+            if (!piStarted[i])
+                SymTable_mapShards(&psShardMaps[i]);
+        for (i = 1; i < uThreadCount; i++)
+            if (piStarted[i])
+                pthread_join(psThreads[i], NULL);
+
+        free(psShardMaps);
+        free(psThreads);
+        free(piStarted);
+#else
+        SymTableSharded_map(oSymTableSharded, pfApply, pvExtra);
+#endif
+}
+
+int SymTableSharded_pushScope(SymTableSharded_T oSymTableSharded){
+    size_t i;
+    int iSuccessful = 1;
+    assert(oSymTableSharded != NULL);
+
+    /*every shard is locked, in order, so that no thread sees some shards in
+    the new scope and others not*/
+    for (i = 0; i < oSymTableSharded->numOfShards; i++)
+        SymTable_lock(&oSymTableSharded->shards[i]);
+    for (i = 0; i < oSymTableSharded->numOfShards && iSuccessful; i++)
+        iSuccessful = SymTable_pushScope(oSymTableSharded->shards[i].table);
+    if (!iSuccessful)
+        for (i--; i-- > 0; )
+            SymTable_popScope(oSymTableSharded->shards[i].table);
+    for (i = oSymTableSharded->numOfShards; i-- > 0; )
+        SymTable_unlock(&oSymTableSharded->shards[i]);
+    return iSuccessful;
+}
+
+int SymTableSharded_popScope(SymTableSharded_T oSymTableSharded){
+    size_t i;
+    int iSuccessful;
+    int iPopped;
+    assert(oSymTableSharded != NULL);
+
+    /*all shards have the same scopes open, so either all of them pop or none,
+    as the first shard tells*/
+    for (i = 0; i < oSymTableSharded->numOfShards; i++)
+        SymTable_lock(&oSymTableSharded->shards[i]);
+    iSuccessful = SymTable_popScope(oSymTableSharded->shards[0].table);
+    if (iSuccessful)
+        for (i = 1; i < oSymTableSharded->numOfShards; i++){
+            iPopped = SymTable_popScope(oSymTableSharded->shards[i].table);
+            assert(iPopped);
+            (void)iPopped;
+        }
+    for (i = oSymTableSharded->numOfShards; i-- > 0; )
+        SymTable_unlock(&oSymTableSharded->shards[i]);
+    return iSuccessful;
+}
+
+void *SymTableSharded_getInnermost(SymTableSharded_T oSymTableSharded,
+    const char *pcKey, size_t *puDepth){
+    struct Shard *psShard;
+    void *pvValue;
+    assert(oSymTableSharded != NULL && pcKey != NULL && puDepth != NULL);
+
+    psShard = SymTable_shard(oSymTableSharded, pcKey);
+    SymTable_lock(psShard);
+    pvValue = SymTable_getInnermost(psShard->table, pcKey, puDepth);
+    SymTable_unlock(psShard);
+    return pvValue;
+}
@@ -0,0 +1,96 @@
+/*--------------------------------------------------------------------*/
+/* symtablesharded.h                                                  */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESHARDED_INCLUDED
+#define SYMTABLESHARDED_INCLUDED
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*Creates an alias SymTableSharded_T as an opaque pointer to a sharded symbol
+table. A sharded symbol table splits its bindings by the high bits of a hash of
+their key among independent SymTables, each behind its own lock, so threads
+that use different shards never wait for each other and a table that grows only
+grows one shard at a time. Every function below may be called by several
+threads at once on the same table, except SymTableSharded_free*/
+typedef struct SymTableSharded *SymTableSharded_T;
+
+/*Creates and returns an empty sharded table of uShardCount shards.
+uShardCount must be a power of 2. Returns NULL if insufficient memory*/
+SymTableSharded_T SymTableSharded_new(size_t uShardCount);
+
+/*Frees all the memory associated with oSymTableSharded. No other thread may be
+using oSymTableSharded*/
+void SymTableSharded_free(SymTableSharded_T oSymTableSharded);
+
+/*Returns number of bindings in oSymTableSharded. Bindings put or removed by
+other threads while it counts may or may not be counted*/
+size_t SymTableSharded_getLength(SymTableSharded_T oSymTableSharded);
+
+/*Inserts new binding with pcKey and pvValue into the innermost scope of
+oSymTableSharded. Returns 0 if pcKey is already in the innermost scope or if
+insufficient memory, 1 if succesful*/
+int SymTableSharded_put(SymTableSharded_T oSymTableSharded,
+    const char *pcKey, const void *pvValue);
+
+/*Replaces the value in oSymTableSharded associated with pcKey with pvValue
+and returns old value. Returns NULL if pcKey is not in oSymTableSharded*/
+void *SymTableSharded_replace(SymTableSharded_T oSymTableSharded,
+    const char *pcKey, const void *pvValue);
+
+/*Returns 1 if there is a binding with pcKey in oSymTableSharded,
+returns 0 if there is not*/
+int SymTableSharded_contains(SymTableSharded_T oSymTableSharded,
+    const char *pcKey);
+
+/*Returns the value associated with pcKey in oSymTableSharded*/
+void *SymTableSharded_get(SymTableSharded_T oSymTableSharded,
+    const char *pcKey);
+
+/*Removes the binding with pcKey if it exists in oSymTableSharded, returns value
+of binding. Returns NULL if pcKey is not in oSymTableSharded*/
+void *SymTableSharded_remove(SymTableSharded_T oSymTableSharded,
+    const char *pcKey);
+
+/*Applies the function pfApply to all bindings in oSymTableSharded one shard
+at a time, passes pvExtra as an argument of pfApply. A shard stays locked while
+pfApply visits it, so pfApply must not use oSymTableSharded*/
+void SymTableSharded_map(SymTableSharded_T oSymTableSharded,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*Applies the function pfApply to the bindings in oSymTableSharded whose key
+starts with pcPrefix, like SymTableSharded_map*/
+void SymTableSharded_mapPrefix(SymTableSharded_T oSymTableSharded,
+    const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*Applies the function pfApply to all bindings in oSymTableSharded like
+SymTableSharded_map, but maps ranges of shards on separate threads at once,
+no more threads than there are shards or processors online, and returns when
+all of them are done. pfApply may thus run on several threads at the same
+time. Shards that no thread can be started for are mapped by the calling
+thread*/
+void SymTableSharded_mapParallel(SymTableSharded_T oSymTableSharded,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*Opens a new innermost scope in oSymTableSharded. Returns 1 if successful, 0
+if insufficient memory*/
+int SymTableSharded_pushScope(SymTableSharded_T oSymTableSharded);
+
+/*Closes the innermost scope of oSymTableSharded, freeing all of its bindings
+and making the bindings they hid visible again. Returns 0 if only the outermost
+scope is open, 1 if successful*/
+int SymTableSharded_popScope(SymTableSharded_T oSymTableSharded);
+
+/*Returns the value of the visible binding with pcKey in oSymTableSharded and
+stores the depth of its scope in *puDepth. Returns NULL and leaves *puDepth
+unchanged if pcKey is not in oSymTableSharded*/
+void *SymTableSharded_getInnermost(SymTableSharded_T oSymTableSharded,
+    const char *pcKey, size_t *puDepth);
+
+#endif
@@ -0,0 +1,102 @@
+/*--------------------------------------------------------------------*/
+/* symtablestatic.c                                                   */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
+#include "symtablestatic.h"
+
+size_t SymTableStatic_hash(const char *pcKey, size_t uSeed)
+{
+   const size_t HASH_MULTIPLIER = (size_t)1099511628211UL;
+   const size_t MIX_MULTIPLIER = (size_t)0xff51afd7ed558ccdUL;
+   size_t u;
+   size_t uHash = (size_t)14695981039346656037UL ^ uSeed;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+      uHash = (uHash ^ (size_t)(unsigned char)pcKey[u]) * HASH_MULTIPLIER;
+
+   /* Spread every key bit over the whole hash code. */
+   uHash ^= uHash >> 33;
+   uHash *= MIX_MULTIPLIER;
+   uHash ^= uHash >> 33;
+   return uHash;
+}
+
+size_t SymTableStatic_bucket(size_t uHash, size_t uSlotCount,
+   size_t uBucketCount)
+{
+   return (uHash / uSlotCount) % uBucketCount;
+}
+
+size_t SymTableStatic_slot(size_t uHash, size_t uDisp, size_t uSlotCount)
+{
+   const size_t GOLDEN_MULTIPLIER = (size_t)0x9e3779b97f4a7c15UL;
+   size_t uF1;
+   size_t uF2;
+   size_t uMixed;
+
+   uMixed = uHash * GOLDEN_MULTIPLIER;
+   uF1 = uHash % uSlotCount;
+   uF2 = (uMixed ^ (uMixed >> 29)) % uSlotCount;
+   return (uF1 + (uDisp / uSlotCount) * uF2 + uDisp % uSlotCount)
+      % uSlotCount;
+}
+
+/*Returns the only slot of oSymTableStatic that can hold pcKey, or NULL if
+oSymTableStatic is empty*/
+static const struct SymTableStaticSlot *SymTableStatic_probe(
+    SymTableStatic_T oSymTableStatic, const char *pcKey){
+    size_t uHash;
+    size_t uBucket;
+    size_t n;
+
+    n = oSymTableStatic->numOfBindings;
+    if (n == 0) return NULL;
+
+    uHash = SymTableStatic_hash(pcKey, oSymTableStatic->seed);
+    uBucket = SymTableStatic_bucket(uHash, n, oSymTableStatic->numOfBuckets);
+    return &oSymTableStatic->slots[SymTableStatic_slot(uHash,
+        oSymTableStatic->displacements[uBucket], n)];
+}
+
+size_t SymTableStatic_getLength(SymTableStatic_T oSymTableStatic){
+    assert(oSymTableStatic != NULL);
+    return oSymTableStatic->numOfBindings;
+}
+
+int SymTableStatic_contains(SymTableStatic_T oSymTableStatic,
+    const char *pcKey){
+    const struct SymTableStaticSlot *psSlot;
+    assert(oSymTableStatic != NULL && pcKey != NULL);
+
+    psSlot = SymTableStatic_probe(oSymTableStatic, pcKey);
+    if (psSlot == NULL) return 0;
+    return strcmp(oSymTableStatic->keys + psSlot->keyOffset, pcKey) == 0;
+}
+
+void *SymTableStatic_get(SymTableStatic_T oSymTableStatic, const char *pcKey){
+    const struct SymTableStaticSlot *psSlot;
+    assert(oSymTableStatic != NULL && pcKey != NULL);
+
+    psSlot = SymTableStatic_probe(oSymTableStatic, pcKey);
+    if (psSlot == NULL) return NULL;
+    if (strcmp(oSymTableStatic->keys + psSlot->keyOffset, pcKey) != 0)
+        return NULL;
+    return (void *)psSlot->value;
+}
+
+void SymTableStatic_map(SymTableStatic_T oSymTableStatic,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+        size_t i;
+        assert(oSymTableStatic != NULL && pfApply != NULL);
+
+        for (i = 0; i < oSymTableStatic->numOfBindings; i++)
+            (*pfApply)(oSymTableStatic->keys + oSymTableStatic->slots[i].keyOffset,
+                (void *)oSymTableStatic->slots[i].value, (void *)pvExtra);
+}
@@ -0,0 +1,78 @@
+/*--------------------------------------------------------------------*/
+/* symtablestatic.h                                                   */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLESTATIC_INCLUDED
+#define SYMTABLESTATIC_INCLUDED
+
+#include <stddef.h>
+
+/* Represents a binding in a static table*/
+struct SymTableStaticSlot{
+    /*offset of the key of the binding in the key storage of the table*/
+    size_t keyOffset;
+
+    /*value of the binding that is a void pointer*/
+    const void *value;
+};
+
+/*Represents a read-only symbol table indexed by a minimal perfect hash. The
+fields are public so that symtablegen can emit a static table as a const
+initializer, clients should only use the functions below. A generated table
+named oKeywords is declared as extern const struct SymTableStatic oKeywords;*/
+struct SymTableStatic{
+    /*number of bindings, which is also the number of slots*/
+    size_t numOfBindings;
+
+    /*number of displacement buckets*/
+    size_t numOfBuckets;
+
+    /*seed of the hash function the displacements were computed with*/
+    size_t seed;
+
+    /*displacement index of each bucket*/
+    const size_t *displacements;
+
+    /*array of exactly numOfBindings slots, none of them empty*/
+    const struct SymTableStaticSlot *slots;
+
+    /*all keys stored back to back, each terminated by '\0'*/
+    const char *keys;
+};
+
+/*Creates an alias SymTableStatic_T as a pointer to a read-only static table*/
+typedef const struct SymTableStatic *SymTableStatic_T;
+
+/*Returns number of bindings in oSymTableStatic*/
+size_t SymTableStatic_getLength(SymTableStatic_T oSymTableStatic);
+
+/*Returns 1 if there is a binding with pcKey in oSymTableStatic,
+returns 0 if there is not*/
+int SymTableStatic_contains(SymTableStatic_T oSymTableStatic,
+    const char *pcKey);
+
+/*Returns the value associated with pcKey in oSymTableStatic, or NULL if
+pcKey is not in oSymTableStatic*/
+void *SymTableStatic_get(SymTableStatic_T oSymTableStatic, const char *pcKey);
+
+/*Applies the function pfApply to all bindings in oSymTableStatic, passes
+pvExtra as an argument of pfApply*/
+void SymTableStatic_map(SymTableStatic_T oSymTableStatic,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*Returns the hash code of pcKey for seed uSeed. Used by the code that builds
+static tables*/
+size_t SymTableStatic_hash(const char *pcKey, size_t uSeed);
+
+/*Returns the displacement bucket of the key with hash code uHash in a table
+of uSlotCount slots and uBucketCount buckets*/
+size_t SymTableStatic_bucket(size_t uHash, size_t uSlotCount,
+    size_t uBucketCount);
+
+/*Returns the slot of the key with hash code uHash in a table of uSlotCount
+slots when its bucket uses displacement index uDisp*/
+size_t SymTableStatic_slot(size_t uHash, size_t uDisp, size_t uSlotCount);
+
+#endif
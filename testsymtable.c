@@ -4,11 +4,27 @@
 /*--------------------------------------------------------------------*/
 
 #include "symtable.h"
+#include "symtablefrozen.h"
+#include "symtableasync.h"
+#include "symtablesharded.h"
+#include "symtabledurable.h"
+#include "symtableint.h"
+#include "symtablelru.h"
+#include "symtableload.h"
+#ifdef SYMTABLE_BLOOM
+#include "symtablebloom.h"
+#endif
+#ifdef SYMTABLE_HOT_CACHE
+#include "symtablehot.h"
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <stdint.h>
 #include <assert.h>
+#include <pthread.h>
+#include <signal.h>
 
 #ifndef S_SPLINT_S
 #include <sys/resource.h>
@@ -83,6 +99,35 @@ static void printBindingSimple(const char *pcKey, void *pvValue,
 
 /*--------------------------------------------------------------------*/
 
+/* Increment the count of bindings at *pvExtra. pcKey and pvValue are
+   unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store the key pcKey in *pvExtra. pvValue is unused. */
+
+static void saveKey(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   *(const char**)pvExtra = pcKey;
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the most basic SymTable functions. */
 
 static void testBasics(void)
@@ -300,6 +345,63 @@ static void testKeyOwnership(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test handling of keys borrowed by a SymTable object made by
+   SymTable_newBorrowedKeys(). */
+
+static void testBorrowedKeys(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acMantle2[] = "Mantle";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "CenterField";
+   const char *pcKey;
+   char *pcValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing borrowed keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newBorrowedKeys();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+
+   /* The table holds the caller's key, not a copy. */
+   pcKey = NULL;
+   SymTable_map(oSymTable, saveKey, &pcKey);
+   ASSURE(pcKey == acMantle);
+
+   /* Keys are still compared by contents. */
+   pcValue = (char*)SymTable_get(oSymTable, acMantle2);
+   ASSURE(pcValue == acCenterField);
+   iSuccessful = SymTable_put(oSymTable, acMantle2, acShortstop);
+   ASSURE(! iSuccessful);
+
+   /* A clone borrows the same keys. */
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   pcKey = NULL;
+   SymTable_map(oSymTableClone, saveKey, &pcKey);
+   ASSURE(pcKey == acMantle);
+
+   /* Neither remove nor free frees a borrowed key. */
+   pcValue = (char*)SymTable_remove(oSymTable, acMantle2);
+   ASSURE(pcValue == acCenterField);
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   SymTable_free(oSymTable);
+   SymTable_free(oSymTableClone);
+   ASSURE(strcmp(acMantle, "Mantle") == 0);
+   ASSURE(strcmp(acJeter, "Jeter") == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the SymTable_remove() function. */
 
 static void testRemove(void)
@@ -431,6 +533,248 @@ static void testMap(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test the SymTable_mapPrefix() function. */
+
+static void testMapPrefix(void)
+{
+   SymTable_T oSymTable;
+   size_t uCount;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_mapPrefix() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, "/usr/bin/cc", "1");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "/usr/bin/ld", "2");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "/usr/lib", "3");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "/usr", "4");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "/etc", "5");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "", "6");
+   ASSURE(iSuccessful);
+
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/usr/bin/", countBinding, &uCount);
+   ASSURE(uCount == 2);
+
+   /* A prefix can end in the middle of what the keys share. */
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/us", countBinding, &uCount);
+   ASSURE(uCount == 4);
+
+   /* A whole key is a prefix of itself, but not of a shorter key. */
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/usr/lib", countBinding, &uCount);
+   ASSURE(uCount == 1);
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/usr/lib/", countBinding, &uCount);
+   ASSURE(uCount == 0);
+
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/var", countBinding, &uCount);
+   ASSURE(uCount == 0);
+
+   /* The empty prefix matches every key. */
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "", countBinding, &uCount);
+   ASSURE(uCount == 6);
+
+   /* Only visible bindings are visited. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "/usr/bin/cc", "7");
+   ASSURE(iSuccessful);
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/usr/bin", countBinding, &uCount);
+   ASSURE(uCount == 2);
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+
+   SymTable_remove(oSymTable, "/usr/bin/ld");
+   uCount = 0;
+   SymTable_mapPrefix(oSymTable, "/usr/", countBinding, &uCount);
+   ASSURE(uCount == 2);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the longer of the strings pvExisting and pvIncoming, or
+   pvExisting if they are as long. pcKey is unused, and *pvExtra
+   counts the calls. */
+
+static void *pickLonger(const char *pcKey, void *pvExisting,
+   void *pvIncoming, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (*(size_t*)pvExtra)++;
+   if (strlen((char*)pvIncoming) > strlen((char*)pvExisting))
+      return pvIncoming;
+   return pvExisting;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_merge() function. */
+
+static void testMerge(int iBindingCount)
+{
+   SymTable_T oSymTable;
+   SymTable_T oSymTable2;
+   size_t uCount;
+   size_t uDepth;
+   int iSuccessful;
+   int i;
+   int iValue;
+   char acKey[32];
+   char *pcValue;
+   int *piValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_merge() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Each policy decides the value of a key both tables bind. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "RF");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Gehrig", "1B");
+   ASSURE(iSuccessful);
+
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_put(oSymTable2, "Ruth", "P");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Mantle", "CF");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_merge(oSymTable, oSymTable2,
+      SYMTABLE_KEEP_EXISTING, NULL, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Ruth"), "RF") == 0);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Mantle"), "CF") == 0);
+
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_put(oSymTable2, "Ruth", "P");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_merge(oSymTable, oSymTable2,
+      SYMTABLE_OVERWRITE, NULL, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Ruth"), "P") == 0);
+
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_put(oSymTable2, "Ruth", "RF");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Gehrig", "");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Jeter", "SS");
+   ASSURE(iSuccessful);
+   uCount = 0;
+   iSuccessful = SymTable_merge(oSymTable, oSymTable2,
+      SYMTABLE_RESOLVE, pickLonger, &uCount);
+   ASSURE(iSuccessful);
+   ASSURE(uCount == 2);
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Ruth"), "RF") == 0);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Gehrig"), "1B") == 0);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Jeter"), "SS") == 0);
+
+   /* Merged bindings go into the innermost scope, hiding outer
+      ones, and close with it. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_put(oSymTable2, "Ruth", "P");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Berra", "C");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_merge(oSymTable, oSymTable2,
+      SYMTABLE_KEEP_EXISTING, NULL, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 5);
+   uDepth = 0;
+   pcValue = (char*)SymTable_getInnermost(oSymTable, "Ruth", &uDepth);
+   ASSURE(strcmp(pcValue, "P") == 0);
+   ASSURE(uDepth == 1);
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == 5);
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Ruth"), "RF") == 0);
+   ASSURE(! SymTable_contains(oSymTable, "Berra"));
+
+   /* An empty source changes nothing. */
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_merge(oSymTable, oSymTable2,
+      SYMTABLE_OVERWRITE, NULL, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+   SymTable_free(oSymTable);
+
+   /* Inline values are copied from whichever side wins. */
+   oSymTable = SymTable_newInline(sizeof(int));
+   ASSURE(oSymTable != NULL);
+   oSymTable2 = SymTable_newInline(sizeof(int));
+   ASSURE(oSymTable2 != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iValue = i;
+      if (i % 2 == 0)
+      {
+         iSuccessful = SymTable_put(oSymTable, acKey, &iValue);
+         ASSURE(iSuccessful);
+      }
+      if (i % 3 == 0)
+      {
+         iValue = -i;
+         iSuccessful = SymTable_put(oSymTable2, acKey, &iValue);
+         ASSURE(iSuccessful);
+      }
+   }
+   iSuccessful = SymTable_merge(oSymTable, oSymTable2,
+      SYMTABLE_OVERWRITE, NULL, NULL);
+   ASSURE(iSuccessful);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      piValue = (int*)SymTable_get(oSymTable, acKey);
+      if (i % 3 == 0)
+         ASSURE((piValue != NULL) && (*piValue == -i));
+      else if (i % 2 == 0)
+         ASSURE((piValue != NULL) && (*piValue == i));
+      else
+         ASSURE(piValue == NULL);
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == SymTable_getLength(oSymTable));
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test a SymTable object that contains no bindings. */
 
 static void testEmptyTable(void)
@@ -776,98 +1120,2425 @@ static void testCollisions(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to be large, that is, to
-   contain iBindingCount bindings. Write the time consumed to stdout. */
+/* Test the SymTable_clone() function, using tables that contain
+   iBindingCount bindings. */
 
-static void testLargeTable(int iBindingCount)
+static void testClone(int iBindingCount)
 {
    enum {MAX_KEY_LENGTH = 10};
 
    SymTable_T oSymTable;
-   SymTable_T oSymTableSmall;
+   SymTable_T oSymTableClone;
+   SymTable_T oSymTableClone2;
    char acKey[MAX_KEY_LENGTH];
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acRuth[] = "Ruth";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acRightField[] = "Right Field";
    char *pcValue;
    int i;
-   int iSmall;
-   int iLarge;
+   int iFound;
    int iSuccessful;
-   clock_t iInitialClock;
-   clock_t iFinalClock;
-   size_t uLength = 0;
-   size_t uLength2;
+   size_t uLength;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a potentially large SymTable object.\n");
-   printf("No output except CPU time consumed should appear here:\n");
+   printf("Testing the SymTable_clone() function.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
 
-   /* Note the current time. */
-   iInitialClock = clock();
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
 
-   /* Create oSymTableSmall, and put a couple of bindings into it. */
-   oSymTableSmall = SymTable_new();
-   ASSURE(oSymTableSmall != NULL);
-   iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   uLength = SymTable_getLength(oSymTableClone);
+   ASSURE(uLength == 2);
+
+   /* Change the original; the clone must not change. */
+   pcValue = (char*)SymTable_replace(oSymTable, acJeter, acRightField);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_remove(oSymTable, acMantle);
+   ASSURE(pcValue == acCenterField);
+   iSuccessful = SymTable_put(oSymTable, acRuth, acRightField);
    ASSURE(iSuccessful);
-   iSuccessful = SymTable_put(oSymTableSmall, "yyy", "yyy");
+
+   pcValue = (char*)SymTable_get(oSymTableClone, acJeter);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTableClone, acMantle);
+   ASSURE(pcValue == acCenterField);
+   iFound = SymTable_contains(oSymTableClone, acRuth);
+   ASSURE(! iFound);
+
+   /* Change the clone; the original must not change. */
+   iSuccessful = SymTable_put(oSymTableClone, acRuth, acShortstop);
    ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, acRuth);
+   ASSURE(pcValue == acRightField);
+   iFound = SymTable_contains(oSymTable, acMantle);
+   ASSURE(! iFound);
 
-   /* Create oSymTable, the primary SymTable object. */
+   /* Free the original before the clone. */
+   SymTable_free(oSymTable);
+   pcValue = (char*)SymTable_get(oSymTableClone, acJeter);
+   ASSURE(pcValue == acShortstop);
+   uLength = SymTable_getLength(oSymTableClone);
+   ASSURE(uLength == 3);
+   SymTable_free(oSymTableClone);
+
+   /* Clone a larger table, then empty the original and the clone of
+      the clone in different orders. */
    oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
-
-   /* Put iBindingCount new bindings into oSymTable.  Each binding's
-      key and value contain the same characters. */
    for (i = 0; i < iBindingCount; i++)
    {
-      sprintf(acKey, "%d", i);
-      pcValue = (char*)malloc(sizeof(char) * (strlen(acKey) + 1));
-      ASSURE(pcValue != NULL);
-      strcpy(pcValue, acKey);
-      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
-      ASSURE(iSuccessful);
-      uLength = SymTable_getLength(oSymTable);
-      ASSURE(uLength == (size_t)(i+1));
+      sprintf(acKey, "%d", i % 1000000);
+      SymTable_put(oSymTable, acKey, acCenterField);
    }
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   oSymTableClone2 = SymTable_clone(oSymTableClone);
+   ASSURE(oSymTableClone2 != NULL);
 
-   /* Get each binding's value, and make sure that it contains
-      the same characters as its key. */
-   iSmall = 0;
-   iLarge = iBindingCount - 1;
-   while (iSmall < iLarge)
+   for (i = 0; i < iBindingCount && i < 1000000; i += 2)
    {
-      /* Get the smallest of the remaining bindings. */
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      iSmall++;
-      /* Get the largest of the remaining bindings. */
-      sprintf(acKey, "%d", iLarge);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      iLarge--;
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acCenterField);
    }
-   /* Get the middle binding -- if there is one. */
-   if (iSmall == iLarge)
+   for (i = 1; i < iBindingCount && i < 1000000; i += 2)
    {
-      sprintf(acKey, "%d", iSmall);
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_replace(oSymTableClone2, acKey, acJeter);
+      ASSURE(pcValue == acCenterField);
+   }
+   for (i = 0; i < iBindingCount && i < 1000000; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTableClone, acKey);
+      ASSURE(pcValue == acCenterField);
       pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      ASSURE(pcValue == ((i % 2 == 0) ? NULL : acCenterField));
+      pcValue = (char*)SymTable_get(oSymTableClone2, acKey);
+      ASSURE(pcValue == ((i % 2 == 0) ? acCenterField : acJeter));
    }
+   uLength = SymTable_getLength(oSymTableClone);
+   ASSURE(uLength == SymTable_getLength(oSymTableClone2));
 
-   /* Remove each binding. Also free each binding's value. */
-   iSmall = 0;
-   iLarge = iBindingCount - 1;
-   while (iSmall < iLarge)
-   {
-      /* Remove the smallest of the remaining bindings. */
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_remove(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+   SymTable_free(oSymTableClone);
+   SymTable_free(oSymTable);
+   SymTable_free(oSymTableClone2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_buildParallel() function, building from
+   iBindingCount keys followed by a quarter as many repeats of them. */
+
+static void testBuildParallel(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   static const size_t auThreadCounts[] = {1, 3, 8};
+   SymTable_T oSymTable;
+   char *pcKeys;
+   const char **ppcKeys;
+   const void **ppvValues;
+   size_t uCount;
+   size_t uDuplicates;
+   size_t t;
+   size_t i;
+   int iSuccessful;
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_buildParallel() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uCount = (size_t)iBindingCount + (size_t)iBindingCount / 4;
+   pcKeys = (char*)malloc((uCount + 1) * MAX_KEY_LENGTH);
+   ppcKeys = (const char**)malloc((uCount + 1) * sizeof(char*));
+   ppvValues = (const void**)malloc((uCount + 1) * sizeof(void*));
+   ASSURE(pcKeys != NULL && ppcKeys != NULL && ppvValues != NULL);
+
+   /* Each value is the place of its key, so the binding shows which
+      of equal keys was kept. */
+   for (i = 0; i < uCount; i++)
+   {
+      if (i < (size_t)iBindingCount)
+         sprintf(pcKeys + i * MAX_KEY_LENGTH, "%lu", (unsigned long)i);
+      else
+         sprintf(pcKeys + i * MAX_KEY_LENGTH, "%lu", (unsigned long)
+            ((i - (size_t)iBindingCount) * 3 % (size_t)iBindingCount));
+      ppcKeys[i] = pcKeys + i * MAX_KEY_LENGTH;
+      ppvValues[i] = ppcKeys[i];
+   }
+
+   for (t = 0; t < sizeof(auThreadCounts) / sizeof(auThreadCounts[0]); t++)
+   {
+      uDuplicates = 99;
+      oSymTable = SymTable_buildParallel(ppcKeys, ppvValues, uCount,
+         auThreadCounts[t], &uDuplicates);
+      ASSURE(oSymTable != NULL);
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+      ASSURE(uDuplicates == (size_t)iBindingCount / 4);
+      for (i = 0; i < (size_t)iBindingCount; i++)
+      {
+         pcValue = (char*)SymTable_get(oSymTable, ppcKeys[i]);
+         ASSURE(pcValue == ppcKeys[i]);
+      }
+      ASSURE(! SymTable_contains(oSymTable, "-1"));
+
+      /* The table grows like any other. */
+      iSuccessful = SymTable_put(oSymTable, "-1", "x");
+      ASSURE(iSuccessful);
+      if (iBindingCount > 0)
+      {
+         iSuccessful = SymTable_put(oSymTable, ppcKeys[0], "x");
+         ASSURE(! iSuccessful);
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount + 1);
+      SymTable_free(oSymTable);
+   }
+
+   oSymTable = SymTable_buildParallel(ppcKeys, ppvValues, 0, 4, NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+
+   free(ppvValues);
+   free(ppcKeys);
+   free(pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Number of values freeValue has been called with. */
+
+static size_t uFreedCount;
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvValue, which was allocated by malloc, and count it. */
+
+static void freeValue(void *pvValue)
+{
+   assert(pvValue != NULL);
+
+   free(pvValue);
+   uFreedCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_clear() function, filling tables with
+   iBindingCount bindings several times over. */
+
+static void testClear(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcKeys;
+   int iRound;
+   int i;
+   int iSuccessful;
+   int *piValue;
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_clear() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Each round uses longer keys than the last, so the keys of cleared
+      bindings are too short to hold them. */
+   for (iRound = 0; iRound < 3; iRound++)
+   {
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%.*s%d", iRound * 4, "xxxxxxxxxxxx", i);
+         piValue = (int*)malloc(sizeof(int));
+         ASSURE(piValue != NULL);
+         *piValue = i;
+         iSuccessful = SymTable_put(oSymTable, acKey, piValue);
+         ASSURE(iSuccessful);
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+      sprintf(acKey, "%.*s%d", iRound * 4, "xxxxxxxxxxxx", iBindingCount / 2);
+      piValue = (int*)SymTable_get(oSymTable, acKey);
+      if (iBindingCount > 0)
+         ASSURE(piValue != NULL && *piValue == iBindingCount / 2);
+
+      uFreedCount = 0;
+      iSuccessful = SymTable_clear(oSymTable, freeValue);
+      ASSURE(iSuccessful);
+      ASSURE(uFreedCount == (size_t)iBindingCount);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+
+   /* Hidden bindings and inner scopes go too. */
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Pitcher");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", "Shortstop");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_clear(oSymTable, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   ASSURE(! SymTable_popScope(oSymTable));
+   ASSURE(SymTable_get(oSymTable, "Ruth") == NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Right Field") == 0);
+
+   /* Clearing a table leaves its clones alone. */
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   iSuccessful = SymTable_clear(oSymTable, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTableClone) == 1);
+   pcValue = (char*)SymTable_get(oSymTableClone, "Ruth");
+   ASSURE(strcmp(pcValue, "Right Field") == 0);
+   SymTable_free(oSymTableClone);
+   SymTable_free(oSymTable);
+
+   /* A table that borrows keys takes the new keys, not copies. */
+   pcKeys = (char*)malloc(((size_t)iBindingCount + 1) * MAX_KEY_LENGTH);
+   ASSURE(pcKeys != NULL);
+   oSymTable = SymTable_newBorrowedKeys();
+   ASSURE(oSymTable != NULL);
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(pcKeys + i * MAX_KEY_LENGTH, "%d-%d", iRound, i);
+         iSuccessful = SymTable_put(oSymTable, pcKeys + i * MAX_KEY_LENGTH,
+            "x");
+         ASSURE(iSuccessful);
+      }
+      for (i = 0; i < iBindingCount; i++)
+         ASSURE(SymTable_contains(oSymTable, pcKeys + i * MAX_KEY_LENGTH));
+      iSuccessful = SymTable_clear(oSymTable, NULL);
+      ASSURE(iSuccessful);
+   }
+   SymTable_free(oSymTable);
+   free(pcKeys);
+
+   /* An inline table gets its new values, not the old ones. */
+   oSymTable = SymTable_newInline(sizeof(int));
+   ASSURE(oSymTable != NULL);
+   i = 1;
+   iSuccessful = SymTable_put(oSymTable, "one", &i);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_clear(oSymTable, NULL);
+   ASSURE(iSuccessful);
+   i = 2;
+   iSuccessful = SymTable_put(oSymTable, "two", &i);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "one", NULL);
+   ASSURE(iSuccessful);
+   ASSURE(*(int*)SymTable_get(oSymTable, "two") == 2);
+   ASSURE(*(int*)SymTable_get(oSymTable, "one") == 0);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Keys collected by collectKey(). */
+
+struct KeyList
+{
+   /* Array of the keys, with room for every binding. */
+   const char **ppcKeys;
+
+   /* Number of keys in the array. */
+   size_t uCount;
+};
+
+/* Append pcKey, as stored in the table, to the struct KeyList at
+   pvExtra. pvValue is unused. */
+
+static void collectKey(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct KeyList *psList = (struct KeyList*)pvExtra;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   psList->ppcKeys[psList->uCount++] = pcKey;
+}
+
+/* Return a negative number, 0 or a positive number as the key that
+   pvFirst points to is stored before, at or after the key that
+   pvSecond points to. */
+
+static int compareKeyAddresses(const void *pvFirst, const void *pvSecond)
+{
+   uintptr_t uFirst = (uintptr_t)*(const char *const*)pvFirst;
+   uintptr_t uSecond = (uintptr_t)*(const char *const*)pvSecond;
+
+   if (uFirst < uSecond)
+      return -1;
+   return uFirst > uSecond;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable made by SymTable_newKeyHeap() with iBindingCount
+   bindings, some with keys longer than a block of its heap. */
+
+static void testKeyHeap(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 40};
+   enum {LONG_KEY_LENGTH = 10000};
+   enum {FIRST_BLOCK_SIZE = 4096};
+   enum {GROWTH_KEY_COUNT = 4000};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   SymTable_T oSymTableSource;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcLongKey;
+   size_t uCount;
+   int i;
+   int iRound;
+   int iSuccessful;
+   char *pcValue;
+   struct KeyList sList;
+   size_t uRun;
+   size_t uLongestRun;
+   size_t uLength;
+   int iPacked;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_newKeyHeap() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newKeyHeap();
+   ASSURE(oSymTable != NULL);
+   pcLongKey = (char*)malloc(LONG_KEY_LENGTH + 1);
+   ASSURE(pcLongKey != NULL);
+   memset(pcLongKey, 'L', LONG_KEY_LENGTH);
+   pcLongKey[LONG_KEY_LENGTH] = '\0';
+
+   /* The long key comes in the middle, so the block being filled must
+      go on filling after it. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "http://example.com/page/%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, "x");
+      ASSURE(iSuccessful);
+      if (i == iBindingCount / 2)
+      {
+         iSuccessful = SymTable_put(oSymTable, pcLongKey, "long");
+         ASSURE(iSuccessful);
+      }
+   }
+   if (iBindingCount == 0)
+   {
+      iSuccessful = SymTable_put(oSymTable, pcLongKey, "long");
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount + 1);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "http://example.com/page/%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+   pcValue = (char*)SymTable_get(oSymTable, pcLongKey);
+   ASSURE(pcValue != NULL && strcmp(pcValue, "long") == 0);
+
+   /* Removing a key leaves the others in the heap alone. */
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "http://example.com/page/%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+   }
+   for (i = 1; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "http://example.com/page/%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+
+   /* A clone has a heap of its own. */
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   iSuccessful = SymTable_clear(oSymTable, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTableClone, pcLongKey) != NULL);
+   uCount = 0;
+   SymTable_map(oSymTableClone, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount / 2 + 1);
+   SymTable_free(oSymTableClone);
+
+   /* A cleared heap keeps its blocks, which hold the keys of the next
+      fill, the long key too. */
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "http://example.net/%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, "w");
+         ASSURE(iSuccessful);
+      }
+      iSuccessful = SymTable_put(oSymTable, pcLongKey, "long");
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount + 1);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "http://example.net/%d", i);
+         pcValue = (char*)SymTable_get(oSymTable, acKey);
+         ASSURE(pcValue != NULL && strcmp(pcValue, "w") == 0);
+      }
+      pcValue = (char*)SymTable_get(oSymTable, pcLongKey);
+      ASSURE(pcValue != NULL && strcmp(pcValue, "long") == 0);
+      iSuccessful = SymTable_clear(oSymTable, NULL);
+      ASSURE(iSuccessful);
+   }
+
+   /* The keys of a merged table live on in the destination. */
+   oSymTableSource = SymTable_newKeyHeap();
+   ASSURE(oSymTableSource != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "http://example.org/%d", i);
+      iSuccessful = SymTable_put(oSymTableSource, acKey, "y");
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_put(oSymTableSource, pcLongKey, "long");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "first", "z");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_merge(oSymTable, oSymTableSource,
+      SYMTABLE_KEEP_EXISTING, NULL, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount + 2);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "http://example.org/%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL && strcmp(pcValue, "y") == 0);
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount + 2);
+
+   SymTable_free(oSymTable);
+   free(pcLongKey);
+
+   /* Each block of a heap is larger than the last, so the keys of a
+      large fill are copied one after another in runs longer than the
+      first block. A table that keeps no heap packs no two keys. */
+   oSymTable = SymTable_newKeyHeap();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < GROWTH_KEY_COUNT; i++)
+   {
+      sprintf(acKey, "http://example.com/page/%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, "x");
+      ASSURE(iSuccessful);
+   }
+   sList.ppcKeys = (const char**)malloc(GROWTH_KEY_COUNT * sizeof(char*));
+   ASSURE(sList.ppcKeys != NULL);
+   sList.uCount = 0;
+   SymTable_map(oSymTable, collectKey, &sList);
+   ASSURE(sList.uCount == GROWTH_KEY_COUNT);
+   qsort(sList.ppcKeys, sList.uCount, sizeof(char*), compareKeyAddresses);
+   iPacked = 0;
+   uRun = 0;
+   uLongestRun = 0;
+   for (uCount = 0; uCount < sList.uCount; uCount++)
+   {
+      uLength = strlen(sList.ppcKeys[uCount]) + 1;
+      uRun += uLength;
+      if (uRun > uLongestRun)
+         uLongestRun = uRun;
+      if (uCount + 1 < sList.uCount &&
+         sList.ppcKeys[uCount] + uLength == sList.ppcKeys[uCount + 1])
+         iPacked = 1;
+      else
+         uRun = 0;
+   }
+   ASSURE(! iPacked || uLongestRun > FIRST_BLOCK_SIZE);
+   free(sList.ppcKeys);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_find() and the functions that use the handles it
+   returns, on a SymTable with iBindingCount bindings. */
+
+static void testFind(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   SymTable_Handle oHandle;
+   SymTable_Handle oHandle2;
+   char acKey[MAX_KEY_LENGTH];
+   int *piValues;
+   int iValue;
+   int i;
+   int iSuccessful;
+   int *piValue;
+   char *pcValue;
+   size_t uDepth;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_find() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   piValues = (int*)malloc(sizeof(int) * ((size_t)iBindingCount + 1));
+   ASSURE(piValues != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      piValues[i] = i;
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &piValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_find(oSymTable, "missing") == NULL);
+
+   /* Each binding is found once and changed through its handle. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      oHandle = SymTable_find(oSymTable, acKey);
+      ASSURE(oHandle != NULL);
+      ASSURE(SymTable_handleValue(oSymTable, oHandle) == &piValues[i]);
+      if (i % 3 == 0)
+      {
+         piValue = (int*)SymTable_handleSetValue(oSymTable, oHandle,
+            &piValues[iBindingCount - 1]);
+         ASSURE(piValue == &piValues[i]);
+         ASSURE(SymTable_get(oSymTable, acKey) ==
+            &piValues[iBindingCount - 1]);
+      }
+      else if (i % 3 == 1)
+      {
+         piValue = (int*)SymTable_handleRemove(oSymTable, oHandle);
+         ASSURE(piValue == &piValues[i]);
+         ASSURE(! SymTable_contains(oSymTable, acKey));
+      }
+   }
+   ASSURE(SymTable_getLength(oSymTable) ==
+      (size_t)(iBindingCount - (iBindingCount + 1) / 3));
+   SymTable_free(oSymTable);
+   free(piValues);
+
+   /* A handle outlives changes to other bindings. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Gehrig", "First Base");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Mantle", "Center Field");
+   ASSURE(iSuccessful);
+   oHandle = SymTable_find(oSymTable, "Ruth");
+   oHandle2 = SymTable_find(oSymTable, "Gehrig");
+   ASSURE(oHandle != NULL && oHandle2 != NULL);
+   pcValue = (char*)SymTable_handleRemove(oSymTable, oHandle);
+   ASSURE(strcmp(pcValue, "Right Field") == 0);
+   ASSURE(! SymTable_contains(oSymTable, "Ruth"));
+   SymTable_replace(oSymTable, "Mantle", "Center Field");
+   pcValue = (char*)SymTable_handleValue(oSymTable, oHandle2);
+   ASSURE(strcmp(pcValue, "First Base") == 0);
+   pcValue = (char*)SymTable_handleSetValue(oSymTable, oHandle2,
+      "First Base");
+   ASSURE(strcmp(pcValue, "First Base") == 0);
+   ASSURE(SymTable_contains(oSymTable, "Gehrig"));
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   /* Removing through a handle makes a hidden binding visible. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Mantle", "Outfield");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", "Shortstop");
+   ASSURE(iSuccessful);
+   oHandle = SymTable_find(oSymTable, "Mantle");
+   ASSURE(oHandle != NULL);
+   pcValue = (char*)SymTable_handleValue(oSymTable, oHandle);
+   ASSURE(strcmp(pcValue, "Outfield") == 0);
+   pcValue = (char*)SymTable_handleRemove(oSymTable, oHandle);
+   ASSURE(strcmp(pcValue, "Outfield") == 0);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, "Mantle", &uDepth);
+   ASSURE(pcValue != NULL && strcmp(pcValue, "Center Field") == 0);
+   ASSURE(uDepth == 0);
+   oHandle = SymTable_find(oSymTable, "Jeter");
+   ASSURE(oHandle != NULL);
+   SymTable_handleRemove(oSymTable, oHandle);
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   /* Setting a value through a handle leaves a clone alone. */
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   oHandle = SymTable_find(oSymTable, "Gehrig");
+   ASSURE(oHandle != NULL);
+   SymTable_handleSetValue(oSymTable, oHandle, "Designated Hitter");
+   pcValue = (char*)SymTable_get(oSymTable, "Gehrig");
+   ASSURE(strcmp(pcValue, "Designated Hitter") == 0);
+   pcValue = (char*)SymTable_get(oSymTableClone, "Gehrig");
+   ASSURE(strcmp(pcValue, "First Base") == 0);
+   SymTable_free(oSymTableClone);
+   SymTable_free(oSymTable);
+
+   /* An inline table gives the block in its binding. */
+   oSymTable = SymTable_newInline(sizeof(int));
+   ASSURE(oSymTable != NULL);
+   iValue = 5;
+   iSuccessful = SymTable_put(oSymTable, "five", &iValue);
+   ASSURE(iSuccessful);
+   oHandle = SymTable_find(oSymTable, "five");
+   ASSURE(oHandle != NULL);
+   piValue = (int*)SymTable_handleValue(oSymTable, oHandle);
+   ASSURE(*piValue == 5);
+   iValue = 7;
+   piValue = (int*)SymTable_handleSetValue(oSymTable, oHandle, &iValue);
+   ASSURE(*piValue == 5);
+   piValue = (int*)SymTable_get(oSymTable, "five");
+   ASSURE(*piValue == 7);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_BLOOM
+/* Test that the Bloom filter in front of the buckets counts every
+   lookup, and that the filters of a clone and of a table built by
+   SymTable_buildParallel() let every key in the table through. */
+
+static void testBloomStats(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableBuilt;
+   struct SymTableBloomStats sBefore;
+   struct SymTableBloomStats sAfter;
+   char *pcKeys;
+   const char **ppcKeys;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uCount;
+   size_t i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_getBloomStats() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uCount = (size_t)iBindingCount;
+   pcKeys = (char*)malloc((uCount + 1) * MAX_KEY_LENGTH);
+   ppcKeys = (const char**)malloc((uCount + 1) * sizeof(char*));
+   ASSURE(pcKeys != NULL && ppcKeys != NULL);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < uCount; i++)
+   {
+      sprintf(pcKeys + i * MAX_KEY_LENGTH, "%lu", (unsigned long)i);
+      ppcKeys[i] = pcKeys + i * MAX_KEY_LENGTH;
+      iSuccessful = SymTable_put(oSymTable, ppcKeys[i], ppcKeys[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* A key in the table is never rejected and never a false
+      positive. */
+   SymTable_getBloomStats(oSymTable, &sBefore);
+   for (i = 0; i < uCount; i++)
+      ASSURE(SymTable_get(oSymTable, ppcKeys[i]) == ppcKeys[i]);
+   SymTable_getBloomStats(oSymTable, &sAfter);
+   ASSURE(sAfter.lookups == sBefore.lookups + uCount);
+   ASSURE(sAfter.rejected == sBefore.rejected);
+   ASSURE(sAfter.falsePositives == sBefore.falsePositives);
+
+   /* A key not in the table is either rejected or a false positive,
+      whichever function looks it up. */
+   sBefore = sAfter;
+   for (i = 0; i < uCount; i++)
+   {
+      sprintf(acKey, "-%lu", (unsigned long)i);
+      ASSURE(SymTable_get(oSymTable, acKey) == NULL);
+   }
+   ASSURE(! SymTable_contains(oSymTable, "-"));
+   ASSURE(SymTable_remove(oSymTable, "-") == NULL);
+   ASSURE(SymTable_replace(oSymTable, "-", "x") == NULL);
+   ASSURE(SymTable_find(oSymTable, "-") == NULL);
+   SymTable_getBloomStats(oSymTable, &sAfter);
+   ASSURE(sAfter.lookups == sBefore.lookups + uCount + 4);
+   ASSURE(sAfter.rejected + sAfter.falsePositives
+      == sBefore.rejected + sBefore.falsePositives + uCount + 4);
+
+   /* A clone has a filter of its own that lets every key through. */
+   oSymTableBuilt = SymTable_clone(oSymTable);
+   ASSURE(oSymTableBuilt != NULL);
+   SymTable_getBloomStats(oSymTableBuilt, &sBefore);
+   for (i = 0; i < uCount; i++)
+      ASSURE(SymTable_get(oSymTableBuilt, ppcKeys[i]) == ppcKeys[i]);
+   ASSURE(SymTable_get(oSymTableBuilt, "-") == NULL);
+   SymTable_getBloomStats(oSymTableBuilt, &sAfter);
+   ASSURE(sAfter.lookups == sBefore.lookups + uCount + 1);
+   ASSURE(sAfter.rejected + sAfter.falsePositives
+      == sBefore.rejected + sBefore.falsePositives + 1);
+   SymTable_free(oSymTableBuilt);
+
+   /* So has a table built on several threads. */
+   oSymTableBuilt = SymTable_buildParallel(ppcKeys,
+      (const void**)ppcKeys, uCount, 3, NULL);
+   ASSURE(oSymTableBuilt != NULL);
+   SymTable_getBloomStats(oSymTableBuilt, &sBefore);
+   for (i = 0; i < uCount; i++)
+      ASSURE(SymTable_get(oSymTableBuilt, ppcKeys[i]) == ppcKeys[i]);
+   ASSURE(SymTable_get(oSymTableBuilt, "-") == NULL);
+   SymTable_getBloomStats(oSymTableBuilt, &sAfter);
+   ASSURE(sAfter.lookups == sBefore.lookups + uCount + 1);
+   ASSURE(sAfter.rejected + sAfter.falsePositives
+      == sBefore.rejected + sBefore.falsePositives + 1);
+   SymTable_free(oSymTableBuilt);
+
+   SymTable_free(oSymTable);
+   free(ppcKeys);
+   free(pcKeys);
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_HOT_CACHE
+/* Test that the hot key cache in front of the buckets answers repeated
+   lookups of a key, and that it never answers for a binding that was
+   removed, hidden or moved to new buckets. */
+
+static void testHotStats(void)
+{
+   enum {REPEATS = 8};
+   enum {EXPAND_COUNT = 1024};
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTable_T oSymTable;
+   struct SymTableHotStats sBefore;
+   struct SymTableHotStats sAfter;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iSuccessful;
+   char *pcValue;
+   size_t uDepth;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_getHotStats() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+
+   /* Every lookup after the first is a hit. */
+   SymTable_getHotStats(oSymTable, &sBefore);
+   for (i = 0; i < REPEATS; i++)
+   {
+      pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+      ASSURE(strcmp(pcValue, "Right Field") == 0);
+   }
+   SymTable_getHotStats(oSymTable, &sAfter);
+   ASSURE(sAfter.lookups == sBefore.lookups + REPEATS);
+   ASSURE(sAfter.hits == sBefore.hits + REPEATS - 1);
+
+   /* A removed binding is not a hit. */
+   SymTable_remove(oSymTable, "Ruth");
+   SymTable_getHotStats(oSymTable, &sBefore);
+   ASSURE(SymTable_get(oSymTable, "Ruth") == NULL);
+   ASSURE(! SymTable_contains(oSymTable, "Ruth"));
+   SymTable_getHotStats(oSymTable, &sAfter);
+   ASSURE(sAfter.hits == sBefore.hits);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Pitcher");
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Pitcher") == 0);
+
+   /* Nor is a hidden one. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, "Ruth", &uDepth);
+   ASSURE(strcmp(pcValue, "Right Field") == 0 && uDepth == 1);
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Pitcher") == 0);
+
+   /* An expansion moves every binding to new buckets, after which a
+      hit still finds the binding, and a removal still ends it. */
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Pitcher") == 0);
+   for (i = 0; i < EXPAND_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, "x");
+      ASSURE(iSuccessful);
+   }
+   SymTable_getHotStats(oSymTable, &sBefore);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Pitcher") == 0);
+   SymTable_getHotStats(oSymTable, &sAfter);
+   ASSURE(sAfter.hits == sBefore.hits + 1);
+   SymTable_remove(oSymTable, "Ruth");
+   sBefore = sAfter;
+   ASSURE(SymTable_get(oSymTable, "Ruth") == NULL);
+   SymTable_getHotStats(oSymTable, &sAfter);
+   ASSURE(sAfter.hits == sBefore.hits);
+   for (i = 0; i < EXPAND_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+
+   SymTable_free(oSymTable);
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test that looking the same keys up again and again sees every change
+   made to their bindings in between, as a SymTable that caches the
+   bindings of recent lookups must. */
+
+static void testRepeatedLookups(void)
+{
+   enum {REPEATS = 4};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableSource;
+   SymTable_Handle oHandle;
+   int i;
+   int iSuccessful;
+   char *pcValue;
+   size_t uDepth;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing repeated lookups of the same keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Gehrig", "First Base");
+   ASSURE(iSuccessful);
+   for (i = 0; i < REPEATS; i++)
+   {
+      pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+      ASSURE(strcmp(pcValue, "Right Field") == 0);
+   }
+
+   /* A removed binding is gone, and a new one with its key is seen. */
+   SymTable_remove(oSymTable, "Ruth");
+   ASSURE(SymTable_get(oSymTable, "Ruth") == NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Pitcher");
+   ASSURE(iSuccessful);
+   for (i = 0; i < REPEATS; i++)
+   {
+      pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+      ASSURE(strcmp(pcValue, "Pitcher") == 0);
+   }
+   SymTable_replace(oSymTable, "Ruth", "Right Field");
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Right Field") == 0);
+
+   /* A binding that is hidden, then shown again. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Pitcher");
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, "Ruth", &uDepth);
+   ASSURE(strcmp(pcValue, "Pitcher") == 0 && uDepth == 1);
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, "Ruth", &uDepth);
+   ASSURE(strcmp(pcValue, "Right Field") == 0 && uDepth == 0);
+
+   /* Removing through a handle and clearing. */
+   ASSURE(SymTable_contains(oSymTable, "Gehrig"));
+   oHandle = SymTable_find(oSymTable, "Gehrig");
+   ASSURE(oHandle != NULL);
+   SymTable_handleRemove(oSymTable, oHandle);
+   ASSURE(! SymTable_contains(oSymTable, "Gehrig"));
+   ASSURE(SymTable_contains(oSymTable, "Ruth"));
+   iSuccessful = SymTable_clear(oSymTable, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(! SymTable_contains(oSymTable, "Ruth"));
+
+   /* Keys brought in by a merge, and many other keys put between two
+      lookups of one. */
+   oSymTableSource = SymTable_new();
+   ASSURE(oSymTableSource != NULL);
+   iSuccessful = SymTable_put(oSymTableSource, "Ruth", "Outfield");
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_contains(oSymTableSource, "Ruth"));
+   iSuccessful = SymTable_merge(oSymTable, oSymTableSource,
+      SYMTABLE_OVERWRITE, NULL, NULL);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Outfield") == 0);
+   for (i = 0; i < 1000; i++)
+   {
+      char acKey[16];
+      sprintf(acKey, "key%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, "x");
+      ASSURE(iSuccessful);
+   }
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(strcmp(pcValue, "Outfield") == 0);
+   SymTable_remove(oSymTable, "Ruth");
+   ASSURE(SymTable_get(oSymTable, "Ruth") == NULL);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_freeze() and the SymTableFrozen functions, using a
+   frozen copy of a table that contains iBindingCount bindings. */
+
+static void testFreeze(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTableFrozen_T oSymTableFrozen;
+   char acKey[MAX_KEY_LENGTH];
+   char acJeter[] = "Jeter";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   int i;
+   int iFound;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_freeze() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Freeze an empty table. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   oSymTableFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oSymTableFrozen != NULL);
+   uLength = SymTableFrozen_getLength(oSymTableFrozen);
+   ASSURE(uLength == 0);
+   iFound = SymTableFrozen_contains(oSymTableFrozen, acJeter);
+   ASSURE(! iFound);
+   pcValue = (char*)SymTableFrozen_get(oSymTableFrozen, acJeter);
+   ASSURE(pcValue == NULL);
+   SymTableFrozen_free(oSymTableFrozen);
+
+   /* Freeze a table, then change the table. */
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "", NULL);
+   ASSURE(iSuccessful);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i % 1000000);
+      SymTable_put(oSymTable, acKey, acCenterField);
+   }
+   oSymTableFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oSymTableFrozen != NULL);
+   pcValue = (char*)SymTable_replace(oSymTable, acJeter, acCenterField);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_remove(oSymTable, "");
+   ASSURE(pcValue == NULL);
+
+   uLength = SymTableFrozen_getLength(oSymTableFrozen);
+   ASSURE(uLength == SymTable_getLength(oSymTable) + 1);
+
+   pcValue = (char*)SymTableFrozen_get(oSymTableFrozen, acJeter);
+   ASSURE(pcValue == acShortstop);
+   iFound = SymTableFrozen_contains(oSymTableFrozen, "");
+   ASSURE(iFound);
+   pcValue = (char*)SymTableFrozen_get(oSymTableFrozen, "");
+   ASSURE(pcValue == NULL);
+   iFound = SymTableFrozen_contains(oSymTableFrozen, "Clemens");
+   ASSURE(! iFound);
+   pcValue = (char*)SymTableFrozen_get(oSymTableFrozen, "Clemens");
+   ASSURE(pcValue == NULL);
+
+   for (i = 0; i < iBindingCount && i < 1000000; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTableFrozen_get(oSymTableFrozen, acKey);
+      ASSURE(pcValue == acCenterField);
+   }
+   sprintf(acKey, "%d", -1);
+   iFound = SymTableFrozen_contains(oSymTableFrozen, acKey);
+   ASSURE(! iFound);
+
+   SymTable_free(oSymTable);
+
+   /* The frozen table must not depend on the table it was built from. */
+   pcValue = (char*)SymTableFrozen_get(oSymTableFrozen, acJeter);
+   ASSURE(pcValue == acShortstop);
+
+   SymTableFrozen_free(oSymTableFrozen);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_freeAsync() and SymTable_drainPendingFrees()
+   functions. */
+
+static void testFreeAsync(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_freeAsync() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Draining with nothing pending returns at once. */
+   SymTable_drainPendingFrees();
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, "x");
+      ASSURE(iSuccessful);
+   }
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+
+   /* A clone can still be read while the table is being freed. */
+   SymTable_freeAsync(oSymTable);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTableClone, acKey);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, "x") == 0));
+   }
+   SymTable_drainPendingFrees();
+   ASSURE(SymTable_getLength(oSymTableClone) == (size_t)iBindingCount);
+
+   /* The thread starts again after a drain. */
+   SymTable_freeAsync(oSymTableClone);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_freeAsync(oSymTable);
+   SymTable_drainPendingFrees();
+   SymTable_drainPendingFrees();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Represents the keys one thread of testSharded() puts. */
+
+struct ShardedPuts
+{
+   /* The table the keys are put into. */
+   SymTableSharded_T oSymTableSharded;
+
+   /* The first key, as a number. */
+   int iFirst;
+
+   /* One more than the last key, as a number. */
+   int iEnd;
+
+   /* The number of puts that failed. */
+   int iFailed;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Put into a sharded table the keys described by the struct
+   ShardedPuts pvPuts, each bound to its own key. Return NULL. */
+
+static void *putSharded(void *pvPuts)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct ShardedPuts *psPuts = (struct ShardedPuts*)pvPuts;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   for (i = psPuts->iFirst; i < psPuts->iEnd; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (! SymTableSharded_put(psPuts->oSymTableSharded, acKey, "x"))
+         psPuts->iFailed++;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the int counter at pvValue. pcKey and pvExtra are
+   unused. Each binding has its own counter, so this may run on
+   several threads at once. */
+
+static void countVisit(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   (void)pvExtra;
+
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTableSharded object. */
+
+static void testSharded(int iBindingCount)
+{
+   enum {THREAD_COUNT = 4};
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTableSharded_T oSymTableSharded;
+   struct ShardedPuts asPuts[THREAD_COUNT];
+   pthread_t asThreads[THREAD_COUNT];
+   char acKey[MAX_KEY_LENGTH];
+   int *piVisits;
+   size_t uCount;
+   size_t uDepth;
+   int i;
+   int iSuccessful;
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTableSharded ADT.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTableSharded = SymTableSharded_new(8);
+   ASSURE(oSymTableSharded != NULL);
+   ASSURE(SymTableSharded_getLength(oSymTableSharded) == 0);
+
+   iSuccessful = SymTableSharded_put(oSymTableSharded, "Ruth", "RF");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableSharded_put(oSymTableSharded, "Gehrig", "1B");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableSharded_put(oSymTableSharded, "Ruth", "P");
+   ASSURE(! iSuccessful);
+   ASSURE(SymTableSharded_getLength(oSymTableSharded) == 2);
+   ASSURE(SymTableSharded_contains(oSymTableSharded, "Gehrig"));
+   ASSURE(! SymTableSharded_contains(oSymTableSharded, "Mantle"));
+   pcValue = (char*)SymTableSharded_replace(oSymTableSharded, "Ruth", "P");
+   ASSURE(strcmp(pcValue, "RF") == 0);
+   pcValue = (char*)SymTableSharded_get(oSymTableSharded, "Ruth");
+   ASSURE(strcmp(pcValue, "P") == 0);
+
+   /* Scopes open and close in every shard. */
+   iSuccessful = SymTableSharded_pushScope(oSymTableSharded);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableSharded_put(oSymTableSharded, "Ruth", "RF");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableSharded_put(oSymTableSharded, "Mantle", "CF");
+   ASSURE(iSuccessful);
+   uDepth = 0;
+   pcValue = (char*)SymTableSharded_getInnermost(oSymTableSharded,
+      "Ruth", &uDepth);
+   ASSURE(strcmp(pcValue, "RF") == 0);
+   ASSURE(uDepth == 1);
+   uCount = 0;
+   SymTableSharded_mapPrefix(oSymTableSharded, "M", countBinding, &uCount);
+   ASSURE(uCount == 1);
+   iSuccessful = SymTableSharded_popScope(oSymTableSharded);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableSharded_popScope(oSymTableSharded);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTableSharded_getLength(oSymTableSharded) == 2);
+   pcValue = (char*)SymTableSharded_remove(oSymTableSharded, "Ruth");
+   ASSURE(strcmp(pcValue, "P") == 0);
+   pcValue = (char*)SymTableSharded_remove(oSymTableSharded, "Gehrig");
+   ASSURE(strcmp(pcValue, "1B") == 0);
+   ASSURE(SymTableSharded_getLength(oSymTableSharded) == 0);
+
+   /* Threads can put at the same time. */
+   for (i = 0; i < THREAD_COUNT; i++)
+   {
+      asPuts[i].oSymTableSharded = oSymTableSharded;
+      asPuts[i].iFirst = iBindingCount / THREAD_COUNT * i;
+      asPuts[i].iEnd = (i == THREAD_COUNT - 1) ? iBindingCount
+         : iBindingCount / THREAD_COUNT * (i + 1);
+      asPuts[i].iFailed = 0;
+      iSuccessful = pthread_create(&asThreads[i], NULL, putSharded,
+         &asPuts[i]) == 0;
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < THREAD_COUNT; i++)
+   {
+      pthread_join(asThreads[i], NULL);
+      ASSURE(asPuts[i].iFailed == 0);
+   }
+   ASSURE(SymTableSharded_getLength(oSymTableSharded)
+      == (size_t)iBindingCount);
+   uCount = 0;
+   SymTableSharded_map(oSymTableSharded, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+
+   /* A parallel map visits each binding once. */
+   piVisits = (int*)calloc((size_t)iBindingCount + 1, sizeof(int));
+   ASSURE(piVisits != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      SymTableSharded_replace(oSymTableSharded, acKey, &piVisits[i]);
+   }
+   SymTableSharded_mapParallel(oSymTableSharded, countVisit, NULL);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(piVisits[i] == 1);
+   free(piVisits);
+
+   SymTableSharded_free(oSymTableSharded);
+
+   /* One shard works too. */
+   oSymTableSharded = SymTableSharded_new(1);
+   ASSURE(oSymTableSharded != NULL);
+   iSuccessful = SymTableSharded_put(oSymTableSharded, "Ruth", "RF");
+   ASSURE(iSuccessful);
+   ASSURE(SymTableSharded_contains(oSymTableSharded, "Ruth"));
+   SymTableSharded_free(oSymTableSharded);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifndef S_SPLINT_S
+/* Test that the durable table with the log at pcPath closes its log
+   once a record cannot be written or synced, reporting a change as
+   failed only if it is not made, and that a compaction starts a new
+   log. The file size limit is lowered to make the writes fail. */
+
+static void testDurableLogFailure(const char *pcPath)
+{
+   enum {MAX_KEY_LENGTH = 12, FILE_SIZE_LIMIT = 4096, PUT_COUNT = 1000};
+
+   SymTableDurable_T oSymTableDurable;
+   SymTable_T oSymTable;
+   struct rlimit sOldLimit;
+   struct rlimit sLimit;
+   void (*pfOldHandler)(int);
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iPutCount;
+   int iValue;
+   int iSuccessful;
+   int *piValue;
+   size_t uLength;
+
+   remove(pcPath);
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+
+   getrlimit(RLIMIT_FSIZE, &sOldLimit);
+   sLimit = sOldLimit;
+   sLimit.rlim_cur = FILE_SIZE_LIMIT;
+   pfOldHandler = signal(SIGXFSZ, SIG_IGN);
+   setrlimit(RLIMIT_FSIZE, &sLimit);
+   for (i = 0; i < PUT_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iValue = i;
+      if (! SymTableDurable_put(oSymTableDurable, acKey, &iValue))
+         break;
+   }
+   iPutCount = i;
+   ASSURE(iPutCount < PUT_COUNT);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iPutCount);
+
+   /* Every later change fails and is not made. */
+   iValue = -1;
+   ASSURE(SymTableDurable_replace(oSymTableDurable, "0", &iValue) == NULL);
+   ASSURE(SymTableDurable_remove(oSymTableDurable, "0") == NULL);
+   piValue = (int*)SymTable_get(oSymTable, "0");
+   ASSURE((piValue != NULL) && (*piValue == 0));
+   ASSURE(! SymTableDurable_sync(oSymTableDurable));
+   setrlimit(RLIMIT_FSIZE, &sOldLimit);
+   signal(SIGXFSZ, pfOldHandler);
+   iSuccessful = SymTableDurable_put(oSymTableDurable, "after", NULL);
+   ASSURE(! iSuccessful);
+   SymTableDurable_close(oSymTableDurable);
+
+   /* The log holds some of the changes that were made, and none that
+      was reported as failed. */
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE((uLength > 0) && (uLength <= (size_t)iPutCount));
+   for (i = 0; i < (int)uLength; i++)
+   {
+      sprintf(acKey, "%d", i);
+      piValue = (int*)SymTable_get(oSymTable, acKey);
+      ASSURE((piValue != NULL) && (*piValue == i));
+   }
+   sprintf(acKey, "%d", iPutCount);
+   ASSURE(! SymTable_contains(oSymTable, acKey));
+   ASSURE(! SymTable_contains(oSymTable, "after"));
+
+   /* A compaction writes a new log of the table. */
+   iSuccessful = SymTableDurable_compact(oSymTableDurable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableDurable_put(oSymTableDurable, "after", NULL);
+   ASSURE(iSuccessful);
+   SymTableDurable_close(oSymTableDurable);
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+   ASSURE(SymTable_getLength(oSymTable) == uLength + 1);
+   ASSURE(SymTable_contains(oSymTable, "after"));
+   SymTableDurable_close(oSymTableDurable);
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTableDurable object, whose log is written to a file in
+   the current directory. */
+
+static void testDurable(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   const char *pcPath = "testsymtable.log";
+   SymTableDurable_T oSymTableDurable;
+   SymTable_T oSymTable;
+   FILE *psFile;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iValue;
+   int iSuccessful;
+   int *piValue;
+   long lSize;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTableDurable ADT.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   remove(pcPath);
+
+   /* A table with no log starts empty. */
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iValue = i;
+      iSuccessful = SymTableDurable_put(oSymTableDurable, acKey, &iValue);
+      ASSURE(iSuccessful);
+   }
+   if (iBindingCount > 0)
+   {
+      iValue = 0;
+      iSuccessful = SymTableDurable_put(oSymTableDurable, "0", &iValue);
+      ASSURE(! iSuccessful);
+   }
+   iSuccessful = SymTableDurable_put(oSymTableDurable, "zero", NULL);
+   ASSURE(iSuccessful);
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      iValue = -i;
+      piValue = (int*)SymTableDurable_replace(oSymTableDurable, acKey,
+         &iValue);
+      ASSURE((piValue != NULL) && (*piValue == i));
+   }
+   for (i = 0; i < iBindingCount; i += 3)
+   {
+      sprintf(acKey, "%d", i);
+      piValue = (int*)SymTableDurable_remove(oSymTableDurable, acKey);
+      ASSURE(piValue != NULL);
+   }
+   ASSURE(SymTableDurable_remove(oSymTableDurable, "missing") == NULL);
+   ASSURE(SymTableDurable_replace(oSymTableDurable, "missing", &iValue)
+      == NULL);
+   iSuccessful = SymTableDurable_sync(oSymTableDurable);
+   ASSURE(iSuccessful);
+   SymTableDurable_close(oSymTableDurable);
+
+   /* Replaying the log gives back the same bindings. */
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+   piValue = (int*)SymTable_get(oSymTable, "zero");
+   ASSURE((piValue != NULL) && (*piValue == 0));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      piValue = (int*)SymTable_get(oSymTable, acKey);
+      if (i % 3 == 0)
+         ASSURE(piValue == NULL);
+      else if (i % 2 == 0)
+         ASSURE((piValue != NULL) && (*piValue == -i));
+      else
+         ASSURE((piValue != NULL) && (*piValue == i));
+   }
+
+   SymTableDurable_close(oSymTableDurable);
+
+   /* Rewriting one key over and over keeps the log bounded. */
+   remove(pcPath);
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   iSuccessful = SymTableDurable_put(oSymTableDurable, "zero", NULL);
+   ASSURE(iSuccessful);
+   for (i = 0; i < 10000; i++)
+   {
+      iValue = i;
+      piValue = (int*)SymTableDurable_replace(oSymTableDurable, "zero",
+         &iValue);
+      ASSURE(piValue != NULL);
+   }
+   SymTableDurable_close(oSymTableDurable);
+   psFile = fopen(pcPath, "rb");
+   ASSURE(psFile != NULL);
+   fseek(psFile, 0, SEEK_END);
+   lSize = ftell(psFile);
+   ASSURE(lSize < 20L * 1100);
+   fclose(psFile);
+
+   /* A record cut short at the end of the log is dropped. */
+   psFile = fopen(pcPath, "ab");
+   ASSURE(psFile != NULL);
+   fputs("S\005", psFile);
+   fclose(psFile);
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+   piValue = (int*)SymTable_get(oSymTable, "zero");
+   ASSURE((piValue != NULL) && (*piValue == 9999));
+   iValue = 7;
+   iSuccessful = SymTableDurable_put(oSymTableDurable, "seven", &iValue);
+   ASSURE(iSuccessful);
+   SymTableDurable_close(oSymTableDurable);
+
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(int));
+   ASSURE(oSymTableDurable != NULL);
+   oSymTable = SymTableDurable_table(oSymTableDurable);
+   piValue = (int*)SymTable_get(oSymTable, "seven");
+   ASSURE((piValue != NULL) && (*piValue == 7));
+   SymTableDurable_close(oSymTableDurable);
+
+   /* A log of values of another size is refused. */
+   oSymTableDurable = SymTable_recover(pcPath, sizeof(double));
+   ASSURE(oSymTableDurable == NULL);
+
+#ifndef S_SPLINT_S
+   testDurableLogFailure(pcPath);
+#endif
+
+   remove(pcPath);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a copy of the uLength bytes at pcValue as a string allocated
+   by malloc. pvExtra is unused. */
+
+static void *parseValue(const char *pcValue, size_t uLength,
+   void *pvExtra)
+{
+   char *pcCopy;
+
+   assert(pcValue != NULL);
+   (void)pvExtra;
+
+   pcCopy = (char*)malloc(uLength + 1);
+   assert(pcCopy != NULL);
+   memcpy(pcCopy, pcValue, uLength);
+   pcCopy[uLength] = '\0';
+   return pcCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the value pvValue with freeValue. pcKey and pvExtra are
+   unused. */
+
+static void freeBindingValue(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvExtra;
+
+   freeValue(pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_presize() and SymTable_loadFile() functions,
+   loading files of up to iBindingCount lines. */
+
+static void testLoadFile(int iBindingCount)
+{
+   enum {PAGE_LINES = 455};
+
+   const char *pcPath = "testsymtable.tsv";
+   SymTable_T oSymTable;
+   SymTableFile_T oFile;
+   FILE *psFile;
+   int iSuccessful;
+   int iBorrow;
+   int i;
+   size_t uCount;
+   char *pcValue;
+   char acKey[16];
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_presize() and SymTable_loadFile() "
+      "functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* A presized table keeps its bindings and takes as many more. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "Right Field");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_presize(oSymTable, (size_t)iBindingCount);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE((pcValue != NULL) && (strcmp(pcValue, "Right Field") == 0));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, "x");
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount + 1);
+   iSuccessful = SymTable_presize(oSymTable, 1);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_contains(oSymTable, "Ruth"));
+   if (iBindingCount > 0)
+      ASSURE(SymTable_contains(oSymTable, "0"));
+   SymTable_free(oSymTable);
+
+   /* Tabs, carriage returns, empty lines, repeated keys and a last
+      line without a newline, with copied and with borrowed keys. */
+   psFile = fopen(pcPath, "wb");
+   ASSURE(psFile != NULL);
+   fputs("Ruth\tRight Field\nGehrig\tFirst Base\r\n\n", psFile);
+   fputs("Mantle\nRuth\tPitcher\nJeter\tShort\tStop", psFile);
+   fclose(psFile);
+   for (iBorrow = 0; iBorrow <= 1; iBorrow++)
+   {
+      uFreedCount = 0;
+      oFile = NULL;
+      oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_TSV,
+         parseValue, freeValue, NULL, iBorrow ? &oFile : NULL);
+      ASSURE(oSymTable != NULL);
+      ASSURE((oFile != NULL) == iBorrow);
+      ASSURE(uFreedCount == 1);
+      ASSURE(SymTable_getLength(oSymTable) == 4);
+      pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, "Right Field") == 0));
+      pcValue = (char*)SymTable_get(oSymTable, "Gehrig");
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, "First Base") == 0));
+      pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, "") == 0));
+      pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, "Short\tStop") == 0));
+      SymTable_map(oSymTable, freeBindingValue, NULL);
+      SymTable_free(oSymTable);
+      if (oFile != NULL)
+         SymTableFile_close(oFile);
+   }
+
+   /* Whole lines as keys, without values. */
+   oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_KEYS, NULL, NULL,
+      NULL, NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 5);
+   ASSURE(SymTable_contains(oSymTable, "Gehrig\tFirst Base"));
+   ASSURE(SymTable_contains(oSymTable, "Jeter\tShort\tStop"));
+   ASSURE(SymTable_get(oSymTable, "Mantle") == NULL);
+   SymTable_free(oSymTable);
+
+   /* A file whose last key, without a newline, ends on a page
+      boundary. */
+   psFile = fopen(pcPath, "wb");
+   ASSURE(psFile != NULL);
+   for (i = 0; i < PAGE_LINES; i++)
+      fprintf(psFile, "k%07d\n", i);
+   fputs("z", psFile);
+   fclose(psFile);
+   oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_KEYS, NULL, NULL,
+      NULL, &oFile);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == PAGE_LINES + 1);
+   ASSURE(SymTable_contains(oSymTable, "z"));
+   ASSURE(SymTable_contains(oSymTable, "k0000454"));
+   SymTable_free(oSymTable);
+   SymTableFile_close(oFile);
+
+   /* A large file, and one that does not exist. */
+   psFile = fopen(pcPath, "wb");
+   ASSURE(psFile != NULL);
+   for (i = 0; i < iBindingCount; i++)
+      fprintf(psFile, "%d\t%d\n", i, -i);
+   fclose(psFile);
+   oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_TSV, parseValue,
+      freeValue, NULL, NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i += 97)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE((pcValue != NULL) && (atoi(pcValue) == -i));
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+   SymTable_map(oSymTable, freeBindingValue, NULL);
+   SymTable_free(oSymTable);
+
+   remove(pcPath);
+   oSymTable = SymTable_loadFile(pcPath, SYMTABLE_FILE_TSV, NULL, NULL,
+      NULL, NULL);
+   ASSURE(oSymTable == NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the integer key uKey to the sum at *pvExtra. pvValue is
+   unused. */
+
+static void sumKey(uint64_t uKey, void *pvValue, void *pvExtra)
+{
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   *(uint64_t*)pvExtra += uKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTableInt object. */
+
+static void testIntKeys(int iBindingCount)
+{
+   SymTableInt_T oSymTableInt;
+   uint64_t uSum;
+   uint64_t uKey;
+   int i;
+   int iSuccessful;
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTableInt ADT.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTableInt = SymTableInt_new();
+   ASSURE(oSymTableInt != NULL);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 0);
+   ASSURE(! SymTableInt_contains(oSymTableInt, 0));
+
+   iSuccessful = SymTableInt_put(oSymTableInt, 0, "zero");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableInt_put(oSymTableInt, UINT64_MAX, "max");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableInt_put(oSymTableInt, 0, "again");
+   ASSURE(! iSuccessful);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 2);
+   pcValue = (char*)SymTableInt_get(oSymTableInt, UINT64_MAX);
+   ASSURE(strcmp(pcValue, "max") == 0);
+   pcValue = (char*)SymTableInt_replace(oSymTableInt, 0, "nil");
+   ASSURE(strcmp(pcValue, "zero") == 0);
+   ASSURE(SymTableInt_replace(oSymTableInt, 1, "one") == NULL);
+   pcValue = (char*)SymTableInt_remove(oSymTableInt, 0);
+   ASSURE(strcmp(pcValue, "nil") == 0);
+   ASSURE(SymTableInt_remove(oSymTableInt, 0) == NULL);
+   pcValue = (char*)SymTableInt_remove(oSymTableInt, UINT64_MAX);
+   ASSURE(strcmp(pcValue, "max") == 0);
+   ASSURE(SymTableInt_getLength(oSymTableInt) == 0);
+
+   /* Keys that differ only in their high bits spread out too. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      uKey = (uint64_t)i << 32;
+      iSuccessful = SymTableInt_put(oSymTableInt, uKey, "x");
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTableInt_getLength(oSymTableInt) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(SymTableInt_contains(oSymTableInt, (uint64_t)i << 32));
+   ASSURE(! SymTableInt_contains(oSymTableInt, 1));
+
+   uSum = 0;
+   SymTableInt_map(oSymTableInt, sumKey, &uSum);
+   ASSURE(uSum == ((uint64_t)iBindingCount * (uint64_t)(iBindingCount - 1)
+      / 2) << 32);
+
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      pcValue = (char*)SymTableInt_remove(oSymTableInt, (uint64_t)i << 32);
+      ASSURE(pcValue != NULL);
+   }
+   ASSURE(SymTableInt_getLength(oSymTableInt)
+      == (size_t)iBindingCount / 2);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(SymTableInt_contains(oSymTableInt, (uint64_t)i << 32)
+         == (i % 2 == 1));
+
+   SymTableInt_free(oSymTableInt);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Number of bindings evictCount has been called with, and the key of
+   the last one. */
+
+static int iEvictCount;
+static char acEvictedKey[16];
+
+/*--------------------------------------------------------------------*/
+
+/* Count the binding with key pcKey and value pvValue, which an LRU
+   cache has evicted, and remember pcKey. */
+
+static void evictCount(const char *pcKey, void *pvValue)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+
+   iEvictCount++;
+   strncpy(acEvictedKey, pcKey, sizeof(acEvictedKey) - 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTableLRU object, with caches of up to iBindingCount
+   bindings. */
+
+static void testLRU(int iBindingCount)
+{
+   SymTableLRU_T oSymTableLRU;
+   char acKey[16];
+   size_t uCount;
+   int i;
+   int iSuccessful;
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTableLRU ADT.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   iEvictCount = 0;
+   oSymTableLRU = SymTable_newLRU(3, evictCount);
+   ASSURE(oSymTableLRU != NULL);
+   ASSURE(SymTableLRU_getLength(oSymTableLRU) == 0);
+
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "a", "1");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "b", "2");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "c", "3");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "a", "4");
+   ASSURE(! iSuccessful);
+   ASSURE(iEvictCount == 0);
+
+   /* A get makes "a" the most recently used, so "b" goes first. */
+   pcValue = (char*)SymTableLRU_get(oSymTableLRU, "a");
+   ASSURE(strcmp(pcValue, "1") == 0);
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "d", "4");
+   ASSURE(iSuccessful);
+   ASSURE(iEvictCount == 1);
+   ASSURE(strcmp(acEvictedKey, "b") == 0);
+   ASSURE(! SymTableLRU_contains(oSymTableLRU, "b"));
+   ASSURE(SymTableLRU_getLength(oSymTableLRU) == 3);
+
+   /* A contains is not a use, a replace is. */
+   ASSURE(SymTableLRU_contains(oSymTableLRU, "c"));
+   pcValue = (char*)SymTableLRU_replace(oSymTableLRU, "c", "5");
+   ASSURE(strcmp(pcValue, "3") == 0);
+   ASSURE(SymTableLRU_replace(oSymTableLRU, "b", "6") == NULL);
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "e", "6");
+   ASSURE(iSuccessful);
+   ASSURE(iEvictCount == 2);
+   ASSURE(strcmp(acEvictedKey, "a") == 0);
+
+   /* A removed binding is not evicted. */
+   pcValue = (char*)SymTableLRU_remove(oSymTableLRU, "d");
+   ASSURE(strcmp(pcValue, "4") == 0);
+   ASSURE(SymTableLRU_remove(oSymTableLRU, "d") == NULL);
+   ASSURE(SymTableLRU_get(oSymTableLRU, "d") == NULL);
+   iSuccessful = SymTableLRU_put(oSymTableLRU, "f", "7");
+   ASSURE(iSuccessful);
+   ASSURE(iEvictCount == 2);
+   ASSURE(SymTableLRU_getLength(oSymTableLRU) == 3);
+
+   uCount = 0;
+   SymTableLRU_map(oSymTableLRU, countBinding, &uCount);
+   ASSURE(uCount == 3);
+   SymTableLRU_free(oSymTableLRU);
+
+   /* Put twice as many bindings as fit, getting one of the first half
+      before each put, so that only the later bindings are evicted. A table
+      must fit at least one binding. */
+   if (iBindingCount > 0)
+   {
+      iEvictCount = 0;
+      oSymTableLRU = SymTable_newLRU((size_t)iBindingCount, evictCount);
+      ASSURE(oSymTableLRU != NULL);
+      for (i = 0; i < iBindingCount / 2; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTableLRU_put(oSymTableLRU, acKey, "x");
+         ASSURE(iSuccessful);
+      }
+      for (i = iBindingCount / 2; i < 2 * iBindingCount; i++)
+      {
+         if (iBindingCount >= 2)
+         {
+            sprintf(acKey, "%d", i % (iBindingCount / 2));
+            ASSURE(SymTableLRU_get(oSymTableLRU, acKey) != NULL);
+         }
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTableLRU_put(oSymTableLRU, acKey, "x");
+         ASSURE(iSuccessful);
+      }
+      ASSURE(SymTableLRU_getLength(oSymTableLRU) == (size_t)iBindingCount);
+      ASSURE(iEvictCount == iBindingCount);
+      for (i = 0; i < iBindingCount / 2; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTableLRU_contains(oSymTableLRU, acKey));
+      }
+      SymTableLRU_free(oSymTableLRU);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_pushScope(), SymTable_popScope(), and
+   SymTable_getInnermost() functions. */
+
+static void testScopes(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acRuth[] = "Ruth";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acRightField[] = "Right Field";
+   char acPitcher[] = "Pitcher";
+   char *pcValue;
+   int iFound;
+   int iSuccessful;
+   size_t uLength;
+   size_t uDepth;
+   size_t uCount;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable scope functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Only the outermost scope is open. */
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(! iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+
+   /* Shadow Jeter in scope 1. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acJeter, acPitcher);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acJeter, acRightField);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acRuth, acRightField);
+   ASSURE(iSuccessful);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 3);
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == 3);
+
+   pcValue = (char*)SymTable_get(oSymTable, acJeter);
+   ASSURE(pcValue == acPitcher);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, acJeter, &uDepth);
+   ASSURE(pcValue == acPitcher);
+   ASSURE(uDepth == 1);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, acMantle, &uDepth);
+   ASSURE(pcValue == acCenterField);
+   ASSURE(uDepth == 0);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, "Gehrig", &uDepth);
+   ASSURE(pcValue == NULL);
+
+   /* Shadow Jeter again in scope 2, then clone the table. */
+   iSuccessful = SymTable_pushScope(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acJeter, acCenterField);
+   ASSURE(iSuccessful);
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+
+   /* Removing a binding uncovers the one it hid. */
+   pcValue = (char*)SymTable_remove(oSymTable, acJeter);
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTable_getInnermost(oSymTable, acJeter, &uDepth);
+   ASSURE(pcValue == acPitcher);
+   ASSURE(uDepth == 1);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 3);
+
+   /* A change to an outer binding outlives the inner scope. */
+   pcValue = (char*)SymTable_replace(oSymTable, acMantle, acShortstop);
+   ASSURE(pcValue == acCenterField);
+
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, acJeter);
+   ASSURE(pcValue == acPitcher);
+
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, acJeter);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable, acMantle);
+   ASSURE(pcValue == acShortstop);
+   iFound = SymTable_contains(oSymTable, acRuth);
+   ASSURE(! iFound);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(! iSuccessful);
+
+   /* The clone keeps its own scopes. */
+   pcValue = (char*)SymTable_getInnermost(oSymTableClone, acJeter, &uDepth);
+   ASSURE(pcValue == acCenterField);
+   ASSURE(uDepth == 2);
+   iSuccessful = SymTable_popScope(oSymTableClone);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_popScope(oSymTableClone);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTableClone, acJeter);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTableClone, acMantle);
+   ASSURE(pcValue == acCenterField);
+   uLength = SymTable_getLength(oSymTableClone);
+   ASSURE(uLength == 2);
+
+   /* Free a table with a scope still open. */
+   iSuccessful = SymTable_pushScope(oSymTableClone);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTableClone, acMantle, acRightField);
+   ASSURE(iSuccessful);
+
+   SymTable_free(oSymTableClone);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the depth of the visible binding of key number i in the
+   table of testScopeStack() when scope uTop is the innermost. Scope d
+   binds the keys whose number is a multiple of d + 1, and the keys
+   whose number is a multiple of 12 are removed from scope 3. */
+
+static size_t scopeStackDepth(int i, size_t uTop)
+{
+   size_t d;
+
+   for (d = uTop; d > 0; d--)
+      if (i % (int)(d + 1) == 0 && ! (d == 3 && i % 12 == 0))
+         return d;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the table oSymTable of testScopeStack() holds the
+   iBindingCount keys it puts, each visible in the scope that
+   scopeStackDepth() gives when scope uTop is the innermost. */
+
+static void checkScopeStack(SymTable_T oSymTable, int iBindingCount,
+   size_t uTop, char *apcValues[])
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   size_t uDepth;
+   size_t uCount;
+   int i;
+
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "scope%d", i);
+      uDepth = 99;
+      pcValue = (char*)SymTable_getInnermost(oSymTable, acKey, &uDepth);
+      ASSURE(uDepth == scopeStackDepth(i, uTop));
+      ASSURE(pcValue == apcValues[scopeStackDepth(i, uTop)]);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test scopes that hold many of iBindingCount bindings, each key
+   shadowed by up to three inner scopes. */
+
+static void testScopeStack(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+   enum {SCOPE_COUNT = 3};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   char acKey[MAX_KEY_LENGTH];
+   char acOuter[] = "outer";
+   char acFirst[] = "first";
+   char acSecond[] = "second";
+   char acThird[] = "third";
+   char *apcValues[SCOPE_COUNT + 1];
+   char *pcValue;
+   size_t d;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing scopes that hold many bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   apcValues[0] = acOuter;
+   apcValues[1] = acFirst;
+   apcValues[2] = acSecond;
+   apcValues[3] = acThird;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "scope%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acOuter);
+      ASSURE(iSuccessful);
+   }
+   for (d = 1; d <= SCOPE_COUNT; d++)
+   {
+      iSuccessful = SymTable_pushScope(oSymTable);
+      ASSURE(iSuccessful);
+      for (i = 0; i < iBindingCount; i += (int)d + 1)
+      {
+         sprintf(acKey, "scope%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, apcValues[d]);
+         ASSURE(iSuccessful);
+      }
+   }
+
+   /* Removing from the innermost scope uncovers scope 2. */
+   for (i = 0; i < iBindingCount; i += 12)
+   {
+      sprintf(acKey, "scope%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acThird);
+   }
+   checkScopeStack(oSymTable, iBindingCount, SCOPE_COUNT, apcValues);
+
+   /* A clone keeps every scope, and the bindings each hides. */
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   for (d = SCOPE_COUNT; d > 0; d--)
+   {
+      iSuccessful = SymTable_popScope(oSymTable);
+      ASSURE(iSuccessful);
+      checkScopeStack(oSymTable, iBindingCount, d - 1, apcValues);
+   }
+   iSuccessful = SymTable_popScope(oSymTable);
+   ASSURE(! iSuccessful);
+   checkScopeStack(oSymTableClone, iBindingCount, SCOPE_COUNT, apcValues);
+   iSuccessful = SymTable_popScope(oSymTableClone);
+   ASSURE(iSuccessful);
+   checkScopeStack(oSymTableClone, iBindingCount, SCOPE_COUNT - 1,
+      apcValues);
+
+   /* A clear closes the scopes that are open. */
+   iSuccessful = SymTable_clear(oSymTableClone, NULL);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_popScope(oSymTableClone);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTableClone, "scope0", acOuter);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_pushScope(oSymTableClone);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTableClone, "scope0", acFirst);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTableClone) == 1);
+
+   SymTable_free(oSymTableClone);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_newInline(), using a table of counters that contains
+   iBindingCount bindings. */
+
+static void testInline(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   struct Record
+   {
+      long lCount;
+      double dOffset;
+   };
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableClone;
+   char acKey[MAX_KEY_LENGTH];
+   struct Record sRecord;
+   struct Record *psRecord;
+   long *plCount;
+   long lCount;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_newInline() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newInline(sizeof(struct Record));
+   ASSURE(oSymTable != NULL);
+
+   /* The table keeps its own copy of each value. */
+   sRecord.lCount = 7;
+   sRecord.dOffset = 2.5;
+   iSuccessful = SymTable_put(oSymTable, "Jeter", &sRecord);
+   ASSURE(iSuccessful);
+   sRecord.lCount = 8;
+   psRecord = (struct Record*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(psRecord != NULL && psRecord != &sRecord);
+   ASSURE(psRecord->lCount == 7 && psRecord->dOffset == 2.5);
+
+   /* A value can be changed through the pointer that get returns. */
+   psRecord->lCount++;
+   psRecord = (struct Record*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(psRecord->lCount == 8);
+
+   /* A NULL value is stored as zeros. */
+   iSuccessful = SymTable_put(oSymTable, "Mantle", NULL);
+   ASSURE(iSuccessful);
+   psRecord = (struct Record*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(psRecord != NULL);
+   ASSURE(psRecord->lCount == 0 && psRecord->dOffset == 0.0);
+
+   /* replace and remove return copies of the old values. */
+   sRecord.lCount = 3;
+   psRecord = (struct Record*)SymTable_replace(oSymTable, "Jeter", &sRecord);
+   ASSURE(psRecord != NULL && psRecord->lCount == 8);
+   psRecord = (struct Record*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(psRecord->lCount == 3);
+   psRecord = (struct Record*)SymTable_replace(oSymTable, "Ruth", &sRecord);
+   ASSURE(psRecord == NULL);
+
+   oSymTableClone = SymTable_clone(oSymTable);
+   ASSURE(oSymTableClone != NULL);
+   psRecord = (struct Record*)SymTable_remove(oSymTable, "Jeter");
+   ASSURE(psRecord != NULL && psRecord->lCount == 3);
+   psRecord = (struct Record*)SymTable_remove(oSymTable, "Jeter");
+   ASSURE(psRecord == NULL);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   /* The clone has its own copies of the values. */
+   psRecord = (struct Record*)SymTable_get(oSymTableClone, "Jeter");
+   ASSURE(psRecord != NULL && psRecord->lCount == 3);
+   sRecord.lCount = 4;
+   SymTable_replace(oSymTableClone, "Mantle", &sRecord);
+   psRecord = (struct Record*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(psRecord->lCount == 0);
+
+   SymTable_free(oSymTableClone);
+   SymTable_free(oSymTable);
+
+   /* Count the keys of a larger table in place. */
+   oSymTable = SymTable_newInline(sizeof(long));
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i % 1000);
+      plCount = (long*)SymTable_get(oSymTable, acKey);
+      if (plCount == NULL)
+      {
+         lCount = 1;
+         iSuccessful = SymTable_put(oSymTable, acKey, &lCount);
+         ASSURE(iSuccessful);
+      }
+      else
+         (*plCount)++;
+   }
+   for (i = 0; i < iBindingCount && i < 1000; i++)
+   {
+      sprintf(acKey, "%d", i);
+      plCount = (long*)SymTable_get(oSymTable, acKey);
+      ASSURE(plCount != NULL);
+      ASSURE(*plCount == (iBindingCount - i + 999) / 1000);
+   }
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to be large, that is, to
+   contain iBindingCount bindings. Write the time consumed to stdout. */
+
+static void testLargeTable(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableSmall;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+   int iSmall;
+   int iLarge;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+   size_t uLength = 0;
+   size_t uLength2;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a potentially large SymTable object.\n");
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   /* Note the current time. */
+   iInitialClock = clock();
+
+   /* Create oSymTableSmall, and put a couple of bindings into it. */
+   oSymTableSmall = SymTable_new();
+   ASSURE(oSymTableSmall != NULL);
+   iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTableSmall, "yyy", "yyy");
+   ASSURE(iSuccessful);
+
+   /* Create oSymTable, the primary SymTable object. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Put iBindingCount new bindings into oSymTable.  Each binding's
+      key and value contain the same characters. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)malloc(sizeof(char) * (strlen(acKey) + 1));
+      ASSURE(pcValue != NULL);
+      strcpy(pcValue, acKey);
+      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
+      ASSURE(iSuccessful);
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == (size_t)(i+1));
+   }
+
+   /* Get each binding's value, and make sure that it contains
+      the same characters as its key. */
+   iSmall = 0;
+   iLarge = iBindingCount - 1;
+   while (iSmall < iLarge)
+   {
+      /* Get the smallest of the remaining bindings. */
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      iSmall++;
+      /* Get the largest of the remaining bindings. */
+      sprintf(acKey, "%d", iLarge);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      iLarge--;
+   }
+   /* Get the middle binding -- if there is one. */
+   if (iSmall == iLarge)
+   {
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+   }
+
+   /* Remove each binding. Also free each binding's value. */
+   iSmall = 0;
+   iLarge = iBindingCount - 1;
+   while (iSmall < iLarge)
+   {
+      /* Remove the smallest of the remaining bindings. */
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
       free(pcValue);
       uLength--;
       uLength2 = SymTable_getLength(oSymTable);
@@ -952,14 +3623,39 @@ int main(int argc, char *argv[])
    testBasics();
    testKeyComparison();
    testKeyOwnership();
+   testBorrowedKeys();
    testRemove();
    testMap();
+   testMapPrefix();
+   testMerge(iBindingCount);
    testEmptyTable();
    testEmptyKey();
    testNullValue();
    testLongKey();
    testTableOfTables();
    testCollisions();
+   testClone(iBindingCount);
+   testBuildParallel(iBindingCount);
+   testClear(iBindingCount);
+   testKeyHeap(iBindingCount);
+   testFind(iBindingCount);
+   testRepeatedLookups();
+#ifdef SYMTABLE_BLOOM
+   testBloomStats(iBindingCount);
+#endif
+#ifdef SYMTABLE_HOT_CACHE
+   testHotStats();
+#endif
+   testFreeze(iBindingCount);
+   testFreeAsync(iBindingCount);
+   testSharded(iBindingCount);
+   testDurable(iBindingCount);
+   testLoadFile(iBindingCount);
+   testIntKeys(iBindingCount);
+   testLRU(iBindingCount);
+   testScopes();
+   testScopeStack(iBindingCount);
+   testInline(iBindingCount);
    testLargeTable(iBindingCount);
 
    printf("------------------------------------------------------\n");
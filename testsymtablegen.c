@@ -0,0 +1,159 @@
+/*--------------------------------------------------------------------*/
+/* testsymtablegen.c                                                  */
+/* Author: Milan Sastry                                               */
+/*--------------------------------------------------------------------*/
+
+#include "symtablestatic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The table symtablegen wrote from testsymtablegen.txt. */
+
+extern const struct SymTableStatic oTestKeywords;
+
+/*--------------------------------------------------------------------*/
+
+/* A key of testsymtablegen.txt and the value it is bound to, NULL for
+   a key listed without a value. */
+
+struct Keyword
+{
+   const char *pcKey;
+   const char *pcValue;
+};
+
+/* Every binding of testsymtablegen.txt. */
+
+static const struct Keyword asKeywords[] =
+{
+   {"auto", "AUTO"}, {"break", "BREAK"}, {"case", "CASE"},
+   {"char", "CHAR"}, {"const", "CONST"}, {"continue", "CONTINUE"},
+   {"default", "DEFAULT"}, {"do", "DO"}, {"double", "DOUBLE"},
+   {"else", "ELSE"}, {"enum", "ENUM"}, {"extern", "EXTERN"},
+   {"float", "FLOAT"}, {"for", "FOR"}, {"goto", "GOTO"}, {"if", "IF"},
+   {"inline", "INLINE"}, {"int", "INT"}, {"long", "LONG"},
+   {"register", "REGISTER"}, {"restrict", "RESTRICT"},
+   {"return", "RETURN"}, {"short", "SHORT"}, {"signed", "SIGNED"},
+   {"static", "STATIC"}, {"struct", "STRUCT"}, {"switch", "SWITCH"},
+   {"typedef", "TYPEDEF"}, {"union", "UNION"},
+   {"unsigned", "UNSIGNED"}, {"void", "VOID"},
+   {"volatile", "VOLATILE"}, {"while", "WHILE"},
+   {"sizeof", NULL}, {"", "EMPTY"}
+};
+
+/* Keys that testsymtablegen.txt does not bind, some of them close to
+   keys that it does. */
+
+static const char *const apcMisses[] =
+{
+   "AUTO", "Auto", "whil", "whilex", "while ", " if", "in", "sizeo",
+   "sizeof\t", "x", "EMPTY", "keyword"
+};
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that pcKey is bound to pvValue in asKeywords, and count the
+   binding in *pvCount. */
+
+static void countKeyword(const char *pcKey, void *pvValue, void *pvCount)
+{
+   size_t i;
+
+   for (i = 0; i < sizeof(asKeywords) / sizeof(asKeywords[0]); i++)
+      if (strcmp(asKeywords[i].pcKey, pcKey) == 0)
+         break;
+   ASSURE(i < sizeof(asKeywords) / sizeof(asKeywords[0]));
+   if (i < sizeof(asKeywords) / sizeof(asKeywords[0]))
+   {
+      if (asKeywords[i].pcValue == NULL)
+         ASSURE(pvValue == NULL);
+      else
+         ASSURE(pvValue != NULL &&
+            strcmp((const char*)pvValue, asKeywords[i].pcValue) == 0);
+   }
+   (*(size_t*)pvCount)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that every key of testsymtablegen.txt is found in the table
+   symtablegen generated from it, bound to its value, and that keys
+   outside the set miss. */
+
+static void testGeneratedTable(void)
+{
+   size_t uKeywordCount = sizeof(asKeywords) / sizeof(asKeywords[0]);
+   size_t uCount = 0;
+   size_t i;
+   const char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a table generated by symtablegen.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   ASSURE(SymTableStatic_getLength(&oTestKeywords) == uKeywordCount);
+
+   for (i = 0; i < uKeywordCount; i++)
+   {
+      ASSURE(SymTableStatic_contains(&oTestKeywords,
+         asKeywords[i].pcKey));
+      pcValue = (const char*)SymTableStatic_get(&oTestKeywords,
+         asKeywords[i].pcKey);
+      if (asKeywords[i].pcValue == NULL)
+         ASSURE(pcValue == NULL);
+      else
+         ASSURE(pcValue != NULL &&
+            strcmp(pcValue, asKeywords[i].pcValue) == 0);
+   }
+
+   for (i = 0; i < sizeof(apcMisses) / sizeof(apcMisses[0]); i++)
+   {
+      ASSURE(! SymTableStatic_contains(&oTestKeywords, apcMisses[i]));
+      ASSURE(SymTableStatic_get(&oTestKeywords, apcMisses[i]) == NULL);
+   }
+
+   SymTableStatic_map(&oTestKeywords, countKeyword, &uCount);
+   ASSURE(uCount == uKeywordCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the table that symtablegen generated from testsymtablegen.txt.
+   Return 0. */
+
+int main(int argc, char *argv[])
+{
+   if (argc != 1)
+   {
+      fprintf(stderr, "Usage: %s\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   testGeneratedTable();
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}